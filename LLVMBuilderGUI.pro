@@ -15,7 +15,35 @@ SOURCES += \
     commandgenerator.cpp \
     buildexecutor.cpp \
     configurationdialog.cpp \
-    fielddefaultsmanager.cpp
+    fielddefaultsmanager.cpp \
+    buildlogstore.cpp \
+    buildlogmodel.cpp \
+    ninjalog.cpp \
+    ninjaloganalyzer.cpp \
+    ninjaprogresstracker.cpp \
+    buildreport.cpp \
+    traceexporter.cpp \
+    timetraceaggregator.cpp \
+    resourceplanner.cpp \
+    jobserver.cpp \
+    compilercache.cpp \
+    builddirpool.cpp \
+    builddirpooldialog.cpp \
+    cmakestate.cpp \
+    configureseed.cpp \
+    ninjadeps.cpp \
+    ninjamanifest.cpp \
+    rebuildforecast.cpp \
+    distributionplanner.cpp \
+    pgopipeline.cpp \
+    boltstage.cpp \
+    statistics.cpp \
+    compilerbenchmark.cpp \
+    microbenchmarks.cpp \
+    littestrunner.cpp \
+    stagepipeline.cpp \
+    sourcecheckout.cpp \
+    sourceprefetcher.cpp
 
 HEADERS += \
     mainwindow.h \
@@ -23,11 +51,45 @@ HEADERS += \
     commandgenerator.h \
     buildexecutor.h \
     configurationdialog.h \
-    fielddefaultsmanager.h
+    fielddefaultsmanager.h \
+    buildlogstore.h \
+    buildlogmodel.h \
+    logbatch.h \
+    buildprogress.h \
+    ninjalog.h \
+    ninjaloganalyzer.h \
+    ninjaprogresstracker.h \
+    buildreport.h \
+    traceexporter.h \
+    timetraceaggregator.h \
+    resourceplanner.h \
+    jobserver.h \
+    compilercache.h \
+    builddirpool.h \
+    builddirpooldialog.h \
+    cmakestate.h \
+    configureseed.h \
+    ninjadeps.h \
+    ninjamanifest.h \
+    rebuildforecast.h \
+    distributionplanner.h \
+    pgopipeline.h \
+    boltstage.h \
+    statistics.h \
+    compilerbenchmark.h \
+    microbenchmarks.h \
+    littestrunner.h \
+    stagepipeline.h \
+    sourcecheckout.h \
+    sourceprefetcher.h
 
 FORMS += \
     mainwindow.ui \
-    configurationdialog.ui
+    configurationdialog.ui \
+    builddirpooldialog.ui
+
+RESOURCES += \
+    benchmarkcorpus.qrc
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,188 @@
+// Benchmark corpus: standard containers, strings and algorithms, the kind
+// of code whose compile time is dominated by parsing and instantiating
+// library headers.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace corpus {
+
+struct Symbol
+{
+    std::string name;
+    std::string section;
+    std::uint64_t address = 0;
+    std::uint64_t size = 0;
+    bool global = false;
+};
+
+class SymbolTable
+{
+public:
+    void add(const Symbol &symbol)
+    {
+        m_byName[symbol.name] = m_symbols.size();
+        m_bySection[symbol.section].insert(symbol.address);
+        m_symbols.push_back(symbol);
+    }
+
+    const Symbol *find(const std::string &name) const
+    {
+        auto it = m_byName.find(name);
+        return it == m_byName.end() ? nullptr : &m_symbols[it->second];
+    }
+
+    std::vector<Symbol> sortedBySize() const
+    {
+        std::vector<Symbol> result = m_symbols;
+        std::stable_sort(result.begin(), result.end(),
+                         [](const Symbol &a, const Symbol &b) { return a.size > b.size; });
+        return result;
+    }
+
+    std::map<std::string, std::uint64_t> sectionSizes() const
+    {
+        std::map<std::string, std::uint64_t> sizes;
+        for (const Symbol &symbol : m_symbols) {
+            sizes[symbol.section] += symbol.size;
+        }
+        return sizes;
+    }
+
+    std::vector<std::string> globals() const
+    {
+        std::vector<std::string> names;
+        for (const Symbol &symbol : m_symbols) {
+            if (symbol.global) {
+                names.push_back(symbol.name);
+            }
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        return names;
+    }
+
+    std::size_t sectionCount() const { return m_bySection.size(); }
+
+private:
+    std::vector<Symbol> m_symbols;
+    std::unordered_map<std::string, std::size_t> m_byName;
+    std::map<std::string, std::set<std::uint64_t>> m_bySection;
+};
+
+std::vector<std::string> split(const std::string &text, char separator)
+{
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream stream(text);
+    while (std::getline(stream, field, separator)) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+std::string trim(const std::string &text)
+{
+    auto begin = std::find_if_not(text.begin(), text.end(), [](unsigned char c) { return std::isspace(c); });
+    auto end = std::find_if_not(text.rbegin(), text.rend(), [](unsigned char c) { return std::isspace(c); }).base();
+    return begin < end ? std::string(begin, end) : std::string();
+}
+
+// Parses "name section address size [global]" lines
+SymbolTable parseSymbols(const std::string &text)
+{
+    SymbolTable table;
+    for (const std::string &line : split(text, '\n')) {
+        std::vector<std::string> fields = split(trim(line), ' ');
+        if (fields.size() < 4) {
+            continue;
+        }
+        Symbol symbol;
+        symbol.name = fields[0];
+        symbol.section = fields[1];
+        symbol.address = std::stoull(fields[2], nullptr, 16);
+        symbol.size = std::stoull(fields[3]);
+        symbol.global = fields.size() > 4 && fields[4] == "global";
+        table.add(symbol);
+    }
+    return table;
+}
+
+std::string report(const SymbolTable &table)
+{
+    std::ostringstream out;
+    for (const auto &entry : table.sectionSizes()) {
+        out << entry.first << ": " << entry.second << "\n";
+    }
+    std::vector<Symbol> largest = table.sortedBySize();
+    if (largest.size() > 10) {
+        largest.resize(10);
+    }
+    for (const Symbol &symbol : largest) {
+        out << "  " << symbol.name << " " << symbol.size << "\n";
+    }
+    std::vector<std::string> names = table.globals();
+    out << names.size() << " global symbols, " << table.sectionCount() << " sections\n";
+    return out.str();
+}
+
+std::map<std::string, int> wordFrequencies(const std::string &text)
+{
+    std::map<std::string, int> counts;
+    std::string word;
+    for (char c : text) {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+            word += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        } else if (!word.empty()) {
+            ++counts[word];
+            word.clear();
+        }
+    }
+    if (!word.empty()) {
+        ++counts[word];
+    }
+    return counts;
+}
+
+std::vector<std::pair<std::string, int>> topWords(const std::string &text, std::size_t count)
+{
+    std::map<std::string, int> counts = wordFrequencies(text);
+    std::vector<std::pair<std::string, int>> words(counts.begin(), counts.end());
+    std::partial_sort(words.begin(), words.begin() + std::min(count, words.size()), words.end(),
+                      [](const auto &a, const auto &b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+    words.resize(std::min(count, words.size()));
+    return words;
+}
+
+std::uint64_t checksum(const std::vector<std::string> &lines)
+{
+    return std::accumulate(lines.begin(), lines.end(), std::uint64_t(14695981039346656037ull),
+                           [](std::uint64_t hash, const std::string &line) {
+                               for (unsigned char c : line) {
+                                   hash = (hash ^ c) * 1099511628211ull;
+                               }
+                               return hash;
+                           });
+}
+
+} // namespace corpus
+
+std::string corpusContainers(const std::string &text)
+{
+    corpus::SymbolTable table = corpus::parseSymbols(text);
+    std::string result = corpus::report(table);
+    for (const auto &word : corpus::topWords(text, 5)) {
+        result += word.first + "=" + std::to_string(word.second) + "\n";
+    }
+    result += std::to_string(corpus::checksum(corpus::split(text, '\n')));
+    return result;
+}
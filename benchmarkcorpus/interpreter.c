@@ -0,0 +1,217 @@
+/* Benchmark corpus: a tokenizer and a stack-based bytecode interpreter in
+ * C, with the switch dispatch and pointer code of a typical C library. */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum token_kind { TOKEN_END, TOKEN_NUMBER, TOKEN_IDENTIFIER, TOKEN_OPERATOR, TOKEN_LPAREN, TOKEN_RPAREN };
+
+struct token {
+    enum token_kind kind;
+    const char *start;
+    size_t length;
+    long value;
+};
+
+struct lexer {
+    const char *cursor;
+};
+
+static struct token next_token(struct lexer *lexer)
+{
+    struct token token = {TOKEN_END, lexer->cursor, 0, 0};
+    while (isspace((unsigned char)*lexer->cursor)) {
+        ++lexer->cursor;
+    }
+    token.start = lexer->cursor;
+    if (*lexer->cursor == '\0') {
+        return token;
+    }
+    if (isdigit((unsigned char)*lexer->cursor)) {
+        token.kind = TOKEN_NUMBER;
+        while (isdigit((unsigned char)*lexer->cursor)) {
+            token.value = token.value * 10 + (*lexer->cursor++ - '0');
+        }
+    } else if (isalpha((unsigned char)*lexer->cursor) || *lexer->cursor == '_') {
+        token.kind = TOKEN_IDENTIFIER;
+        while (isalnum((unsigned char)*lexer->cursor) || *lexer->cursor == '_') {
+            ++lexer->cursor;
+        }
+    } else if (*lexer->cursor == '(') {
+        token.kind = TOKEN_LPAREN;
+        ++lexer->cursor;
+    } else if (*lexer->cursor == ')') {
+        token.kind = TOKEN_RPAREN;
+        ++lexer->cursor;
+    } else {
+        token.kind = TOKEN_OPERATOR;
+        token.value = *lexer->cursor++;
+    }
+    token.length = (size_t)(lexer->cursor - token.start);
+    return token;
+}
+
+enum opcode { OP_PUSH, OP_LOAD, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_NEG, OP_DUP, OP_SWAP, OP_JZ, OP_JMP, OP_HALT };
+
+struct program {
+    int32_t *code;
+    size_t length;
+    size_t capacity;
+};
+
+static void emit(struct program *program, int32_t word)
+{
+    if (program->length == program->capacity) {
+        size_t capacity = program->capacity ? program->capacity * 2 : 64;
+        int32_t *code = realloc(program->code, capacity * sizeof(*code));
+        if (!code) {
+            return;
+        }
+        program->code = code;
+        program->capacity = capacity;
+    }
+    program->code[program->length++] = word;
+}
+
+struct parser {
+    struct lexer lexer;
+    struct token current;
+    struct program *program;
+    int error;
+};
+
+static void advance(struct parser *parser)
+{
+    parser->current = next_token(&parser->lexer);
+}
+
+static int precedence(long op)
+{
+    switch (op) {
+    case '+':
+    case '-':
+        return 1;
+    case '*':
+    case '/':
+    case '%':
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+static void parse_expression(struct parser *parser, int minimum);
+
+static void parse_primary(struct parser *parser)
+{
+    struct token token = parser->current;
+    switch (token.kind) {
+    case TOKEN_NUMBER:
+        emit(parser->program, OP_PUSH);
+        emit(parser->program, (int32_t)token.value);
+        advance(parser);
+        break;
+    case TOKEN_IDENTIFIER:
+        emit(parser->program, OP_LOAD);
+        emit(parser->program, (int32_t)(token.start[0] - 'a'));
+        advance(parser);
+        break;
+    case TOKEN_LPAREN:
+        advance(parser);
+        parse_expression(parser, 1);
+        if (parser->current.kind != TOKEN_RPAREN) {
+            parser->error = 1;
+            return;
+        }
+        advance(parser);
+        break;
+    case TOKEN_OPERATOR:
+        if (token.value == '-') {
+            advance(parser);
+            parse_primary(parser);
+            emit(parser->program, OP_NEG);
+            break;
+        }
+        /* fall through */
+    default:
+        parser->error = 1;
+        break;
+    }
+}
+
+static void parse_expression(struct parser *parser, int minimum)
+{
+    parse_primary(parser);
+    while (!parser->error && parser->current.kind == TOKEN_OPERATOR && precedence(parser->current.value) >= minimum) {
+        long op = parser->current.value;
+        advance(parser);
+        parse_expression(parser, precedence(op) + 1);
+        switch (op) {
+        case '+': emit(parser->program, OP_ADD); break;
+        case '-': emit(parser->program, OP_SUB); break;
+        case '*': emit(parser->program, OP_MUL); break;
+        case '/': emit(parser->program, OP_DIV); break;
+        case '%': emit(parser->program, OP_MOD); break;
+        }
+    }
+}
+
+static long execute(const struct program *program, const long *variables)
+{
+    long stack[256];
+    size_t top = 0;
+    size_t pc = 0;
+    while (pc < program->length) {
+        long a, b;
+        switch ((enum opcode)program->code[pc++]) {
+        case OP_PUSH:
+            stack[top++] = program->code[pc++];
+            break;
+        case OP_LOAD:
+            stack[top++] = variables[program->code[pc++] & 31];
+            break;
+        case OP_ADD: b = stack[--top]; a = stack[--top]; stack[top++] = a + b; break;
+        case OP_SUB: b = stack[--top]; a = stack[--top]; stack[top++] = a - b; break;
+        case OP_MUL: b = stack[--top]; a = stack[--top]; stack[top++] = a * b; break;
+        case OP_DIV: b = stack[--top]; a = stack[--top]; stack[top++] = b ? a / b : 0; break;
+        case OP_MOD: b = stack[--top]; a = stack[--top]; stack[top++] = b ? a % b : 0; break;
+        case OP_NEG: stack[top - 1] = -stack[top - 1]; break;
+        case OP_DUP: stack[top] = stack[top - 1]; ++top; break;
+        case OP_SWAP: a = stack[top - 1]; stack[top - 1] = stack[top - 2]; stack[top - 2] = a; break;
+        case OP_JZ: a = stack[--top]; if (!a) pc = (size_t)program->code[pc]; else ++pc; break;
+        case OP_JMP: pc = (size_t)program->code[pc]; break;
+        case OP_HALT: return top ? stack[top - 1] : 0;
+        }
+        if (top >= sizeof(stack) / sizeof(stack[0]) - 1) {
+            return 0;
+        }
+    }
+    return top ? stack[top - 1] : 0;
+}
+
+long corpus_interpret(const char *source)
+{
+    struct program program = {NULL, 0, 0};
+    struct parser parser;
+    long variables[32];
+    long result = 0;
+    size_t i;
+
+    memset(&parser, 0, sizeof(parser));
+    parser.lexer.cursor = source;
+    parser.program = &program;
+    advance(&parser);
+    parse_expression(&parser, 1);
+    emit(&program, OP_HALT);
+
+    for (i = 0; i < 32; ++i) {
+        variables[i] = (long)(i * 7 % 13);
+    }
+    if (!parser.error) {
+        result = execute(&program, variables);
+    }
+    free(program.code);
+    return result;
+}
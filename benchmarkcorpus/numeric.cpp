@@ -0,0 +1,184 @@
+// Benchmark corpus: numeric loops with little header code, where compile
+// time goes to the optimizer: inlining, unrolling and vectorization.
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace corpus {
+
+template <typename T>
+class Matrix
+{
+public:
+    Matrix(std::size_t rows, std::size_t columns)
+        : m_rows(rows)
+        , m_columns(columns)
+        , m_values(rows * columns)
+    {
+    }
+
+    std::size_t rows() const { return m_rows; }
+    std::size_t columns() const { return m_columns; }
+    T &operator()(std::size_t row, std::size_t column) { return m_values[row * m_columns + column]; }
+    const T &operator()(std::size_t row, std::size_t column) const { return m_values[row * m_columns + column]; }
+
+private:
+    std::size_t m_rows;
+    std::size_t m_columns;
+    std::vector<T> m_values;
+};
+
+template <typename T>
+Matrix<T> multiply(const Matrix<T> &a, const Matrix<T> &b)
+{
+    Matrix<T> result(a.rows(), b.columns());
+    for (std::size_t i = 0; i < a.rows(); ++i) {
+        for (std::size_t k = 0; k < a.columns(); ++k) {
+            T factor = a(i, k);
+            for (std::size_t j = 0; j < b.columns(); ++j) {
+                result(i, j) += factor * b(k, j);
+            }
+        }
+    }
+    return result;
+}
+
+// Solve a x = b in place by Gaussian elimination with partial pivoting
+template <typename T>
+bool solve(Matrix<T> a, std::vector<T> &b)
+{
+    const std::size_t n = a.rows();
+    for (std::size_t column = 0; column < n; ++column) {
+        std::size_t pivot = column;
+        for (std::size_t row = column + 1; row < n; ++row) {
+            if (std::abs(a(row, column)) > std::abs(a(pivot, column))) {
+                pivot = row;
+            }
+        }
+        if (a(pivot, column) == T(0)) {
+            return false;
+        }
+        if (pivot != column) {
+            for (std::size_t j = 0; j < n; ++j) {
+                std::swap(a(pivot, j), a(column, j));
+            }
+            std::swap(b[pivot], b[column]);
+        }
+        for (std::size_t row = column + 1; row < n; ++row) {
+            T factor = a(row, column) / a(column, column);
+            for (std::size_t j = column; j < n; ++j) {
+                a(row, j) -= factor * a(column, j);
+            }
+            b[row] -= factor * b[column];
+        }
+    }
+    for (std::size_t i = n; i-- > 0;) {
+        T sum = b[i];
+        for (std::size_t j = i + 1; j < n; ++j) {
+            sum -= a(i, j) * b[j];
+        }
+        b[i] = sum / a(i, i);
+    }
+    return true;
+}
+
+// Iterative radix-2 FFT; the size must be a power of two
+void fft(std::vector<std::complex<double>> &values, bool inverse)
+{
+    const std::size_t n = values.size();
+    for (std::size_t i = 1, j = 0; i < n; ++i) {
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(values[i], values[j]);
+        }
+    }
+    for (std::size_t length = 2; length <= n; length <<= 1) {
+        double angle = 2 * M_PI / double(length) * (inverse ? -1 : 1);
+        std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (std::size_t start = 0; start < n; start += length) {
+            std::complex<double> w(1);
+            for (std::size_t k = 0; k < length / 2; ++k) {
+                std::complex<double> u = values[start + k];
+                std::complex<double> v = values[start + k + length / 2] * w;
+                values[start + k] = u + v;
+                values[start + k + length / 2] = u - v;
+                w *= step;
+            }
+        }
+    }
+    if (inverse) {
+        for (std::complex<double> &value : values) {
+            value /= double(n);
+        }
+    }
+}
+
+// One explicit step of the 2D heat equation on a square grid
+void diffuse(std::vector<float> &grid, std::vector<float> &next, std::size_t size, float rate)
+{
+    for (std::size_t y = 1; y + 1 < size; ++y) {
+        for (std::size_t x = 1; x + 1 < size; ++x) {
+            std::size_t i = y * size + x;
+            float laplacian = grid[i - 1] + grid[i + 1] + grid[i - size] + grid[i + size] - 4.0f * grid[i];
+            next[i] = grid[i] + rate * laplacian;
+        }
+    }
+    grid.swap(next);
+}
+
+double dot(const float *a, const float *b, std::size_t count)
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        sum += double(a[i]) * double(b[i]);
+    }
+    return sum;
+}
+
+void saxpy(float *y, const float *x, float a, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        y[i] += a * x[i];
+    }
+}
+
+} // namespace corpus
+
+double corpusNumeric(std::size_t size)
+{
+    using namespace corpus;
+    Matrix<double> a(size, size);
+    Matrix<float> f(size, size);
+    std::vector<double> b(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        for (std::size_t j = 0; j < size; ++j) {
+            a(i, j) = i == j ? double(size) : 1.0 / double(i + j + 1);
+            f(i, j) = float(a(i, j));
+        }
+        b[i] = double(i);
+    }
+    Matrix<double> square = multiply(a, a);
+    Matrix<float> squareF = multiply(f, f);
+    solve(square, b);
+
+    std::vector<std::complex<double>> signal(1024);
+    for (std::size_t i = 0; i < signal.size(); ++i) {
+        signal[i] = std::sin(double(i) * 0.1);
+    }
+    fft(signal, false);
+    fft(signal, true);
+
+    std::vector<float> grid(size * size, 0.0f), next(size * size, 0.0f);
+    grid[size * size / 2] = 100.0f;
+    for (int step = 0; step < 10; ++step) {
+        diffuse(grid, next, size, 0.1f);
+    }
+    saxpy(grid.data(), next.data(), 0.5f, grid.size());
+    return b[0] + signal[1].real() + dot(grid.data(), next.data(), grid.size()) + squareF(0, 0);
+}
@@ -0,0 +1,223 @@
+// Benchmark corpus: template metaprogramming, variants and constexpr
+// evaluation, which stress overload resolution and instantiation.
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace corpus {
+
+// A small expression tree over a variant of node types
+struct Number;
+struct Variable;
+struct Binary;
+using Expression = std::variant<Number, Variable, Binary>;
+
+struct Number
+{
+    double value;
+};
+
+struct Variable
+{
+    std::string name;
+};
+
+struct Binary
+{
+    char op;
+    std::shared_ptr<Expression> left;
+    std::shared_ptr<Expression> right;
+};
+
+template <typename... Handlers>
+struct Overloaded : Handlers...
+{
+    using Handlers::operator()...;
+};
+template <typename... Handlers>
+Overloaded(Handlers...) -> Overloaded<Handlers...>;
+
+double evaluate(const Expression &expression, const std::function<double(const std::string &)> &lookup)
+{
+    return std::visit(Overloaded{
+                          [](const Number &number) { return number.value; },
+                          [&lookup](const Variable &variable) { return lookup(variable.name); },
+                          [&lookup](const Binary &binary) {
+                              double left = evaluate(*binary.left, lookup);
+                              double right = evaluate(*binary.right, lookup);
+                              switch (binary.op) {
+                              case '+': return left + right;
+                              case '-': return left - right;
+                              case '*': return left * right;
+                              case '/': return right != 0.0 ? left / right : 0.0;
+                              default: return 0.0;
+                              }
+                          },
+                      },
+                      expression);
+}
+
+std::string print(const Expression &expression)
+{
+    return std::visit(Overloaded{
+                          [](const Number &number) { return std::to_string(number.value); },
+                          [](const Variable &variable) { return variable.name; },
+                          [](const Binary &binary) {
+                              return "(" + print(*binary.left) + " " + binary.op + " " + print(*binary.right) + ")";
+                          },
+                      },
+                      expression);
+}
+
+std::shared_ptr<Expression> node(Expression expression)
+{
+    return std::make_shared<Expression>(std::move(expression));
+}
+
+// Compile-time tables
+template <std::size_t N>
+constexpr std::array<std::size_t, N> fibonacci()
+{
+    std::array<std::size_t, N> values{};
+    for (std::size_t i = 0; i < N; ++i) {
+        values[i] = i < 2 ? i : values[i - 1] + values[i - 2];
+    }
+    return values;
+}
+
+template <std::size_t N>
+constexpr std::array<bool, N> sieve()
+{
+    std::array<bool, N> prime{};
+    for (std::size_t i = 2; i < N; ++i) {
+        prime[i] = true;
+    }
+    for (std::size_t i = 2; i * i < N; ++i) {
+        if (prime[i]) {
+            for (std::size_t j = i * i; j < N; j += i) {
+                prime[j] = false;
+            }
+        }
+    }
+    return prime;
+}
+
+constexpr auto Fibonacci = fibonacci<90>();
+constexpr auto Primes = sieve<4096>();
+static_assert(Fibonacci[10] == 55, "fibonacci");
+static_assert(Primes[4093] && !Primes[4095], "sieve");
+
+// Type lists
+template <typename... Types>
+struct TypeList
+{
+};
+
+template <typename List, template <typename> class Predicate>
+struct Filter;
+
+template <template <typename> class Predicate>
+struct Filter<TypeList<>, Predicate>
+{
+    using type = TypeList<>;
+};
+
+template <typename Head, typename... Tail, template <typename> class Predicate>
+struct Filter<TypeList<Head, Tail...>, Predicate>
+{
+    using Rest = typename Filter<TypeList<Tail...>, Predicate>::type;
+
+    template <typename List>
+    struct Prepend;
+    template <typename... Types>
+    struct Prepend<TypeList<Types...>>
+    {
+        using type = TypeList<Head, Types...>;
+    };
+
+    using type = std::conditional_t<Predicate<Head>::value, typename Prepend<Rest>::type, Rest>;
+};
+
+template <typename List>
+struct Size;
+template <typename... Types>
+struct Size<TypeList<Types...>> : std::integral_constant<std::size_t, sizeof...(Types)>
+{
+};
+
+using Scalars = TypeList<char, short, int, long, long long, float, double, long double, bool, unsigned,
+                         std::string, std::vector<int>, std::nullptr_t>;
+static_assert(Size<Filter<Scalars, std::is_integral>::type>::value == 7, "integral types");
+static_assert(Size<Filter<Scalars, std::is_floating_point>::type>::value == 3, "floating types");
+
+// Tuple algorithms
+template <typename Tuple, typename Function, std::size_t... Indices>
+void forEach(Tuple &&tuple, Function &&function, std::index_sequence<Indices...>)
+{
+    (function(std::get<Indices>(std::forward<Tuple>(tuple))), ...);
+}
+
+template <typename Tuple, typename Function>
+void forEach(Tuple &&tuple, Function &&function)
+{
+    constexpr std::size_t size = std::tuple_size<std::decay_t<Tuple>>::value;
+    forEach(std::forward<Tuple>(tuple), std::forward<Function>(function), std::make_index_sequence<size>());
+}
+
+template <typename... Values>
+std::string describe(const Values &...values)
+{
+    std::string result;
+    forEach(std::make_tuple(values...), [&result](const auto &value) {
+        using Type = std::decay_t<decltype(value)>;
+        if constexpr (std::is_arithmetic_v<Type>) {
+            result += std::to_string(value);
+        } else if constexpr (std::is_convertible_v<Type, std::string>) {
+            result += std::string(value);
+        } else {
+            result += "?";
+        }
+        result += ";";
+    });
+    return result;
+}
+
+template <typename T>
+std::optional<T> parseNumber(const std::string &text)
+{
+    if (text.empty()) {
+        return std::nullopt;
+    }
+    if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(std::stoll(text));
+    } else {
+        return static_cast<T>(std::stod(text));
+    }
+}
+
+} // namespace corpus
+
+std::string corpusTemplates(double x, double y)
+{
+    using namespace corpus;
+    auto tree = node(Binary{'+', node(Binary{'*', node(Number{2.0}), node(Variable{"x"})}),
+                            node(Binary{'/', node(Variable{"y"}), node(Number{3.0})})});
+    double value = evaluate(*tree, [x, y](const std::string &name) { return name == "x" ? x : y; });
+
+    std::size_t primes = 0;
+    for (bool prime : Primes) {
+        primes += prime;
+    }
+    return print(*tree) + " = " + std::to_string(value) + "; " +
+           describe(Fibonacci[40], primes, 1.5f, "text", std::vector<int>{}) +
+           std::to_string(parseNumber<int>("42").value_or(0) + parseNumber<double>("2.5").value_or(0.0));
+}
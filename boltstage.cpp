@@ -0,0 +1,196 @@
+#include "boltstage.h"
+#include "buildreport.h"
+#include "commandgenerator.h"
+#include "pgopipeline.h"
+
+#include <QDir>
+
+namespace {
+
+// Layout optimizations applied with the collected profile
+const char *const BoltOptions =
+    "-reorder-blocks=ext-tsp -reorder-functions=cdsort -split-functions -split-all-cold -split-eh -icf=1 -dyno-stats";
+
+// Ends the shell function's heredocs
+const char *const HeredocEnd = "LLVMBUILDER_EOF";
+
+QString quoted(const QString &path)
+{
+    return "\"" + path + "\"";
+}
+
+} // namespace
+
+bool BoltThroughput::isValid() const
+{
+    return baselineMs > 0 && optimizedMs > 0;
+}
+
+double BoltThroughput::speedup() const
+{
+    return isValid() ? (double(baselineMs) / optimizedMs - 1.0) * 100.0 : 0.0;
+}
+
+QString BoltThroughput::summary() const
+{
+    double percent = speedup();
+    return QString("The BOLT-optimized clang compiled the training corpus in %1 s against %2 s before "
+                   "(%3% %4 throughput)")
+        .arg(optimizedMs / 1000.0, 0, 'f', 1)
+        .arg(baselineMs / 1000.0, 0, 'f', 1)
+        .arg(qAbs(percent), 0, 'f', 1)
+        .arg(percent >= 0 ? "more" : "less");
+}
+
+BoltStage::BoltStage(const BuilderConfiguration &config, const ResourcePlan &plan)
+    : m_config(config)
+    , m_plan(plan)
+{
+}
+
+QString BoltStage::generateCommands() const
+{
+    QString bin = m_config.buildDir() + "/bin";
+    QString stamp = quoted(m_config.buildDir() + "/.llvmbuilder_bolt_") + "\"$tool\"";
+
+    // The tools build on their own, whatever the build itself was limited to
+    BuilderConfiguration toolsConfig = m_config;
+    toolsConfig.setUseDistribution(false);
+    CommandGenerator tools(toolsConfig, m_plan);
+
+    QString command = CommandGenerator::stageMarker("bolt");
+    command += "bolt_optimize() {\n";
+    command += "local bin=" + quoted(bin) + " bolt=" + quoted(m_config.buildDir() + "/bolt") +
+               " tools=\"\" tool name names binary\n";
+
+    // A binary whose checksum matches its stamp was optimized by an earlier
+    // run and not relinked since; llvm-bolt refuses to process it again
+    command += "for tool in " + binaries().join(' ') + "; do\n"
+               "binary=$(readlink -f \"$bin/$tool\") || return 1\n"
+               "if [ \"$(cksum < \"$binary\")\" = \"$(cat " + stamp + " 2>/dev/null)\" ]; then\n"
+               "echo \"$tool is already optimized by BOLT\"\n"
+               "else\n"
+               "tools=\"$tools $tool\"\n"
+               "fi\n"
+               "done\n"
+               "[ -n \"$tools\" ] || return 0\n";
+    if (usesPerf()) {
+        command += "command -v perf > /dev/null || { echo \"perf is not installed\"; return 1; }\n";
+    }
+    command += tools.generateBuildExecutionCommand() + " " + toolTargets().join(' ') + " || return 1\n";
+    command += "rm -rf \"$bolt\" && mkdir -p \"$bolt/profiles\" \"$bolt/training/bin\" \"$bolt/optimized/bin\" || return 1\n";
+    command += trainingScripts();
+
+    // Profile and rewrite each binary
+    command += "for tool in $tools; do\n"
+               "binary=$(readlink -f \"$bin/$tool\")\n"
+               "case \"$tool\" in clang) names=\"clang clang++\" ;; *) names=\"ld.lld ld64.lld\" ;; esac\n";
+    command += profileCommands();
+    command += "\"$bin/merge-fdata\" \"$bolt/profiles/$tool\".fdata* > \"$bolt/$tool.fdata\" || return 1\n"
+               "\"$bin/llvm-bolt\" \"$binary\" -o \"$bolt/$tool.bolt\" -data=\"$bolt/$tool.fdata\" " +
+               QString(BoltOptions) + " || return 1\n"
+               "done\n";
+
+    // Time the corpus with both compilers; the executor compares the stages
+    command += "case \" $tools \" in\n"
+               "*\" clang \"*)\n"
+               "ln -sf \"$bolt/clang.bolt\" \"$bolt/optimized/bin/clang\" && "
+               "ln -sf \"$bolt/clang.bolt\" \"$bolt/optimized/bin/clang++\" || return 1\n" +
+               CommandGenerator::stageMarker("bolt-baseline") +
+               "bash \"$bolt/train-clang.sh\" \"$bin\"\n" +
+               CommandGenerator::stageMarker("bolt-optimized") +
+               "bash \"$bolt/train-clang.sh\" \"$bolt/optimized/bin\"\n"
+               ";;\n"
+               "esac\n";
+
+    // Swap the optimized binaries in for the install
+    command += CommandGenerator::stageMarker("bolt-swap");
+    command += "for tool in $tools; do\n"
+               "binary=$(readlink -f \"$bin/$tool\")\n"
+               "cp \"$bolt/$tool.bolt\" \"$binary.bolt\" && mv -f \"$binary.bolt\" \"$binary\" || return 1\n"
+               "cksum < \"$binary\" > " + stamp + "\n"
+               "done\n";
+    command += "}\n";
+    command += "bolt_optimize || echo \"Warning: BOLT optimization failed; keeping the unoptimized binaries\"\n\n";
+    return command;
+}
+
+QStringList BoltStage::toolTargets() const
+{
+    QStringList targets{"llvm-bolt", "merge-fdata"};
+    targets << (usesPerf() ? "perf2bolt" : "bolt_rt");
+    return targets;
+}
+
+QStringList BoltStage::binaries()
+{
+    return QStringList{"clang", "lld"};
+}
+
+bool BoltStage::isSupported()
+{
+#if defined(Q_OS_MACOS)
+    return false;
+#else
+    return true;
+#endif
+}
+
+BoltThroughput BoltStage::throughput(const BuildReport &report)
+{
+    // The optimized run only counts once the swap stage closed it
+    BoltThroughput result;
+    bool swapped = false;
+    const QVector<BuildStage> stages = report.stages();
+    for (const BuildStage &stage : stages) {
+        qint64 duration = stage.endMs > stage.startMs ? stage.endMs - stage.startMs : 0;
+        if (stage.name == "bolt-baseline") {
+            result.baselineMs = duration;
+        } else if (stage.name == "bolt-optimized") {
+            result.optimizedMs = duration;
+        } else if (stage.name == "bolt-swap") {
+            swapped = true;
+        }
+    }
+    return swapped ? result : BoltThroughput();
+}
+
+bool BoltStage::usesPerf() const
+{
+    return m_config.boltProfile() == "perf";
+}
+
+QString BoltStage::trainingScripts() const
+{
+    // clang compiles the corpus; lld does a relocatable link of the build's
+    // own LLVM libraries, in the flavour of the host's object format
+    QString libs = quoted(m_config.buildDir() + "/lib") + "/libLLVM*.a";
+    QString output = quoted(m_config.buildDir() + "/bolt/lld-training.o");
+    return "cat > \"$bolt/train-clang.sh\" <<'" + QString(HeredocEnd) + "'\n" +
+           PgoPipeline::corpusCommands(m_config, "$1", m_config.buildDir(), m_plan.compileJobs) +
+           HeredocEnd + "\n"
+           "cat > \"$bolt/train-lld.sh\" <<'" + HeredocEnd + "'\n"
+           "case \"$(uname)\" in\n"
+           "Darwin) \"$1/ld64.lld\" -r -arch \"$(uname -m)\" -all_load " + libs + " -o " + output + " ;;\n"
+           "*) \"$1/ld.lld\" -r --whole-archive " + libs + " -o " + output + " ;;\n"
+           "esac\n"
+           "rm -f " + output + "\n" +
+           HeredocEnd + "\n";
+}
+
+QString BoltStage::profileCommands() const
+{
+    // perf samples the unmodified binary, with branch records where the CPU has them
+    if (usesPerf()) {
+        return "perf record -e cycles:u -j any,u -o \"$bolt/$tool.perf.data\" -- "
+               "bash \"$bolt/train-$tool.sh\" \"$bin\" || return 1\n"
+               "\"$bin/perf2bolt\" \"$binary\" -p \"$bolt/$tool.perf.data\" -o \"$bolt/profiles/$tool.fdata\" "
+               "|| return 1\n";
+    }
+
+    // Every process of the instrumented binary, cc1 included, writes its own profile
+    return "\"$bin/llvm-bolt\" \"$binary\" -o \"$bolt/$tool.instrumented\" -instrument "
+           "-instrumentation-file=\"$bolt/profiles/$tool.fdata\" -instrumentation-file-append-pid || return 1\n"
+           "for name in $names; do ln -sf \"$bolt/$tool.instrumented\" \"$bolt/training/bin/$name\" || return 1; done\n"
+           "bash \"$bolt/train-$tool.sh\" \"$bolt/training/bin\"\n";
+}
@@ -0,0 +1,68 @@
+#ifndef BOLTSTAGE_H
+#define BOLTSTAGE_H
+
+#include "builderconfiguration.h"
+#include "resourceplanner.h"
+
+#include <QString>
+#include <QStringList>
+
+class BuildReport;
+
+// Compile-throughput of the training corpus before and after BOLT
+struct BoltThroughput
+{
+    qint64 baselineMs = 0;
+    qint64 optimizedMs = 0;
+
+    bool isValid() const;
+
+    // How much faster the optimized clang compiled the corpus, in percent
+    double speedup() const;
+
+    QString summary() const;
+};
+
+// Post-link optimization of the built clang and lld with llvm-bolt: a
+// profile of each binary is collected on the training corpus, from an
+// instrumented copy or from perf, and the binaries are rewritten with an
+// optimized code layout and swapped in before the install. Failures leave
+// the unoptimized binaries in place.
+class BoltStage
+{
+public:
+    // The job counts come from the plan of the build the stage belongs to
+    BoltStage(const BuilderConfiguration &config, const ResourcePlan &plan);
+
+    // Commands run after a successful build
+    QString generateCommands() const;
+
+    // Targets llvm-bolt needs beyond the build: the tools and the runtime or
+    // perf converter for the chosen profile
+    QStringList toolTargets() const;
+
+    // Binaries that are optimized, as named in the build's bin directory
+    static QStringList binaries();
+
+    // Whether the host can run the stage: llvm-bolt rewrites ELF binaries,
+    // and neither its instrumentation runtime nor perf exist on macOS
+    static bool isSupported();
+
+    // The baseline and optimized corpus runs recorded in a build report
+    static BoltThroughput throughput(const BuildReport &report);
+
+private:
+    BuilderConfiguration m_config;
+    ResourcePlan m_plan;
+
+    // Whether the profile comes from perf rather than instrumentation
+    bool usesPerf() const;
+
+    // Scripts that exercise clang or lld from the bin directory given as $1
+    QString trainingScripts() const;
+
+    // Collect the profile of $tool into $bolt/$tool.fdata
+    QString profileCommands() const;
+};
+
+#endif // BOLTSTAGE_H
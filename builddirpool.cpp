@@ -0,0 +1,274 @@
+#include "builddirpool.h"
+#include "builderconfiguration.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+
+BuildDirPool::BuildDirPool(const QString &root)
+    : m_root(root)
+{
+}
+
+bool BuildDirPool::load()
+{
+    m_entries.clear();
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return !file.exists();
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isNull() || !doc.isObject()) {
+        return false;
+    }
+
+    const QJsonArray entries = doc.object()["entries"].toArray();
+    for (const QJsonValue &value : entries) {
+        QJsonObject json = value.toObject();
+        Entry entry;
+        entry.hash = json["hash"].toString();
+        entry.description = json["description"].toString();
+        entry.lastUsedMs = json["lastUsedMs"].toVariant().toLongLong();
+        entry.sizeBytes = json["sizeBytes"].toVariant().toLongLong();
+        if (!entry.hash.isEmpty()) {
+            m_entries.append(entry);
+        }
+    }
+    return true;
+}
+
+bool BuildDirPool::save() const
+{
+    if (!QDir().mkpath(m_root)) {
+        return false;
+    }
+
+    QJsonArray entries;
+    for (const Entry &entry : m_entries) {
+        QJsonObject json;
+        json["hash"] = entry.hash;
+        json["description"] = entry.description;
+        json["lastUsedMs"] = entry.lastUsedMs;
+        json["sizeBytes"] = entry.sizeBytes;
+        entries.append(json);
+    }
+    QJsonObject json;
+    json["entries"] = entries;
+
+    QFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(json).toJson());
+    return true;
+}
+
+QString BuildDirPool::acquire(const BuilderConfiguration &config)
+{
+    QString hash = configHash(config);
+    int index = indexOf(hash);
+    if (index < 0) {
+        Entry entry;
+        entry.hash = hash;
+        m_entries.append(entry);
+        index = m_entries.size() - 1;
+    }
+
+    Entry &entry = m_entries[index];
+    entry.description = describe(config);
+    entry.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+
+    QString path = directory(hash);
+    QDir().mkpath(path);
+    return path;
+}
+
+void BuildDirPool::refreshSize(const QString &hash)
+{
+    for (Entry &entry : m_entries) {
+        if (hash.isEmpty() || entry.hash == hash) {
+            entry.sizeBytes = directorySize(directory(entry.hash));
+        }
+    }
+}
+
+QStringList BuildDirPool::evict(qint64 budgetBytes, const QString &keepHash)
+{
+    QStringList removed;
+    if (budgetBytes <= 0) {
+        return removed;
+    }
+
+    // Oldest first
+    QVector<Entry> byAge = m_entries;
+    std::sort(byAge.begin(), byAge.end(),
+              [](const Entry &a, const Entry &b) { return a.lastUsedMs < b.lastUsedMs; });
+
+    qint64 total = totalSize();
+    for (const Entry &entry : byAge) {
+        if (total <= budgetBytes) {
+            break;
+        }
+        if (entry.hash == keepHash) {
+            continue;
+        }
+        if (remove(entry.hash)) {
+            removed.append(directory(entry.hash));
+            total -= entry.sizeBytes;
+        }
+    }
+    return removed;
+}
+
+bool BuildDirPool::remove(const QString &hash)
+{
+    int index = indexOf(hash);
+    if (index < 0) {
+        return false;
+    }
+
+    QDir dir(directory(hash));
+    if (dir.exists() && !dir.removeRecursively()) {
+        return false;
+    }
+    m_entries.removeAt(index);
+    return true;
+}
+
+QVector<BuildDirPool::Entry> BuildDirPool::entries() const
+{
+    return m_entries;
+}
+
+QString BuildDirPool::root() const
+{
+    return m_root;
+}
+
+QString BuildDirPool::directory(const QString &hash) const
+{
+    return QDir(m_root).filePath(hash);
+}
+
+qint64 BuildDirPool::totalSize() const
+{
+    qint64 total = 0;
+    for (const Entry &entry : m_entries) {
+        total += entry.sizeBytes;
+    }
+    return total;
+}
+
+QString BuildDirPool::buildDirFor(const BuilderConfiguration &config)
+{
+    if (!config.useBuildDirPool()) {
+        return config.buildDir();
+    }
+    return BuildDirPool(config.buildDirPoolRoot()).directory(configHash(config));
+}
+
+QString BuildDirPool::configHash(const BuilderConfiguration &config)
+{
+    // QJsonObject keeps its keys sorted, so the serialization is stable
+    QByteArray data = QJsonDocument(cmakeFields(config)).toJson(QJsonDocument::Compact);
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex().left(12));
+}
+
+QString BuildDirPool::describe(const BuilderConfiguration &config)
+{
+    QStringList parts;
+    parts << (config.noLto() ? "no LTO" : config.fullLto() ? "Full LTO" : "Thin LTO");
+    parts << (config.useDylib() ? "dylib" : "static");
+    if (config.doTesting()) {
+        parts << "tests";
+    }
+    if (config.benchmark()) {
+        parts << "benchmarks";
+    }
+    parts << "-O" + config.optLevel();
+    parts << config.compiler();
+    parts << config.projects();
+    return parts.join(", ");
+}
+
+qint64 BuildDirPool::directorySize(const QString &path)
+{
+    qint64 total = 0;
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
+
+int BuildDirPool::indexOf(const QString &hash) const
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).hash == hash) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QString BuildDirPool::indexPath() const
+{
+    return QDir(m_root).filePath("pool.json");
+}
+
+QJsonObject BuildDirPool::cmakeFields(const BuilderConfiguration &config)
+{
+    // Everything generateCMakeCommand() turns into a cache variable, except
+    // the build directory itself and host-dependent job counts
+    QJsonObject json;
+    json["compilerPath"] = config.compilerPath();
+    json["llvmDir"] = config.llvmDir();
+    json["installPath"] = config.installPath();
+    json["projects"] = config.projects();
+    json["runtimes"] = config.runtimes();
+    json["compiler"] = config.compiler();
+    json["cxxCompiler"] = config.cxxCompiler();
+    json["linker"] = config.linker();
+    json["optLevel"] = config.optLevel();
+    json["arch"] = config.arch();
+    json["osxArch"] = config.osxArch();
+    json["ffi"] = config.ffi();
+    json["zlib"] = config.zlib();
+    json["terminfo"] = config.terminfo();
+    json["xml2"] = config.xml2();
+    json["noLto"] = config.noLto();
+    json["fullLto"] = config.fullLto();
+    json["useMake"] = config.useMake();
+    json["useLocalPython"] = config.useLocalPython();
+    json["useDylib"] = config.useDylib();
+    json["xcodeToolchain"] = config.xcodeToolchain();
+    json["useXcodeGcc"] = config.useXcodeGcc();
+    json["modules"] = config.modules();
+    json["backtraces"] = config.backtraces();
+    json["doNotWarn"] = config.doNotWarn();
+    json["doTesting"] = config.doTesting();
+    json["benchmark"] = config.benchmark();
+    json["timeTrace"] = config.timeTrace();
+    json["compilerCache"] = config.compilerCache();
+    if (config.useDistribution()) {
+        json["distributionComponents"] = config.distributionComponents();
+    }
+    if (config.boltOptimize()) {
+        json["boltOptimize"] = true;
+    }
+    if (config.pgoPipeline()) {
+        json["pgoCorpus"] = config.pgoCorpus();
+        json["pgoCorpusFlags"] = config.pgoCorpusFlags();
+    }
+    return json;
+}
@@ -0,0 +1,74 @@
+#ifndef BUILDDIRPOOL_H
+#define BUILDDIRPOOL_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+
+class BuilderConfiguration;
+
+// A set of build directories under one root, one per distinct CMake
+// configuration. Switching back to a configuration that was built before
+// reuses its directory for an incremental build. An index in the root
+// records each directory's size and last use so the least recently used
+// ones can be evicted to stay within a disk budget.
+class BuildDirPool
+{
+public:
+    struct Entry {
+        QString hash;
+        QString description;
+        qint64 lastUsedMs = 0;
+        qint64 sizeBytes = 0;
+    };
+
+    explicit BuildDirPool(const QString &root);
+
+    // Load the index; a missing index is an empty pool
+    bool load();
+    bool save() const;
+
+    // Directory for a configuration, created and marked as used now
+    QString acquire(const BuilderConfiguration &config);
+
+    // Re-measure the size of one directory, or of all when hash is empty
+    void refreshSize(const QString &hash = QString());
+
+    // Remove least recently used directories until the pool fits in
+    // budgetBytes, never touching keepHash; returns the removed directories
+    QStringList evict(qint64 budgetBytes, const QString &keepHash);
+
+    // Remove one directory and its index entry
+    bool remove(const QString &hash);
+
+    QVector<Entry> entries() const;
+    QString root() const;
+    QString directory(const QString &hash) const;
+    qint64 totalSize() const;
+
+    // The directory a configuration builds in: its pool directory when the
+    // pool is enabled, otherwise the configured build directory
+    static QString buildDirFor(const BuilderConfiguration &config);
+
+    // Stable hash of the fields that change the CMake configuration
+    static QString configHash(const BuilderConfiguration &config);
+
+    // Short human-readable summary of those fields
+    static QString describe(const BuilderConfiguration &config);
+
+    // Total size of the files under a directory
+    static qint64 directorySize(const QString &path);
+
+private:
+    QString m_root;
+    QVector<Entry> m_entries;
+
+    int indexOf(const QString &hash) const;
+    QString indexPath() const;
+
+    // The fields hashed by configHash(), as a JSON object
+    static QJsonObject cmakeFields(const BuilderConfiguration &config);
+};
+
+#endif // BUILDDIRPOOL_H
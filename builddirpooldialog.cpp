@@ -0,0 +1,107 @@
+#include "builddirpooldialog.h"
+#include "ui_builddirpooldialog.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QMessageBox>
+
+namespace {
+
+QString gigabytes(qint64 bytes)
+{
+    return QString::number(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 1);
+}
+
+// Kept numeric so the column sorts by size rather than as text
+double roundedGigabytes(qint64 bytes)
+{
+    return qRound(bytes / (1024.0 * 1024.0 * 1024.0) * 10.0) / 10.0;
+}
+
+} // namespace
+
+BuildDirPoolDialog::BuildDirPoolDialog(const QString &root, qint64 budgetBytes, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::BuildDirPoolDialog)
+    , m_pool(root)
+    , m_budgetBytes(budgetBytes)
+{
+    ui->setupUi(this);
+    
+    m_pool.load();
+    populate();
+    ui->poolTreeWidget->sortByColumn(3, Qt::DescendingOrder);
+}
+
+BuildDirPoolDialog::~BuildDirPoolDialog()
+{
+    delete ui;
+}
+
+void BuildDirPoolDialog::on_refreshButton_clicked()
+{
+    // Walking every build tree takes a while
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    m_pool.refreshSize();
+    m_pool.save();
+    QApplication::restoreOverrideCursor();
+    
+    populate();
+}
+
+void BuildDirPoolDialog::on_removeButton_clicked()
+{
+    QTreeWidgetItem *item = ui->poolTreeWidget->currentItem();
+    if (!item) {
+        return;
+    }
+    
+    QString hash = item->data(0, Qt::UserRole).toString();
+    QMessageBox::StandardButton reply = QMessageBox::question(this, "Remove Build Directory",
+                                                            "Delete " + m_pool.directory(hash) + "?",
+                                                            QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) {
+        return;
+    }
+    
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool removed = m_pool.remove(hash);
+    QApplication::restoreOverrideCursor();
+    if (!removed) {
+        QMessageBox::warning(this, "Remove Error", "Failed to remove " + m_pool.directory(hash));
+    }
+    m_pool.save();
+    populate();
+}
+
+void BuildDirPoolDialog::on_poolTreeWidget_itemSelectionChanged()
+{
+    ui->removeButton->setEnabled(ui->poolTreeWidget->currentItem() != nullptr);
+}
+
+void BuildDirPoolDialog::populate()
+{
+    QTreeWidget *tree = ui->poolTreeWidget;
+    tree->setSortingEnabled(false);
+    tree->clear();
+    
+    const QVector<BuildDirPool::Entry> entries = m_pool.entries();
+    for (const BuildDirPool::Entry &entry : entries) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(tree);
+        item->setText(0, m_pool.directory(entry.hash));
+        item->setData(0, Qt::UserRole, entry.hash);
+        item->setText(1, entry.description);
+        item->setData(2, Qt::DisplayRole, roundedGigabytes(entry.sizeBytes));
+        item->setText(3, QDateTime::fromMSecsSinceEpoch(entry.lastUsedMs).toString("yyyy-MM-dd hh:mm"));
+    }
+    
+    tree->setSortingEnabled(true);
+    tree->resizeColumnToContents(0);
+    ui->removeButton->setEnabled(false);
+    
+    ui->summaryLabel->setText(QString("%1 directories under %2 using %3 GB of a %4 GB budget.")
+                                  .arg(entries.size())
+                                  .arg(m_pool.root())
+                                  .arg(gigabytes(m_pool.totalSize()))
+                                  .arg(gigabytes(m_budgetBytes)));
+}
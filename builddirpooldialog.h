@@ -0,0 +1,36 @@
+#ifndef BUILDDIRPOOLDIALOG_H
+#define BUILDDIRPOOLDIALOG_H
+
+#include "builddirpool.h"
+
+#include <QDialog>
+
+namespace Ui {
+class BuildDirPoolDialog;
+}
+
+// Lists the directories of the build directory pool with their size and
+// last use, and lets the user remove them by hand
+class BuildDirPoolDialog : public QDialog
+{
+    Q_OBJECT
+    
+public:
+    BuildDirPoolDialog(const QString &root, qint64 budgetBytes, QWidget *parent = nullptr);
+    ~BuildDirPoolDialog();
+    
+private slots:
+    void on_refreshButton_clicked();
+    void on_removeButton_clicked();
+    void on_poolTreeWidget_itemSelectionChanged();
+    
+private:
+    Ui::BuildDirPoolDialog *ui;
+    BuildDirPool m_pool;
+    qint64 m_budgetBytes;
+    
+    // Fill the list from the pool index
+    void populate();
+};
+
+#endif // BUILDDIRPOOLDIALOG_H
@@ -52,6 +52,68 @@ void BuilderConfiguration::resetToDefaults()
     m_doTesting = false;
     m_benchmark = false;
     m_botMode = false;
+    m_timeTrace = false;
+
+    // Output settings
+    m_outputUpdateRate = 10;
+    m_outputMemoryLimit = 64;
+
+    // Parallelism settings
+    m_compileJobs = 0;
+    m_linkJobs = 0;
+    m_useJobServer = false;
+
+    // Compiler cache settings
+    m_compilerCache = "none";
+    m_cacheDir = "";
+    m_cacheSize = 20;
+
+    // Build directory pool settings
+    m_useBuildDirPool = false;
+    m_buildDirPoolRoot = QDir::homePath() + "/llvm-build-pool";
+    m_buildDirPoolBudget = 200;
+    m_cleanPooledBuildDir = false;
+
+    // Configure seed settings
+    m_seedConfigure = true;
+
+    // Rebuild forecast settings
+    m_forecastRebuild = true;
+
+    // Distribution settings
+    m_useDistribution = false;
+    m_distributionComponents = "clang;clang-resource-headers;lld;llvm-ar;llvm-nm;llvm-objcopy;llvm-objdump;llvm-strip;llvm-symbolizer;llvm-profdata;runtimes";
+    m_stripDistribution = true;
+
+    // PGO pipeline settings
+    m_pgoPipeline = false;
+    m_pgoCorpus = "";
+    m_pgoCorpusFlags = "";
+
+    // BOLT settings
+    m_boltOptimize = false;
+    m_boltProfile = "instrument";
+
+    // Compiler A/B benchmark settings
+    m_abBenchmark = false;
+    m_abBenchmarkRuns = 5;
+    m_benchmarkCorpus = "";
+    m_benchmarkCorpusFlags = "";
+
+    // Microbenchmark settings
+    m_benchmarkRepetitions = 5;
+
+    // Pipelined stages settings
+    m_pipelineStages = false;
+
+    // Source checkout settings
+    m_sparseCheckout = false;
+    m_sourceRepository = "https://github.com/llvm/llvm-project.git";
+
+    // Source prefetch settings
+    m_prefetchSources = false;
+    m_prefetchIntervalMinutes = 15;
+    m_warmPageCache = false;
 }
 
 // Path settings
@@ -162,6 +224,123 @@ void BuilderConfiguration::setBenchmark(bool benchmark) { m_benchmark = benchmar
 bool BuilderConfiguration::botMode() const { return m_botMode; }
 void BuilderConfiguration::setBotMode(bool bot) { m_botMode = bot; }
 
+bool BuilderConfiguration::timeTrace() const { return m_timeTrace; }
+void BuilderConfiguration::setTimeTrace(bool enabled) { m_timeTrace = enabled; }
+
+// Output settings
+int BuilderConfiguration::outputUpdateRate() const { return m_outputUpdateRate; }
+void BuilderConfiguration::setOutputUpdateRate(int updatesPerSecond) { m_outputUpdateRate = updatesPerSecond; }
+
+int BuilderConfiguration::outputMemoryLimit() const { return m_outputMemoryLimit; }
+void BuilderConfiguration::setOutputMemoryLimit(int megabytes) { m_outputMemoryLimit = megabytes; }
+
+// Parallelism settings
+int BuilderConfiguration::compileJobs() const { return m_compileJobs; }
+void BuilderConfiguration::setCompileJobs(int jobs) { m_compileJobs = jobs; }
+
+int BuilderConfiguration::linkJobs() const { return m_linkJobs; }
+void BuilderConfiguration::setLinkJobs(int jobs) { m_linkJobs = jobs; }
+
+bool BuilderConfiguration::useJobServer() const { return m_useJobServer; }
+void BuilderConfiguration::setUseJobServer(bool enabled) { m_useJobServer = enabled; }
+
+// Compiler cache settings
+QString BuilderConfiguration::compilerCache() const { return m_compilerCache; }
+void BuilderConfiguration::setCompilerCache(const QString &tool) { m_compilerCache = tool; }
+
+QString BuilderConfiguration::cacheDir() const { return m_cacheDir; }
+void BuilderConfiguration::setCacheDir(const QString &dir) { m_cacheDir = dir; }
+
+int BuilderConfiguration::cacheSize() const { return m_cacheSize; }
+void BuilderConfiguration::setCacheSize(int gigabytes) { m_cacheSize = gigabytes; }
+
+// Build directory pool settings
+bool BuilderConfiguration::useBuildDirPool() const { return m_useBuildDirPool; }
+void BuilderConfiguration::setUseBuildDirPool(bool enabled) { m_useBuildDirPool = enabled; }
+
+QString BuilderConfiguration::buildDirPoolRoot() const { return m_buildDirPoolRoot; }
+void BuilderConfiguration::setBuildDirPoolRoot(const QString &root) { m_buildDirPoolRoot = root; }
+
+int BuilderConfiguration::buildDirPoolBudget() const { return m_buildDirPoolBudget; }
+void BuilderConfiguration::setBuildDirPoolBudget(int gigabytes) { m_buildDirPoolBudget = gigabytes; }
+
+bool BuilderConfiguration::cleanPooledBuildDir() const { return m_cleanPooledBuildDir; }
+void BuilderConfiguration::setCleanPooledBuildDir(bool enabled) { m_cleanPooledBuildDir = enabled; }
+
+// Configure seed settings
+bool BuilderConfiguration::seedConfigure() const { return m_seedConfigure; }
+void BuilderConfiguration::setSeedConfigure(bool enabled) { m_seedConfigure = enabled; }
+
+// Rebuild forecast settings
+bool BuilderConfiguration::forecastRebuild() const { return m_forecastRebuild; }
+void BuilderConfiguration::setForecastRebuild(bool enabled) { m_forecastRebuild = enabled; }
+
+
+// Distribution settings
+bool BuilderConfiguration::useDistribution() const { return m_useDistribution; }
+void BuilderConfiguration::setUseDistribution(bool enabled) { m_useDistribution = enabled; }
+
+QString BuilderConfiguration::distributionComponents() const { return m_distributionComponents; }
+void BuilderConfiguration::setDistributionComponents(const QString &components) { m_distributionComponents = components; }
+
+bool BuilderConfiguration::stripDistribution() const { return m_stripDistribution; }
+void BuilderConfiguration::setStripDistribution(bool enabled) { m_stripDistribution = enabled; }
+
+// PGO pipeline settings
+bool BuilderConfiguration::pgoPipeline() const { return m_pgoPipeline; }
+void BuilderConfiguration::setPgoPipeline(bool enabled) { m_pgoPipeline = enabled; }
+
+QString BuilderConfiguration::pgoCorpus() const { return m_pgoCorpus; }
+void BuilderConfiguration::setPgoCorpus(const QString &path) { m_pgoCorpus = path; }
+
+QString BuilderConfiguration::pgoCorpusFlags() const { return m_pgoCorpusFlags; }
+void BuilderConfiguration::setPgoCorpusFlags(const QString &flags) { m_pgoCorpusFlags = flags; }
+
+// BOLT settings
+bool BuilderConfiguration::boltOptimize() const { return m_boltOptimize; }
+void BuilderConfiguration::setBoltOptimize(bool enabled) { m_boltOptimize = enabled; }
+
+QString BuilderConfiguration::boltProfile() const { return m_boltProfile; }
+void BuilderConfiguration::setBoltProfile(const QString &mode) { m_boltProfile = mode; }
+
+// Compiler A/B benchmark settings
+bool BuilderConfiguration::abBenchmark() const { return m_abBenchmark; }
+void BuilderConfiguration::setAbBenchmark(bool enabled) { m_abBenchmark = enabled; }
+
+int BuilderConfiguration::abBenchmarkRuns() const { return m_abBenchmarkRuns; }
+void BuilderConfiguration::setAbBenchmarkRuns(int runs) { m_abBenchmarkRuns = runs; }
+
+QString BuilderConfiguration::benchmarkCorpus() const { return m_benchmarkCorpus; }
+void BuilderConfiguration::setBenchmarkCorpus(const QString &path) { m_benchmarkCorpus = path; }
+
+QString BuilderConfiguration::benchmarkCorpusFlags() const { return m_benchmarkCorpusFlags; }
+void BuilderConfiguration::setBenchmarkCorpusFlags(const QString &flags) { m_benchmarkCorpusFlags = flags; }
+
+// Microbenchmark settings
+int BuilderConfiguration::benchmarkRepetitions() const { return m_benchmarkRepetitions; }
+void BuilderConfiguration::setBenchmarkRepetitions(int repetitions) { m_benchmarkRepetitions = repetitions; }
+
+// Pipelined stages settings
+bool BuilderConfiguration::pipelineStages() const { return m_pipelineStages; }
+void BuilderConfiguration::setPipelineStages(bool enabled) { m_pipelineStages = enabled; }
+
+// Source checkout settings
+bool BuilderConfiguration::sparseCheckout() const { return m_sparseCheckout; }
+void BuilderConfiguration::setSparseCheckout(bool enabled) { m_sparseCheckout = enabled; }
+
+QString BuilderConfiguration::sourceRepository() const { return m_sourceRepository; }
+void BuilderConfiguration::setSourceRepository(const QString &url) { m_sourceRepository = url; }
+
+// Source prefetch settings
+bool BuilderConfiguration::prefetchSources() const { return m_prefetchSources; }
+void BuilderConfiguration::setPrefetchSources(bool enabled) { m_prefetchSources = enabled; }
+
+int BuilderConfiguration::prefetchIntervalMinutes() const { return m_prefetchIntervalMinutes; }
+void BuilderConfiguration::setPrefetchIntervalMinutes(int minutes) { m_prefetchIntervalMinutes = minutes; }
+
+bool BuilderConfiguration::warmPageCache() const { return m_warmPageCache; }
+void BuilderConfiguration::setWarmPageCache(bool enabled) { m_warmPageCache = enabled; }
+
 QJsonObject BuilderConfiguration::toJson() const
 {
     QJsonObject json;
@@ -206,6 +385,68 @@ QJsonObject BuilderConfiguration::toJson() const
     json["doTesting"] = m_doTesting;
     json["benchmark"] = m_benchmark;
     json["botMode"] = m_botMode;
+    json["timeTrace"] = m_timeTrace;
+
+    // Output settings
+    json["outputUpdateRate"] = m_outputUpdateRate;
+    json["outputMemoryLimit"] = m_outputMemoryLimit;
+
+    // Parallelism settings
+    json["compileJobs"] = m_compileJobs;
+    json["linkJobs"] = m_linkJobs;
+    json["useJobServer"] = m_useJobServer;
+
+    // Compiler cache settings
+    json["compilerCache"] = m_compilerCache;
+    json["cacheDir"] = m_cacheDir;
+    json["cacheSize"] = m_cacheSize;
+
+    // Build directory pool settings
+    json["useBuildDirPool"] = m_useBuildDirPool;
+    json["buildDirPoolRoot"] = m_buildDirPoolRoot;
+    json["buildDirPoolBudget"] = m_buildDirPoolBudget;
+    json["cleanPooledBuildDir"] = m_cleanPooledBuildDir;
+
+    // Configure seed settings
+    json["seedConfigure"] = m_seedConfigure;
+
+    // Rebuild forecast settings
+    json["forecastRebuild"] = m_forecastRebuild;
+
+    // Distribution settings
+    json["useDistribution"] = m_useDistribution;
+    json["distributionComponents"] = m_distributionComponents;
+    json["stripDistribution"] = m_stripDistribution;
+
+    // PGO pipeline settings
+    json["pgoPipeline"] = m_pgoPipeline;
+    json["pgoCorpus"] = m_pgoCorpus;
+    json["pgoCorpusFlags"] = m_pgoCorpusFlags;
+
+    // BOLT settings
+    json["boltOptimize"] = m_boltOptimize;
+    json["boltProfile"] = m_boltProfile;
+
+    // Compiler A/B benchmark settings
+    json["abBenchmark"] = m_abBenchmark;
+    json["abBenchmarkRuns"] = m_abBenchmarkRuns;
+    json["benchmarkCorpus"] = m_benchmarkCorpus;
+    json["benchmarkCorpusFlags"] = m_benchmarkCorpusFlags;
+
+    // Microbenchmark settings
+    json["benchmarkRepetitions"] = m_benchmarkRepetitions;
+
+    // Pipelined stages settings
+    json["pipelineStages"] = m_pipelineStages;
+
+    // Source checkout settings
+    json["sparseCheckout"] = m_sparseCheckout;
+    json["sourceRepository"] = m_sourceRepository;
+
+    // Source prefetch settings
+    json["prefetchSources"] = m_prefetchSources;
+    json["prefetchIntervalMinutes"] = m_prefetchIntervalMinutes;
+    json["warmPageCache"] = m_warmPageCache;
 
     return json;
 }
@@ -252,6 +493,68 @@ void BuilderConfiguration::fromJson(const QJsonObject &json)
     if (json.contains("doTesting")) m_doTesting = json["doTesting"].toBool();
     if (json.contains("benchmark")) m_benchmark = json["benchmark"].toBool();
     if (json.contains("botMode")) m_botMode = json["botMode"].toBool();
+    if (json.contains("timeTrace")) m_timeTrace = json["timeTrace"].toBool();
+
+    // Output settings
+    if (json.contains("outputUpdateRate")) m_outputUpdateRate = json["outputUpdateRate"].toInt();
+    if (json.contains("outputMemoryLimit")) m_outputMemoryLimit = json["outputMemoryLimit"].toInt();
+
+    // Parallelism settings
+    if (json.contains("compileJobs")) m_compileJobs = json["compileJobs"].toInt();
+    if (json.contains("linkJobs")) m_linkJobs = json["linkJobs"].toInt();
+    if (json.contains("useJobServer")) m_useJobServer = json["useJobServer"].toBool();
+
+    // Compiler cache settings
+    if (json.contains("compilerCache")) m_compilerCache = json["compilerCache"].toString();
+    if (json.contains("cacheDir")) m_cacheDir = json["cacheDir"].toString();
+    if (json.contains("cacheSize")) m_cacheSize = json["cacheSize"].toInt();
+
+    // Build directory pool settings
+    if (json.contains("useBuildDirPool")) m_useBuildDirPool = json["useBuildDirPool"].toBool();
+    if (json.contains("buildDirPoolRoot")) m_buildDirPoolRoot = json["buildDirPoolRoot"].toString();
+    if (json.contains("buildDirPoolBudget")) m_buildDirPoolBudget = json["buildDirPoolBudget"].toInt();
+    if (json.contains("cleanPooledBuildDir")) m_cleanPooledBuildDir = json["cleanPooledBuildDir"].toBool();
+
+    // Configure seed settings
+    if (json.contains("seedConfigure")) m_seedConfigure = json["seedConfigure"].toBool();
+
+    // Rebuild forecast settings
+    if (json.contains("forecastRebuild")) m_forecastRebuild = json["forecastRebuild"].toBool();
+
+    // Distribution settings
+    if (json.contains("useDistribution")) m_useDistribution = json["useDistribution"].toBool();
+    if (json.contains("distributionComponents")) m_distributionComponents = json["distributionComponents"].toString();
+    if (json.contains("stripDistribution")) m_stripDistribution = json["stripDistribution"].toBool();
+
+    // PGO pipeline settings
+    if (json.contains("pgoPipeline")) m_pgoPipeline = json["pgoPipeline"].toBool();
+    if (json.contains("pgoCorpus")) m_pgoCorpus = json["pgoCorpus"].toString();
+    if (json.contains("pgoCorpusFlags")) m_pgoCorpusFlags = json["pgoCorpusFlags"].toString();
+
+    // BOLT settings
+    if (json.contains("boltOptimize")) m_boltOptimize = json["boltOptimize"].toBool();
+    if (json.contains("boltProfile")) m_boltProfile = json["boltProfile"].toString();
+
+    // Compiler A/B benchmark settings
+    if (json.contains("abBenchmark")) m_abBenchmark = json["abBenchmark"].toBool();
+    if (json.contains("abBenchmarkRuns")) m_abBenchmarkRuns = json["abBenchmarkRuns"].toInt();
+    if (json.contains("benchmarkCorpus")) m_benchmarkCorpus = json["benchmarkCorpus"].toString();
+    if (json.contains("benchmarkCorpusFlags")) m_benchmarkCorpusFlags = json["benchmarkCorpusFlags"].toString();
+
+    // Microbenchmark settings
+    if (json.contains("benchmarkRepetitions")) m_benchmarkRepetitions = json["benchmarkRepetitions"].toInt();
+
+    // Pipelined stages settings
+    if (json.contains("pipelineStages")) m_pipelineStages = json["pipelineStages"].toBool();
+
+    // Source checkout settings
+    if (json.contains("sparseCheckout")) m_sparseCheckout = json["sparseCheckout"].toBool();
+    if (json.contains("sourceRepository")) m_sourceRepository = json["sourceRepository"].toString();
+
+    // Source prefetch settings
+    if (json.contains("prefetchSources")) m_prefetchSources = json["prefetchSources"].toBool();
+    if (json.contains("prefetchIntervalMinutes")) m_prefetchIntervalMinutes = json["prefetchIntervalMinutes"].toInt();
+    if (json.contains("warmPageCache")) m_warmPageCache = json["warmPageCache"].toBool();
 }
 
 bool BuilderConfiguration::saveToFile(const QString &filePath) const
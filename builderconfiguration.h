@@ -119,6 +119,132 @@ public:
     bool botMode() const;
     void setBotMode(bool bot);
     
+    bool timeTrace() const;
+    void setTimeTrace(bool enabled);
+    
+    // Output settings
+    int outputUpdateRate() const;
+    void setOutputUpdateRate(int updatesPerSecond);
+    
+    int outputMemoryLimit() const;
+    void setOutputMemoryLimit(int megabytes);
+    
+    // Parallelism settings (0 = derive from the host)
+    int compileJobs() const;
+    void setCompileJobs(int jobs);
+    
+    int linkJobs() const;
+    void setLinkJobs(int jobs);
+    
+    bool useJobServer() const;
+    void setUseJobServer(bool enabled);
+    
+    // Compiler cache settings ("none", "ccache" or "sccache"; size in GB)
+    QString compilerCache() const;
+    void setCompilerCache(const QString &tool);
+    
+    QString cacheDir() const;
+    void setCacheDir(const QString &dir);
+    
+    int cacheSize() const;
+    void setCacheSize(int gigabytes);
+    
+    // Build directory pool settings (one build directory per configuration
+    // under the pool root; budget in GB)
+    bool useBuildDirPool() const;
+    void setUseBuildDirPool(bool enabled);
+    
+    QString buildDirPoolRoot() const;
+    void setBuildDirPoolRoot(const QString &root);
+    
+    int buildDirPoolBudget() const;
+    void setBuildDirPoolBudget(int gigabytes);
+    
+    // Honor Clean Build Directory for a reused pooled directory too
+    bool cleanPooledBuildDir() const;
+    void setCleanPooledBuildDir(bool enabled);
+    
+    // Configure seed settings (clean configures reuse the check results of the same toolchain)
+    bool seedConfigure() const;
+    void setSeedConfigure(bool enabled);
+    
+    // Rebuild forecast settings (forecast an incremental build before it starts)
+    bool forecastRebuild() const;
+    void setForecastRebuild(bool enabled);
+    
+    // Distribution settings (build and install only the semicolon-separated
+    // LLVM_DISTRIBUTION_COMPONENTS instead of everything)
+    bool useDistribution() const;
+    void setUseDistribution(bool enabled);
+    
+    QString distributionComponents() const;
+    void setDistributionComponents(const QString &components);
+    
+    bool stripDistribution() const;
+    void setStripDistribution(bool enabled);
+    
+    // PGO pipeline settings (bootstrap through an instrumented stage; an
+    // empty corpus trains on LLVM's Support library)
+    bool pgoPipeline() const;
+    void setPgoPipeline(bool enabled);
+    
+    QString pgoCorpus() const;
+    void setPgoCorpus(const QString &path);
+    
+    QString pgoCorpusFlags() const;
+    void setPgoCorpusFlags(const QString &flags);
+    
+    // BOLT settings (post-link optimization of clang and lld; the profile
+    // comes from "instrument"ed binaries or from "perf")
+    bool boltOptimize() const;
+    void setBoltOptimize(bool enabled);
+    
+    QString boltProfile() const;
+    void setBoltProfile(const QString &mode);
+    
+    // Compiler A/B benchmark settings (the built compiler against the one in
+    // compilerPath; an empty corpus uses the sources built into the application)
+    bool abBenchmark() const;
+    void setAbBenchmark(bool enabled);
+    
+    int abBenchmarkRuns() const;
+    void setAbBenchmarkRuns(int runs);
+    
+    QString benchmarkCorpus() const;
+    void setBenchmarkCorpus(const QString &path);
+    
+    QString benchmarkCorpusFlags() const;
+    void setBenchmarkCorpusFlags(const QString &flags);
+    
+    // Microbenchmark settings (repetitions of each google-benchmark run
+    // when benchmarks are built)
+    int benchmarkRepetitions() const;
+    void setBenchmarkRepetitions(int repetitions);
+    
+    // Pipelined stages settings (install and test clang and lld as soon
+    // as they are linked, while the rest of the build continues)
+    bool pipelineStages() const;
+    void setPipelineStages(bool enabled);
+    
+    // Source checkout settings (a partial clone of the repository with a
+    // sparse checkout of the directories the build reads)
+    bool sparseCheckout() const;
+    void setSparseCheckout(bool enabled);
+    
+    QString sourceRepository() const;
+    void setSourceRepository(const QString &url);
+    
+    // Source prefetch settings (git fetch in the background so a build
+    // starts with a local fast-forward)
+    bool prefetchSources() const;
+    void setPrefetchSources(bool enabled);
+    
+    int prefetchIntervalMinutes() const;
+    void setPrefetchIntervalMinutes(int minutes);
+    
+    bool warmPageCache() const;
+    void setWarmPageCache(bool enabled);
+    
     // Save/load configuration
     QJsonObject toJson() const;
     void fromJson(const QJsonObject &json);
@@ -170,6 +296,68 @@ private:
     bool m_doTesting;
     bool m_benchmark;
     bool m_botMode;
+    bool m_timeTrace;
+    
+    // Output settings
+    int m_outputUpdateRate;
+    int m_outputMemoryLimit;
+    
+    // Parallelism settings
+    int m_compileJobs;
+    int m_linkJobs;
+    bool m_useJobServer;
+    
+    // Compiler cache settings
+    QString m_compilerCache;
+    QString m_cacheDir;
+    int m_cacheSize;
+    
+    // Build directory pool settings
+    bool m_useBuildDirPool;
+    QString m_buildDirPoolRoot;
+    int m_buildDirPoolBudget;
+    bool m_cleanPooledBuildDir;
+    
+    // Configure seed settings
+    bool m_seedConfigure;
+    
+    // Rebuild forecast settings
+    bool m_forecastRebuild;
+    
+    // Distribution settings
+    bool m_useDistribution;
+    QString m_distributionComponents;
+    bool m_stripDistribution;
+    
+    // PGO pipeline settings
+    bool m_pgoPipeline;
+    QString m_pgoCorpus;
+    QString m_pgoCorpusFlags;
+    
+    // BOLT settings
+    bool m_boltOptimize;
+    QString m_boltProfile;
+    
+    // Compiler A/B benchmark settings
+    bool m_abBenchmark;
+    int m_abBenchmarkRuns;
+    QString m_benchmarkCorpus;
+    QString m_benchmarkCorpusFlags;
+    
+    // Microbenchmark settings
+    int m_benchmarkRepetitions;
+    
+    // Pipelined stages settings
+    bool m_pipelineStages;
+    
+    // Source checkout settings
+    bool m_sparseCheckout;
+    QString m_sourceRepository;
+    
+    // Source prefetch settings
+    bool m_prefetchSources;
+    int m_prefetchIntervalMinutes;
+    bool m_warmPageCache;
 };
 
 #endif // BUILDERCONFIGURATION_H
@@ -395,6 +395,51 @@ fi
 
 MY_COMMONFLAGS_COMC="-fno-stack-protector -fno-common -O"$OPTLEVEL""
 
+    # Size the job pools from the host: compile jobs from online cores,
+    # link jobs from memory and the expected peak of one link.
+    # COMPILE_JOBS and LINK_JOBS in the environment override the result.
+ONLINE_CORES="$(sysctl -n hw.activecpu 2>/dev/null || getconf _NPROCESSORS_ONLN)"
+MEMORY_MB=$(( $(sysctl -n hw.memsize 2>/dev/null || echo 0) / 1048576 ))
+if [ "$NOLTO" -eq 1 ]
+then
+LINK_MB=2048
+elif [ "$FULLLTO" -eq 1 ]
+then
+LINK_MB=12288
+else
+LINK_MB=4096
+fi
+if [ "$USEDYLIB" -eq 1 ]
+then
+LINK_MB=$(( LINK_MB * 2 / 3 ))
+fi
+USABLE_MB=$(( MEMORY_MB * 85 / 100 ))
+if [ -z "$COMPILE_JOBS" ]
+then
+COMPILE_JOBS=$ONLINE_CORES
+if [ "$USABLE_MB" -gt 0 ] && [ $(( USABLE_MB / 1024 )) -lt "$COMPILE_JOBS" ]
+then
+COMPILE_JOBS=$(( USABLE_MB / 1024 ))
+fi
+if [ "$COMPILE_JOBS" -lt 1 ]
+then
+COMPILE_JOBS=1
+fi
+fi
+if [ -z "$LINK_JOBS" ]
+then
+LINK_JOBS=$COMPILE_JOBS
+if [ "$USABLE_MB" -gt 0 ] && [ $(( USABLE_MB / LINK_MB )) -lt "$LINK_JOBS" ]
+then
+LINK_JOBS=$(( USABLE_MB / LINK_MB ))
+fi
+if [ "$LINK_JOBS" -lt 1 ]
+then
+LINK_JOBS=1
+fi
+fi
+echo "Using $COMPILE_JOBS compile jobs and $LINK_JOBS link jobs ($ONLINE_CORES cores, $MEMORY_MB MB)"
+
 
 
     # Start contructing for my local mac builds.
@@ -415,7 +460,7 @@ build_config+=" -DCMAKE_C_FLAGS_RELEASE=\""$MY_COMMONFLAGS_COMC"\" -DCMAKE_CXX_F
 build_config+=" -DLLVM_TARGETS_TO_BUILD=\""$ARCH"\" -DCMAKE_OSX_ARCHITECTURES=\""$OSX_ARCH"\""
 
     # flags for my local mac builds.
- build_config+=" -DLLVM_INSTALL_CCTOOLS_SYMLINKS=\"ON\" -DLLVM_INSTALL_UTILS=\"ON\" -DLIBCLANG_BUILD_STATIC=\"ON\" -DCMAKE_MACOSX_RPATH=\"ON\" -DCLANG_DEFAULT_RTLIB=\"compiler-rt\"  -DCMAKE_CXX_STANDARD=\"20\" -DLLVM_PARALLEL_LINK_JOBS=\"24\" -DLLVM_PARALLEL_COMPILE_JOBS=\"24\" -DDEFAULT_SYSROOT=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk\" -DCLANG_SPAWN_CC1=\"ON\" -DCOMPILER_RT_BUILD_BUILTINS=\"OFF\" -DCOMPILER_RT_USE_BUILTINS_LIBRARY=\"OFF\" -DLLDB_USE_SYSTEM_DEBUGSERVER=\"ON\" -DLLDB_EMBED_PYTHON_HOME=\"OFF\" -DLLDB_ENABLE_LZMA=\"OFF\" -DLLVM_ENABLE_ZSTD=\"OFF\" -DLLDB_ENABLE_CURSES=\"OFF\" -DLLVM_ENABLE_LIBEDIT=\"OFF\" -DLLVM_ENABLE_Z3_SOLVER=\"OFF\""
+ build_config+=" -DLLVM_INSTALL_CCTOOLS_SYMLINKS=\"ON\" -DLLVM_INSTALL_UTILS=\"ON\" -DLIBCLANG_BUILD_STATIC=\"ON\" -DCMAKE_MACOSX_RPATH=\"ON\" -DCLANG_DEFAULT_RTLIB=\"compiler-rt\"  -DCMAKE_CXX_STANDARD=\"20\" -DLLVM_PARALLEL_LINK_JOBS=\""$LINK_JOBS"\" -DLLVM_PARALLEL_COMPILE_JOBS=\""$COMPILE_JOBS"\" -DDEFAULT_SYSROOT=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk\" -DCLANG_SPAWN_CC1=\"ON\" -DCOMPILER_RT_BUILD_BUILTINS=\"OFF\" -DCOMPILER_RT_USE_BUILTINS_LIBRARY=\"OFF\" -DLLDB_USE_SYSTEM_DEBUGSERVER=\"ON\" -DLLDB_EMBED_PYTHON_HOME=\"OFF\" -DLLDB_ENABLE_LZMA=\"OFF\" -DLLVM_ENABLE_ZSTD=\"OFF\" -DLLDB_ENABLE_CURSES=\"OFF\" -DLLVM_ENABLE_LIBEDIT=\"OFF\" -DLLVM_ENABLE_Z3_SOLVER=\"OFF\""
 
     # warnings
 if [ "$NOWARN" -eq 1 ]
@@ -561,9 +606,9 @@ wait
 printf "STARTING COMPILE WITH CLANG IN DIR=$COMPILERPATH\n" >> $TIMER_FILE
 if [ "$USEMAKE" -eq 1 ]
 then
-/usr/bin/time -a -o $TIMER_FILE make -j24 -l24
+/usr/bin/time -a -o $TIMER_FILE make -j"$COMPILE_JOBS" -l"$COMPILE_JOBS"
 else
-/usr/bin/time -a -o $TIMER_FILE ninja -j24
+/usr/bin/time -a -o $TIMER_FILE ninja -j"$COMPILE_JOBS"
 fi
 wait
 printf "DONE\n" >> $TIMER_FILE
@@ -575,16 +620,16 @@ if [ "$USEMAKE" -eq 1 ]
 then
 if [ "$SUDODOINSTALL" -eq 1 ]
 then
-sudo make install -j24 -l24
+sudo make install -j"$COMPILE_JOBS" -l"$COMPILE_JOBS"
 else
-make install -j24 -l24
+make install -j"$COMPILE_JOBS" -l"$COMPILE_JOBS"
 fi
 else
 if [ "$SUDODOINSTALL" -eq 1 ]
 then
-sudo ninja install -j24 -l24
+sudo ninja install -j"$COMPILE_JOBS" -l"$COMPILE_JOBS"
 else
-ninja install -j24 -l24
+ninja install -j"$COMPILE_JOBS" -l"$COMPILE_JOBS"
 fi
 
 fi
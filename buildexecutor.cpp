@@ -1,16 +1,79 @@
 #include "buildexecutor.h"
-#include "builderconfiguration.h"
 #include "commandgenerator.h"
+#include "resourceplanner.h"
+#include "compilercache.h"
+#include "builddirpool.h"
+#include "configureseed.h"
+#include "rebuildforecast.h"
+#include "distributionplanner.h"
+#include "pgopipeline.h"
+#include "boltstage.h"
 
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
+#include <QDateTime>
+#include <QThread>
+
+namespace {
+
+// How often a build is resumed after running out of memory
+const int MaxOutOfMemoryRetries = 3;
+
+// Error output of a compiler or linker that was killed or could not allocate
+const char *const OutOfMemoryPatterns[] = {
+    "Killed: 9",
+    "unable to execute command: Killed",
+    "signal 9",
+    "SIGKILL",
+    "Cannot allocate memory",
+    "out of memory",
+    "Out of memory",
+    "std::bad_alloc",
+};
+
+} // namespace
 
 BuildExecutor::BuildExecutor(QObject *parent)
     : QObject(parent)
     , m_process(new QProcess(this))
     , m_scriptFile(nullptr)
+    , m_running(false)
+    , m_flushTimer(new QTimer(this))
+    , m_flushInterval(100)
+    , m_killTimer(new QTimer(this))
+    , m_stagePrefix(CommandGenerator::stagePrefix().toUtf8())
+    , m_jobServer(new JobServer(this))
+    , m_retryCount(0)
+    , m_retryJobs(1)
+    , m_cancelled(false)
+    , m_benchmarkThread(nullptr)
+    , m_benchmarkCancelled(false)
 {
+    // Batches cross to the UI thread through queued connections
+    qRegisterMetaType<LogBatch>("LogBatch");
+    qRegisterMetaType<BuildProgress>("BuildProgress");
+
+    // Output is coalesced and delivered at most once per timer interval
+    m_flushTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &BuildExecutor::flushOutput);
+
+    // Give a cancelled process five seconds to exit before killing it
+    m_killTimer->setSingleShot(true);
+    m_killTimer->setInterval(5000);
+    connect(m_killTimer, &QTimer::timeout, this, [this]() {
+        if (m_process->state() != QProcess::NotRunning) {
+            appendOutput("Process did not terminate gracefully, killing...\n");
+            m_process->kill();
+        }
+    });
+
+    // Token adjustments show up in the build log
+    connect(m_jobServer, &JobServer::message, this, [this](const QString &text) {
+        appendOutput(text.toUtf8() + "\n");
+    });
+
     // Connect process signals
     connect(m_process, &QProcess::readyReadStandardOutput, this, &BuildExecutor::handleProcessOutput);
     connect(m_process, &QProcess::readyReadStandardError, this, &BuildExecutor::handleProcessOutput);
@@ -21,6 +84,11 @@ BuildExecutor::BuildExecutor(QObject *parent)
 
 BuildExecutor::~BuildExecutor()
 {
+    if (m_benchmarkThread) {
+        m_benchmarkCancelled = true;
+        m_benchmarkThread->wait();
+    }
+    
     if (m_process->state() != QProcess::NotRunning) {
         m_process->terminate();
         m_process->waitForFinished(3000);
@@ -32,21 +100,105 @@ BuildExecutor::~BuildExecutor()
     delete m_scriptFile;
 }
 
-void BuildExecutor::executeBuild(const BuilderConfiguration &config)
+void BuildExecutor::executeBuild(const BuilderConfiguration &config, const ResourcePlan &plan)
+{
+    // Run on the executor's thread with a copy of the configuration
+    QMetaObject::invokeMethod(this, [this, config, plan]() { startBuild(config, plan); }, Qt::QueuedConnection);
+}
+
+void BuildExecutor::executeCommand(const QString &command)
+{
+    QMetaObject::invokeMethod(this, [this, command]() { startCommand(command); }, Qt::QueuedConnection);
+}
+
+void BuildExecutor::cancelBuild()
+{
+    QMetaObject::invokeMethod(this, [this]() { stopProcess(); }, Qt::QueuedConnection);
+}
+
+bool BuildExecutor::isRunning() const
+{
+    return m_running;
+}
+
+void BuildExecutor::setOutputUpdateRate(int updatesPerSecond)
+{
+    if (updatesPerSecond < 1) {
+        updatesPerSecond = 1;
+    }
+    m_flushInterval = 1000 / updatesPerSecond;
+}
+
+void BuildExecutor::startBuild(const BuilderConfiguration &requestedConfig, const ResourcePlan &plan)
 {
     if (m_process->state() != QProcess::NotRunning) {
-        emit outputAvailable("Error: A build process is already running.\n");
+        appendOutput("Error: A build process is already running.\n");
         return;
     }
     
-    // Generate the build command
-    CommandGenerator generator(config);
-    QString command = generator.generateBuildCommand();
+    // Each configuration gets its own directory when the pool is enabled
+    BuilderConfiguration config = requestedConfig;
+    m_poolHash.clear();
+    if (config.useBuildDirPool()) {
+        usePooledBuildDir(config);
+    }
+    
+    // Apply the configured output update rate
+    setOutputUpdateRate(config.outputUpdateRate());
+    
+    // make before 4.4 rejects a FIFO jobserver and ninja before 1.13 ignores
+    // it; keep the planned -j for those
+    if (config.useJobServer()) {
+        QString version;
+        if (!JobServer::clientSupported(config.useMake(), &version)) {
+            QString tool = config.useMake() ? "make" : "ninja";
+            appendOutput(QString("Warning: %1 %2 can't use the jobserver (%3 or later needed); building with -j%4 instead.\n")
+                             .arg(tool, version.isEmpty() ? "(version unknown)" : version,
+                                  config.useMake() ? "4.4" : "1.13")
+                             .arg(plan.compileJobs)
+                             .toUtf8());
+            config.setUseJobServer(false);
+        }
+    }
+    
+    // Predict the incremental rebuild; a PGO pipeline's stages are stamped instead
+    if (config.forecastRebuild() && !config.cleanBuildDir() && !config.useMake() && !config.pgoPipeline()) {
+        forecastRebuild(config, plan);
+    }
+    
+    // The final stage of a PGO pipeline is configured like a plain build
+    PgoPipeline pipeline(config, plan);
+    const BuilderConfiguration &stageConfig = config.pgoPipeline() ? pipeline.finalConfig() : config;
+    CommandGenerator stageGenerator(stageConfig, plan);
+    if (config.pgoPipeline()) {
+        stageGenerator.setExtraDefines(pipeline.finalDefines());
+    }
+    m_configureDir = stageConfig.buildDir();
+    
+    // Show how much of the tree a distribution build leaves out
+    if (config.useDistribution() && !config.useMake()) {
+        DistributionEstimate estimate =
+            DistributionPlanner::estimate(m_configureDir, DistributionPlanner::components(config));
+        appendOutput(estimate.summary().toUtf8() + ".\n");
+    }
+    
+    // The configure step and the staged CMake state live in the build directory
+    QDir buildDir(config.buildDir());
+    if (!buildDir.exists()) {
+        buildDir.mkpath(".");
+    }
+    QDir().mkpath(m_configureDir);
+    
+    // Generate the build command, configuring only what changed
+    m_configure = planConfigure(stageConfig, stageGenerator);
+    CommandGenerator generator(config, plan);
+    QString command = generator.generateBuildCommand(m_configure);
     
     // Create a temporary script file
     QString scriptPath = createScriptFile(command);
     if (scriptPath.isEmpty()) {
-        emit outputAvailable("Error: Failed to create temporary script file.\n");
+        appendOutput("Error: Failed to create temporary script file.\n");
+        flushAllOutput();
         emit buildFinished(false, "Failed to create temporary script file");
         return;
     }
@@ -55,37 +207,69 @@ void BuildExecutor::executeBuild(const BuilderConfiguration &config)
     QProcess chmodProcess;
     chmodProcess.start("chmod", QStringList() << "+x" << scriptPath);
     if (!chmodProcess.waitForFinished(3000)) {
-        emit outputAvailable("Error: Failed to make script executable.\n");
+        appendOutput("Error: Failed to make script executable.\n");
+        flushAllOutput();
         emit buildFinished(false, "Failed to make script executable");
         return;
     }
     
     // Start the build process
     emit buildStarted();
-    emit outputAvailable("Starting build process...\n");
+    appendOutput("Starting build process...\n");
     
     // Set working directory to the build directory
-    QDir buildDir(config.buildDir());
-    if (!buildDir.exists()) {
-        buildDir.mkpath(".");
-    }
     m_process->setWorkingDirectory(config.buildDir());
     
+    // Ask ninja for machine-readable status lines and load the previous
+    // build's timings before a clean build removes them
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("NINJA_STATUS", NinjaProgressTracker::statusFormat());
+    
+    // Let make/ninja draw job tokens from our jobserver instead of a fixed -j
+    if (config.useJobServer()) {
+        if (m_jobServer->start(plan.compileJobs, plan.memoryPerLinkMB)) {
+            environment.insert("MAKEFLAGS", m_jobServer->makeFlags());
+            appendOutput("Jobserver started with " + QByteArray::number(plan.compileJobs) + " jobs.\n");
+        } else {
+            appendOutput("Warning: Failed to create the jobserver FIFO; falling back to ninja's default parallelism.\n");
+        }
+    }
+    m_process->setProcessEnvironment(environment);
+    m_progressTracker.reset(m_configureDir);
+    
+    // Start a fresh timing report for this build
+    m_report.clear();
+    m_reportPath = BuildReport::defaultPath(config.buildDir());
+    
+    // Counters from an earlier build must not be mistaken for this one's
+    QFile::remove(CompilerCache::statsPath(m_configureDir));
+    
+    // Nothing has run out of memory yet
+    m_config = config;
+    m_plan = plan;
+    m_failedTarget.clear();
+    m_outOfMemoryTargets.clear();
+    m_retryCount = 0;
+    m_retryJobs = plan.compileJobs;
+    m_cancelled = false;
+    
     // Start the process
+    m_running = true;
     m_process->start(scriptPath);
 }
 
-void BuildExecutor::executeCommand(const QString &command)
+void BuildExecutor::startCommand(const QString &command)
 {
     if (m_process->state() != QProcess::NotRunning) {
-        emit outputAvailable("Error: A process is already running.\n");
+        appendOutput("Error: A process is already running.\n");
         return;
     }
     
     // Create a temporary script file
     QString scriptPath = createScriptFile(command);
     if (scriptPath.isEmpty()) {
-        emit outputAvailable("Error: Failed to create temporary script file.\n");
+        appendOutput("Error: Failed to create temporary script file.\n");
+        flushAllOutput();
         emit buildFinished(false, "Failed to create temporary script file");
         return;
     }
@@ -94,51 +278,201 @@ void BuildExecutor::executeCommand(const QString &command)
     QProcess chmodProcess;
     chmodProcess.start("chmod", QStringList() << "+x" << scriptPath);
     if (!chmodProcess.waitForFinished(3000)) {
-        emit outputAvailable("Error: Failed to make script executable.\n");
+        appendOutput("Error: Failed to make script executable.\n");
+        flushAllOutput();
         emit buildFinished(false, "Failed to make script executable");
         return;
     }
     
-    // Start the process
+    // Start the process; custom commands do not produce a build report,
+    // are never resumed and do not touch the build directory pool. Nothing
+    // of an earlier build may leak into how this one is reported.
+    m_report.clear();
+    m_reportPath.clear();
+    m_poolHash.clear();
+    m_failedTarget.clear();
+    m_outOfMemoryTargets.clear();
+    m_retryCount = 0;
+    m_cancelled = false;
     emit buildStarted();
-    emit outputAvailable("Executing command...\n");
+    appendOutput("Executing command...\n");
+    m_running = true;
     m_process->start(scriptPath);
 }
 
-void BuildExecutor::cancelBuild()
+void BuildExecutor::stopProcess()
 {
+    // Benchmarks stop after the compile or benchmark binary in flight
+    if (m_benchmarkThread) {
+        m_benchmarkCancelled = true;
+        m_cancelled = true;
+        appendOutput("Cancelling benchmarks...\n");
+        return;
+    }
+    
     if (m_process->state() == QProcess::NotRunning) {
         return;
     }
     
-    emit outputAvailable("Cancelling build process...\n");
+    m_cancelled = true;
+    appendOutput("Cancelling build process...\n");
     m_process->terminate();
     
-    // Wait for the process to terminate
-    if (!m_process->waitForFinished(5000)) {
-        emit outputAvailable("Process did not terminate gracefully, killing...\n");
-        m_process->kill();
+    // Escalate to kill if the process is still around after the grace period
+    m_killTimer->start();
+}
+
+void BuildExecutor::handleProcessOutput()
+{
+    // Buffer standard output and standard error; they are delivered on the next flush
+    appendOutput(m_process->readAllStandardOutput());
+    appendOutput(m_process->readAllStandardError());
+}
+
+void BuildExecutor::appendOutput(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    
+    // Split into complete lines here so the UI thread never scans raw output
+    int start = 0;
+    int newline = data.indexOf('\n');
+    while (newline >= 0) {
+        if (m_partialLine.isEmpty()) {
+            appendLine(data.constData() + start, newline - start);
+        } else {
+            m_partialLine.append(data.constData() + start, newline - start);
+            appendLine(m_partialLine.constData(), m_partialLine.size());
+            m_partialLine.clear();
+        }
+        start = newline + 1;
+        newline = data.indexOf('\n', start);
+    }
+    m_partialLine.append(data.constData() + start, data.size() - start);
+    
+    // Deliver an overlong line rather than buffering it indefinitely
+    if (m_partialLine.size() >= 64 * 1024) {
+        appendLine(m_partialLine.constData(), m_partialLine.size());
+        m_partialLine.clear();
+    }
+    
+    // The first line after a flush arms the timer; later lines ride along
+    if (!m_pendingLines.isEmpty() && !m_flushTimer->isActive()) {
+        m_flushTimer->start(m_flushInterval);
     }
 }
 
-bool BuildExecutor::isRunning() const
+void BuildExecutor::appendLine(const char *line, int length)
 {
-    return m_process->state() != QProcess::NotRunning;
+    // Stage markers from the build script are timestamped as they arrive
+    if (length > m_stagePrefix.size() && qstrncmp(line, m_stagePrefix.constData(), m_stagePrefix.size()) == 0) {
+        QString stage = QString::fromUtf8(line + m_stagePrefix.size(), length - m_stagePrefix.size());
+        m_report.beginStage(stage.trimmed(), QDateTime::currentMSecsSinceEpoch());
+    }
+    
+    scanForOutOfMemory(line, length);
+    m_progressTracker.processLine(line, length);
+    m_pendingLines.appendLine(line, length);
 }
 
-void BuildExecutor::handleProcessOutput()
+void BuildExecutor::scanForOutOfMemory(const char *line, int length)
+{
+    QByteArray text = QByteArray::fromRawData(line, length);
+    
+    // "FAILED: [code=N] <outputs>" opens the error output of an edge
+    if (text.startsWith("FAILED: ")) {
+        QByteArray outputs = text.mid(8).trimmed();
+        if (outputs.startsWith("[code=")) {
+            outputs = outputs.mid(outputs.indexOf(']') + 1).trimmed();
+        }
+        m_failedTarget = outputs.left(outputs.indexOf(' ') >= 0 ? outputs.indexOf(' ') : outputs.size());
+        return;
+    }
+    
+    // The next status line or ninja's own summary closes it
+    if (text.startsWith("[ninja ") || text.startsWith("ninja: ")) {
+        m_failedTarget.clear();
+        return;
+    }
+    
+    if (m_failedTarget.isEmpty()) {
+        return;
+    }
+    for (const char *pattern : OutOfMemoryPatterns) {
+        if (text.contains(pattern)) {
+            QString target = QString::fromUtf8(m_failedTarget);
+            if (!m_outOfMemoryTargets.contains(target)) {
+                m_outOfMemoryTargets.append(target);
+            }
+            m_failedTarget.clear();
+            return;
+        }
+    }
+}
+
+bool BuildExecutor::resumeAfterOutOfMemory()
 {
-    // Read standard output
-    QByteArray stdoutData = m_process->readAllStandardOutput();
-    if (!stdoutData.isEmpty()) {
-        emit outputAvailable(QString::fromUtf8(stdoutData));
+    // Only full ninja builds can be resumed; make output is not parsed, and
+    // a PGO pipeline reruns from its stamps instead
+    if (m_reportPath.isEmpty() || m_config.useMake() || m_config.pgoPipeline() ||
+        m_retryCount >= MaxOutOfMemoryRetries) {
+        return false;
     }
     
-    // Read standard error
-    QByteArray stderrData = m_process->readAllStandardError();
-    if (!stderrData.isEmpty()) {
-        emit outputAvailable(QString::fromUtf8(stderrData));
+    ++m_retryCount;
+    m_retryJobs = qMax(1, m_retryJobs / 2);
+    
+    BuildRetry retry;
+    retry.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    retry.jobs = m_retryJobs;
+    retry.targets = m_outOfMemoryTargets;
+    m_report.addRetry(retry);
+    m_report.saveToFile(m_reportPath);
+    
+    appendOutput(QString("Out of memory in %1; resuming with -j%2 for those targets (retry %3 of %4).\n")
+                     .arg(m_outOfMemoryTargets.join(", "))
+                     .arg(m_retryJobs)
+                     .arg(m_retryCount)
+                     .arg(MaxOutOfMemoryRetries)
+                     .toUtf8());
+    
+    // Same build directory, no pull, clean or configure
+    CommandGenerator generator(m_config, m_plan);
+    QString scriptPath = createScriptFile(generator.generateResumeCommand(m_outOfMemoryTargets, m_retryJobs));
+    m_outOfMemoryTargets.clear();
+    m_failedTarget.clear();
+    if (scriptPath.isEmpty()) {
+        appendOutput("Error: Failed to create the resume script.\n");
+        return false;
+    }
+    
+    m_process->start("/bin/bash", QStringList() << scriptPath);
+    return true;
+}
+
+void BuildExecutor::flushOutput()
+{
+    if (m_progressTracker.hasUpdate()) {
+        emit progressChanged(m_progressTracker.progress());
+    }
+    
+    if (m_pendingLines.isEmpty()) {
+        return;
+    }
+    
+    emit outputAvailable(m_pendingLines);
+    m_pendingLines.clear();
+}
+
+void BuildExecutor::flushAllOutput()
+{
+    m_flushTimer->stop();
+    if (!m_partialLine.isEmpty()) {
+        appendLine(m_partialLine.constData(), m_partialLine.size());
+        m_partialLine.clear();
     }
+    flushOutput();
 }
 
 void BuildExecutor::handleProcessError(QProcess::ProcessError error)
@@ -167,20 +501,394 @@ void BuildExecutor::handleProcessError(QProcess::ProcessError error)
         break;
     }
     
-    emit outputAvailable("Error: " + errorMessage + "\n");
+    appendOutput("Error: " + errorMessage.toUtf8() + "\n");
+    flushAllOutput();
+    if (error == QProcess::FailedToStart) {
+        m_running = false;
+        m_jobServer->stop();
+    }
     emit buildFinished(false, errorMessage);
 }
 
 void BuildExecutor::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-        emit outputAvailable("Process completed successfully.\n");
+    // Pick up anything written after the last readyRead
+    handleProcessOutput();
+    m_killTimer->stop();
+    
+    // Edges killed for lack of memory are retried in place with fewer jobs
+    flushAllOutput();
+    if (!m_cancelled && !m_outOfMemoryTargets.isEmpty() && resumeAfterOutOfMemory()) {
+        return;
+    }
+    
+    m_jobServer->stop();
+    
+    // Edges still killed after the last retry fail the build even if the
+    // script carried on
+    bool success = exitStatus == QProcess::NormalExit && exitCode == 0 && m_outOfMemoryTargets.isEmpty();
+    
+    // Benchmarks run before the build counts as finished
+    if (success && !m_cancelled && !m_reportPath.isEmpty() && (m_config.abBenchmark() || m_config.benchmark())) {
+        startBenchmarks();
+        return;
+    }
+    finishBuild(success, exitCode);
+}
+
+void BuildExecutor::finishBuild(bool success, int exitCode)
+{
+    m_running = false;
+    
+    // Close and save the timing report
+    m_report.finish(QDateTime::currentMSecsSinceEpoch(), success);
+    if (!m_reportPath.isEmpty() && CompilerCache::isEnabled(m_config)) {
+        recordCacheStats();
+    }
+    if (!m_reportPath.isEmpty() && m_config.boltOptimize()) {
+        BoltThroughput throughput = BoltStage::throughput(m_report);
+        if (throughput.isValid()) {
+            appendOutput(throughput.summary().toUtf8() + ".\n");
+        }
+    }
+    if (!m_reportPath.isEmpty() && m_configure.mode != ConfigurePlan::Skip && configureApplied()) {
+        recordConfigureTime();
+        if (m_config.seedConfigure()) {
+            harvestConfigureSeed();
+        }
+    }
+    if (!m_reportPath.isEmpty()) {
+        m_report.saveToFile(m_reportPath);
+    }
+    
+    if (success && m_retryCount > 0) {
+        QString message = QString("Build completed after %1 out-of-memory retries").arg(m_retryCount);
+        appendOutput(message.toUtf8() + ".\n");
+        flushAllOutput();
+        emit buildFinished(true, message);
+    } else if (success) {
+        appendOutput("Process completed successfully.\n");
+        flushAllOutput();
         emit buildFinished(true, "Process completed successfully");
     } else {
         QString message = "Process failed with exit code " + QString::number(exitCode);
-        emit outputAvailable(message + "\n");
+        if (m_cancelled) {
+            message = "Cancelled";
+        } else if (!m_outOfMemoryTargets.isEmpty()) {
+            message = "Out of memory in " + m_outOfMemoryTargets.join(", ");
+        }
+        appendOutput(message.toUtf8() + "\n");
+        flushAllOutput();
         emit buildFinished(false, message);
     }
+    
+    // Measured after reporting, as walking a full LLVM build tree takes a moment
+    if (!m_poolHash.isEmpty() && !m_reportPath.isEmpty()) {
+        updateBuildDirPool();
+    }
+}
+
+void BuildExecutor::startBenchmarks()
+{
+    m_report.beginStage("benchmark", QDateTime::currentMSecsSinceEpoch());
+    flushAllOutput();
+    
+    // The compilers and benchmarks are whatever the final stage's directory holds
+    BuilderConfiguration config = m_config;
+    config.setBuildDir(m_configureDir);
+    
+    // Benchmarks take minutes; they run on their own thread so a cancel
+    // still gets through, and report back through queued calls
+    m_benchmarkCancelled = false;
+    m_benchmarkThread = QThread::create([this, config]() {
+        auto progress = [this](const QString &line) {
+            QMetaObject::invokeMethod(this, [this, line]() { appendOutput(line.toUtf8() + "\n"); },
+                                      Qt::QueuedConnection);
+        };
+        
+        if (config.abBenchmark()) {
+            progress("Benchmarking the new compiler against " + config.compilerPath() + "...");
+            BenchmarkResult result = CompilerBenchmark(config).run(m_benchmarkCancelled, progress);
+            QMetaObject::invokeMethod(this, [this, result]() { reportCompilerBenchmark(result); },
+                                      Qt::QueuedConnection);
+        }
+        
+        if (config.benchmark() && !m_benchmarkCancelled) {
+            MicrobenchmarkRun run;
+            QString error;
+            if (!MicrobenchmarkRunner(config).run(m_benchmarkCancelled, progress, run, error)) {
+                run.samples.clear();
+                progress("Warning: " + error + "; no microbenchmark results recorded.");
+            }
+            QMetaObject::invokeMethod(this, [this, run]() { reportMicrobenchmarks(run); }, Qt::QueuedConnection);
+        }
+        
+        // A cancelled benchmark leaves the build unfinished
+        QMetaObject::invokeMethod(this, [this]() {
+            m_benchmarkThread = nullptr;
+            finishBuild(!m_benchmarkCancelled, 0);
+        }, Qt::QueuedConnection);
+    });
+    connect(m_benchmarkThread, &QThread::finished, m_benchmarkThread, &QObject::deleteLater);
+    m_benchmarkThread->start();
+}
+
+void BuildExecutor::reportCompilerBenchmark(const BenchmarkResult &result)
+{
+    // A benchmark that could not complete does not fail the build
+    if (!result.error.isEmpty()) {
+        appendOutput("Warning: " + result.error.toUtf8() + "; no benchmark results recorded.\n");
+        return;
+    }
+    
+    appendOutput(QString("Compiled %1 files %2 times with each compiler%3:\n")
+                     .arg(result.corpus.size())
+                     .arg(result.baseline.size())
+                     .arg(result.cpu >= 0 ? QString(" on CPU %1").arg(result.cpu) : QString())
+                     .toUtf8());
+    for (const BenchmarkComparison &comparison : result.comparisons()) {
+        appendOutput("  " + comparison.summary().toUtf8() + "\n");
+    }
+    if (result.saveToHistory()) {
+        appendOutput("Benchmark results saved to " + CompilerBenchmark::historyPath(result.revision).toUtf8() + "\n");
+    }
+}
+
+void BuildExecutor::reportMicrobenchmarks(MicrobenchmarkRun run)
+{
+    if (run.samples.isEmpty()) {
+        return;
+    }
+    
+    QFile revisionFile(RebuildForecaster::revisionPath(m_configureDir));
+    if (revisionFile.open(QIODevice::ReadOnly)) {
+        run.revision = QString::fromLatin1(revisionFile.readAll().trimmed());
+    }
+    run.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    
+    // Compared with the previous build of the same configuration
+    MicrobenchmarkHistory history(BuildDirPool::configHash(m_config));
+    if (!history.load()) {
+        appendOutput("Warning: The microbenchmark history is unreadable; starting a new one.\n");
+    }
+    MicrobenchmarkRun previous = history.latest();
+    
+    if (previous.samples.isEmpty()) {
+        appendOutput(QString("Recorded %1 microbenchmarks; later builds of this configuration are compared with them.\n")
+                         .arg(run.samples.size())
+                         .toUtf8());
+    } else {
+        const QVector<MicrobenchmarkChange> regressions = MicrobenchmarkHistory::regressions(previous, run);
+        const QVector<MicrobenchmarkChange> improvements = MicrobenchmarkHistory::improvements(previous, run);
+        appendOutput(QString("%1 microbenchmarks against revision %2: %3 significantly slower, %4 faster.\n")
+                         .arg(run.samples.size())
+                         .arg(previous.revision.left(12))
+                         .arg(regressions.size())
+                         .arg(improvements.size())
+                         .toUtf8());
+        for (const MicrobenchmarkChange &change : regressions) {
+            appendOutput("  Regression: " + change.summary().toUtf8() + "\n");
+        }
+    }
+    
+    history.append(run);
+    if (!history.save()) {
+        appendOutput("Warning: Failed to save the microbenchmark history to " + history.filePath().toUtf8() + "\n");
+    }
+}
+
+void BuildExecutor::usePooledBuildDir(BuilderConfiguration &config)
+{
+    BuildDirPool pool(config.buildDirPoolRoot());
+    if (!pool.load()) {
+        appendOutput("Warning: The build directory pool index is unreadable; starting a new one.\n");
+    }
+    
+    m_poolHash = BuildDirPool::configHash(config);
+    bool reused = QDir(pool.directory(m_poolHash)).exists();
+    config.setBuildDir(pool.acquire(config));
+    
+    // A directory of the same configuration only needs an incremental build,
+    // unless the clean is asked for pooled directories too
+    if (reused && config.cleanBuildDir()) {
+        if (config.cleanPooledBuildDir()) {
+            appendOutput("Cleaning the reused pooled build directory as configured.\n");
+        } else {
+            appendOutput("Skipping the clean: the pooled build directory of this configuration is reused "
+                         "incrementally. Enable Clean Reused Directories to force one.\n");
+            config.setCleanBuildDir(false);
+        }
+    }
+    
+    qint64 budget = qint64(config.buildDirPoolBudget()) * 1024 * 1024 * 1024;
+    const QStringList evicted = pool.evict(budget, m_poolHash);
+    for (const QString &directory : evicted) {
+        appendOutput("Evicted least recently used build directory " + directory.toUtf8() + "\n");
+    }
+    pool.save();
+    
+    appendOutput(QString("%1 pooled build directory %2 (%3)\n")
+                     .arg(reused ? "Reusing" : "Created")
+                     .arg(config.buildDir())
+                     .arg(BuildDirPool::describe(config))
+                     .toUtf8());
+}
+
+void BuildExecutor::updateBuildDirPool()
+{
+    BuildDirPool pool(m_config.buildDirPoolRoot());
+    pool.load();
+    pool.refreshSize(m_poolHash);
+    pool.evict(qint64(m_config.buildDirPoolBudget()) * 1024 * 1024 * 1024, m_poolHash);
+    pool.save();
+}
+
+void BuildExecutor::forecastRebuild(const BuilderConfiguration &config, const ResourcePlan &plan)
+{
+    RebuildForecast forecast = RebuildForecaster::forecast(config, plan.compileJobs);
+    appendOutput(forecast.summary().toUtf8() + ".\n");
+}
+
+ConfigurePlan BuildExecutor::planConfigure(const BuilderConfiguration &config, const CommandGenerator &generator)
+{
+    ConfigurePlan configure;
+    m_toolchainKey.clear();
+    if (config.dryRun()) {
+        return configure;
+    }
+    
+    CMakeState current = CMakeState::fromGenerator(generator);
+    m_cmakeDigest = current.digest();
+    
+    // Without a cache there is nothing to keep
+    CMakeState previous;
+    if (config.cleanBuildDir()) {
+        configure.reason = "clean build";
+    } else if (!QFile::exists(QDir(config.buildDir()).filePath("CMakeCache.txt"))) {
+        configure.reason = "no CMakeCache.txt";
+    } else if (!previous.loadFromFile(CMakeState::defaultPath(config.buildDir()))) {
+        configure.reason = "no record of an earlier configure";
+    } else {
+        configure = current.planFrom(previous);
+    }
+    
+    auto seconds = [](qint64 ms) { return QString::number(ms / 1000.0, 'f', 1); };
+    if (configure.mode == ConfigurePlan::Skip) {
+        QString saved = configure.lastConfigureMs > 0
+                            ? "saves about " + seconds(configure.lastConfigureMs) + " s"
+                            : "time of a full configure saved";
+        appendOutput(QString("Skipping CMake configure: %1; %2.\n").arg(configure.reason).arg(saved).toUtf8());
+        
+        // The pools ninja uses are the ones the last configure wrote, not this plan's
+        QHash<QString, QString> pools =
+            CMakeState::cacheValues(QDir(config.buildDir()).filePath("CMakeCache.txt"),
+                                    QStringList() << "LLVM_PARALLEL_COMPILE_JOBS" << "LLVM_PARALLEL_LINK_JOBS");
+        if (!pools.isEmpty()) {
+            appendOutput(QString("Job pools in effect from CMakeCache.txt: %1 compile, %2 link.\n")
+                             .arg(pools.value("LLVM_PARALLEL_COMPILE_JOBS", "unset"))
+                             .arg(pools.value("LLVM_PARALLEL_LINK_JOBS", "unset"))
+                             .toUtf8());
+        }
+        return configure;
+    }
+    
+    // The script moves the staged state into place once CMake succeeds
+    current.setConfigureMs(configure.lastConfigureMs);
+    configure.recordState = current.saveToFile(CMakeState::pendingPath(config.buildDir()));
+    if (configure.mode == ConfigurePlan::Changed) {
+        appendOutput(QString("Reconfiguring with only the changed CMake arguments: %1.\n").arg(configure.reason).toUtf8());
+    } else {
+        appendOutput(QString("Running a full CMake configure: %1.\n").arg(configure.reason).toUtf8());
+    }
+    
+    // An empty build directory can start from the probe results of an
+    // earlier configure with the same toolchain; hashing the compiler
+    // takes a moment, so only configures that run pay for it
+    if (config.seedConfigure()) {
+        m_toolchainKey = ConfigureSeed::toolchainKey(generator);
+    }
+    bool empty = config.cleanBuildDir() || !QFile::exists(QDir(config.buildDir()).filePath("CMakeCache.txt"));
+    if (configure.mode == ConfigurePlan::Full && empty && !m_toolchainKey.isEmpty()) {
+        QString seedFile = ConfigureSeed::seedPath(m_toolchainKey);
+        int entries = ConfigureSeed::entryCount(seedFile);
+        if (entries > 0) {
+            configure.seedFile = seedFile;
+            appendOutput(QString("Seeding the configure with %1 check results from %2.\n")
+                             .arg(entries)
+                             .arg(seedFile)
+                             .toUtf8());
+        }
+    }
+    return configure;
+}
+
+bool BuildExecutor::configureApplied() const
+{
+    // Only a configure CMake accepted has put its state in place
+    CMakeState state;
+    return state.loadFromFile(CMakeState::defaultPath(m_configureDir)) && state.digest() == m_cmakeDigest;
+}
+
+void BuildExecutor::recordConfigureTime()
+{
+    qint64 duration = 0;
+    const QVector<BuildStage> stages = m_report.stages();
+    for (const BuildStage &stage : stages) {
+        if (stage.name == "configure" && stage.endMs > stage.startMs) {
+            duration = stage.endMs - stage.startMs;
+        }
+    }
+    
+    QString statePath = CMakeState::defaultPath(m_configureDir);
+    CMakeState state;
+    if (duration == 0 || !state.loadFromFile(statePath)) {
+        return;
+    }
+    
+    if (m_configure.mode == ConfigurePlan::Full) {
+        state.setConfigureMs(duration);
+        state.saveToFile(statePath);
+    } else if (state.configureMs() > 0) {
+        appendOutput(QString("Partial reconfigure took %1 s against %2 s for the last full configure.\n")
+                         .arg(duration / 1000.0, 0, 'f', 1)
+                         .arg(state.configureMs() / 1000.0, 0, 'f', 1)
+                         .toUtf8());
+    }
+}
+
+void BuildExecutor::harvestConfigureSeed()
+{
+    if (m_toolchainKey.isEmpty()) {
+        return;
+    }
+    
+    QString seedFile = ConfigureSeed::seedPath(m_toolchainKey);
+    int entries = ConfigureSeed::harvest(QDir(m_configureDir).filePath("CMakeCache.txt"), seedFile,
+                                         m_config.compilerPath() + " (" + m_config.osxArch() + ")");
+    if (entries > 0) {
+        appendOutput(QString("Saved %1 configure check results to %2.\n").arg(entries).arg(seedFile).toUtf8());
+    }
+}
+
+void BuildExecutor::recordCacheStats()
+{
+    QFile file(CompilerCache::statsPath(m_configureDir));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    CacheStats stats = CompilerCache::parseStats(m_config.compilerCache(), file.readAll());
+    if (stats.tool.isEmpty()) {
+        return;
+    }
+    m_report.setCacheStats(stats);
+    appendOutput(QString("Compiler cache (%1): %2 hits, %3 misses, %4 uncacheable, %5% hit rate.\n")
+                     .arg(stats.tool)
+                     .arg(stats.hits)
+                     .arg(stats.misses)
+                     .arg(stats.uncacheable)
+                     .arg(stats.hitRate(), 0, 'f', 1)
+                     .toUtf8());
 }
 
 QString BuildExecutor::createScriptFile(const QString &content)
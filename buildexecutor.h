@@ -1,14 +1,34 @@
 #ifndef BUILDEXECUTOR_H
 #define BUILDEXECUTOR_H
 
+#include "logbatch.h"
+#include "buildprogress.h"
+#include "ninjaprogresstracker.h"
+#include "buildreport.h"
+#include "jobserver.h"
+#include "builderconfiguration.h"
+#include "resourceplanner.h"
+#include "cmakestate.h"
+#include "compilerbenchmark.h"
+#include "microbenchmarks.h"
+
 #include <QObject>
 #include <QProcess>
 #include <QString>
 #include <QTemporaryFile>
+#include <QTimer>
+#include <QByteArray>
+#include <QStringList>
+
+#include <atomic>
 
-class BuilderConfiguration;
 class CommandGenerator;
+class QThread;
 
+// Runs builds in a QProcess. The executor is meant to live on a worker
+// thread: the public methods below may be called from any thread and are
+// forwarded to the executor's own thread, and all results are delivered
+// through signals.
 class BuildExecutor : public QObject
 {
     Q_OBJECT
@@ -17,21 +37,27 @@ public:
     explicit BuildExecutor(QObject *parent = nullptr);
     ~BuildExecutor();
     
-    // Execute the build command
-    void executeBuild(const BuilderConfiguration &config);
+    // Execute the build command with the job counts the user confirmed
+    void executeBuild(const BuilderConfiguration &config, const ResourcePlan &plan);
     
     // Execute a custom command
     void executeCommand(const QString &command);
     
-    // Cancel the current build
+    // Cancel the current build (does not block)
     void cancelBuild();
     
-    // Check if a build is currently running
+    // Check if a build is currently running (does not block)
     bool isRunning() const;
     
+    // Limit how often buffered output is delivered (updates per second)
+    void setOutputUpdateRate(int updatesPerSecond);
+    
 signals:
-    // Signal emitted when output is available
-    void outputAvailable(const QString &output);
+    // Signal emitted when a batch of complete output lines is available
+    void outputAvailable(const LogBatch &batch);
+    
+    // Signal emitted when ninja reports progress (at most once per flush)
+    void progressChanged(const BuildProgress &progress);
     
     // Signal emitted when the build process finishes
     void buildFinished(bool success, const QString &message);
@@ -49,9 +75,115 @@ private slots:
     // Handle process finished
     void handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     
+    // Deliver buffered output as a single batch
+    void flushOutput();
+    
 private:
     QProcess *m_process;
     QTemporaryFile *m_scriptFile;
+    std::atomic<bool> m_running;
+    
+    // Output split into lines between flushes
+    LogBatch m_pendingLines;
+    QByteArray m_partialLine;
+    QTimer *m_flushTimer;
+    std::atomic<int> m_flushInterval;
+    
+    // Kills the process if it ignores a cancel request
+    QTimer *m_killTimer;
+    
+    // Parses ninja status lines into progress and ETA
+    NinjaProgressTracker m_progressTracker;
+    
+    // Stage timings of the current build, saved to the build directory
+    BuildReport m_report;
+    QString m_reportPath;
+    QByteArray m_stagePrefix;
+    
+    // Hands out job tokens to make/ninja when the jobserver is enabled
+    JobServer *m_jobServer;
+    
+    // Edges killed for lack of memory, resumed at reduced parallelism
+    BuilderConfiguration m_config;
+    ResourcePlan m_plan;
+    QByteArray m_failedTarget;
+    QStringList m_outOfMemoryTargets;
+    int m_retryCount;
+    int m_retryJobs;
+    bool m_cancelled;
+    
+    // Pool entry of the running build, empty when the pool is not used
+    QString m_poolHash;
+    
+    // How this build configures, and the digest of the arguments it applies
+    ConfigurePlan m_configure;
+    QString m_cmakeDigest;
+    QString m_toolchainKey;
+    QString m_configureDir;   // The final stage's directory in a PGO pipeline
+    
+    // Benchmarks of the build, run after the build script
+    QThread *m_benchmarkThread;
+    std::atomic<bool> m_benchmarkCancelled;
+    
+    // Implementations of the public entry points, run on the executor's thread
+    void startBuild(const BuilderConfiguration &requestedConfig, const ResourcePlan &plan);
+    void startCommand(const QString &command);
+    void stopProcess();
+    
+    // Split output into lines and queue them for the next flush
+    void appendOutput(const QByteArray &data);
+    
+    // Queue one complete line, feeding it to the progress tracker
+    void appendLine(const char *line, int length);
+    
+    // Track ninja's FAILED: blocks and note edges that died for lack of memory
+    void scanForOutOfMemory(const char *line, int length);
+    
+    // Restart the build in place with the killed edges at fewer jobs;
+    // returns false when no retry is possible
+    bool resumeAfterOutOfMemory();
+    
+    // Switch the configuration to its directory in the build directory pool,
+    // evicting old directories over the budget
+    void usePooledBuildDir(BuilderConfiguration &config);
+    
+    // Record the pooled directory's new size and evict again
+    void updateBuildDirPool();
+    
+    // Log the predicted cost of the incremental build against a clean one
+    void forecastRebuild(const BuilderConfiguration &config, const ResourcePlan &plan);
+    
+    // Compare the generated CMake arguments with those the build directory
+    // was configured with, staging the new ones for the build script
+    ConfigurePlan planConfigure(const BuilderConfiguration &config, const CommandGenerator &generator);
+    
+    // Close the report, record what the build left behind and announce the outcome
+    void finishBuild(bool success, int exitCode);
+    
+    // Run the compiler A/B benchmark and the microbenchmarks on a worker
+    // thread, finishing the build once the results are in
+    void startBenchmarks();
+    void reportCompilerBenchmark(const BenchmarkResult &result);
+    
+    // Compare microbenchmark results with the previous build of the
+    // configuration and add them to its history
+    void reportMicrobenchmarks(MicrobenchmarkRun run);
+    
+    // Store how long a full configure took, or log what a partial one saved
+    void recordConfigureTime();
+    
+    // Whether the configure of this build succeeded with the planned arguments
+    bool configureApplied() const;
+    
+    // Keep the probe results of this build's configure for clean configures
+    // with the same toolchain
+    void harvestConfigureSeed();
+    
+    // Read the compiler cache counters the build script left behind into the report
+    void recordCacheStats();
+    
+    // Deliver everything still buffered, including a trailing partial line
+    void flushAllOutput();
     
     // Create a temporary script file with the given content
     QString createScriptFile(const QString &content);
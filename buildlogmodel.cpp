@@ -0,0 +1,52 @@
+#include "buildlogmodel.h"
+
+BuildLogModel::BuildLogModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void BuildLogModel::appendBatch(const LogBatch &batch)
+{
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    int first = m_store.lineCount();
+    beginInsertRows(QModelIndex(), first, first + batch.lineCount() - 1);
+    m_store.appendBatch(batch);
+    endInsertRows();
+}
+
+void BuildLogModel::clear()
+{
+    beginResetModel();
+    m_store.clear();
+    endResetModel();
+}
+
+BuildLogStore &BuildLogModel::store()
+{
+    return m_store;
+}
+
+const BuildLogStore &BuildLogModel::store() const
+{
+    return m_store;
+}
+
+int BuildLogModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_store.lineCount();
+}
+
+QVariant BuildLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    return QString::fromUtf8(m_store.line(index.row()));
+}
@@ -0,0 +1,35 @@
+#ifndef BUILDLOGMODEL_H
+#define BUILDLOGMODEL_H
+
+#include "buildlogstore.h"
+
+#include <QAbstractListModel>
+
+// Exposes a BuildLogStore to a QListView, one row per output line.
+// Lines are decoded only when the view asks for a visible row.
+class BuildLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit BuildLogModel(QObject *parent = nullptr);
+
+    // Append a batch of already split lines as one row insertion
+    void appendBatch(const LogBatch &batch);
+
+    // Remove all lines
+    void clear();
+
+    // Access the underlying store (e.g. for saving)
+    BuildLogStore &store();
+    const BuildLogStore &store() const;
+
+    // QAbstractListModel interface
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    BuildLogStore m_store;
+};
+
+#endif // BUILDLOGMODEL_H
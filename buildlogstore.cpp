@@ -0,0 +1,224 @@
+#include "buildlogstore.h"
+
+#include <QDir>
+#include <QTemporaryFile>
+
+BuildLogStore::BuildLogStore()
+    : m_lineCount(0)
+    , m_memoryUsage(0)
+    , m_memoryLimit(0)
+    , m_firstResidentPage(0)
+    , m_spillFile(nullptr)
+{
+}
+
+BuildLogStore::~BuildLogStore()
+{
+    delete m_spillFile;
+}
+
+void BuildLogStore::append(const QByteArray &data)
+{
+    int start = 0;
+    int newline = data.indexOf('\n');
+
+    while (newline >= 0) {
+        if (m_partialLine.isEmpty()) {
+            appendLine(data.constData() + start, newline - start);
+        } else {
+            // Complete the line that was started by a previous chunk
+            m_partialLine.append(data.constData() + start, newline - start);
+            appendLine(m_partialLine.constData(), m_partialLine.size());
+            m_partialLine.clear();
+        }
+
+        start = newline + 1;
+        newline = data.indexOf('\n', start);
+    }
+
+    if (start < data.size()) {
+        m_partialLine.append(data.constData() + start, data.size() - start);
+    }
+
+    enforceMemoryLimit();
+}
+
+void BuildLogStore::appendBatch(const LogBatch &batch)
+{
+    const char *data = batch.data.constData();
+    int count = batch.lineCount();
+
+    for (int i = 0; i < count; ++i) {
+        quint32 start = batch.lineOffsets.at(i);
+        quint32 end = (i + 1 < count) ? batch.lineOffsets.at(i + 1) : quint32(batch.data.size());
+        appendLine(data + start, int(end - start) - 1);
+    }
+
+    enforceMemoryLimit();
+}
+
+void BuildLogStore::flush()
+{
+    if (m_partialLine.isEmpty()) {
+        return;
+    }
+
+    appendLine(m_partialLine.constData(), m_partialLine.size());
+    m_partialLine.clear();
+    enforceMemoryLimit();
+}
+
+bool BuildLogStore::hasPartialLine() const
+{
+    return !m_partialLine.isEmpty();
+}
+
+void BuildLogStore::clear()
+{
+    m_pages.clear();
+    m_partialLine.clear();
+    m_lineCount = 0;
+    m_memoryUsage = 0;
+    m_firstResidentPage = 0;
+
+    delete m_spillFile;
+    m_spillFile = nullptr;
+}
+
+int BuildLogStore::lineCount() const
+{
+    return m_lineCount;
+}
+
+QByteArray BuildLogStore::line(int index) const
+{
+    if (index < 0 || index >= m_lineCount) {
+        return QByteArray();
+    }
+
+    const Page &page = m_pages.at(pageForLine(index));
+    int local = index - page.firstLine;
+    quint32 start = page.lineOffsets.at(local);
+    quint32 end = (local + 1 < page.lineOffsets.size()) ? page.lineOffsets.at(local + 1) : page.size;
+    int length = int(end - start) - 1; // Drop the newline
+
+    if (page.spillOffset < 0) {
+        return page.data.mid(start, length);
+    }
+
+    // Read just this line back from the spill file
+    if (!m_spillFile || !m_spillFile->seek(page.spillOffset + start)) {
+        return QByteArray();
+    }
+    return m_spillFile->read(length);
+}
+
+void BuildLogStore::setMemoryLimit(qint64 bytes)
+{
+    m_memoryLimit = bytes;
+    enforceMemoryLimit();
+}
+
+qint64 BuildLogStore::memoryLimit() const
+{
+    return m_memoryLimit;
+}
+
+qint64 BuildLogStore::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+bool BuildLogStore::writeTo(QIODevice *device) const
+{
+    for (const Page &page : m_pages) {
+        if (device->write(pageData(page)) != qint64(page.size)) {
+            return false;
+        }
+    }
+
+    if (!m_partialLine.isEmpty() && device->write(m_partialLine) != m_partialLine.size()) {
+        return false;
+    }
+
+    return true;
+}
+
+void BuildLogStore::appendLine(const char *data, int length)
+{
+    // Start a new page when the current one is full or already spilled
+    if (m_pages.isEmpty() || m_pages.last().spillOffset >= 0 ||
+        (m_pages.last().size > 0 && m_pages.last().size + length + 1 > quint32(PageSize))) {
+        Page page;
+        page.firstLine = m_lineCount;
+        page.data.reserve(qMax(PageSize, length + 1));
+        m_pages.append(page);
+    }
+
+    Page &page = m_pages.last();
+    page.lineOffsets.append(page.size);
+    page.data.append(data, length);
+    page.data.append('\n');
+    page.size += length + 1;
+
+    m_memoryUsage += length + 1;
+    ++m_lineCount;
+}
+
+void BuildLogStore::enforceMemoryLimit()
+{
+    if (m_memoryLimit <= 0) {
+        return;
+    }
+
+    // The last page is still being filled, so it always stays resident
+    while (m_memoryUsage > m_memoryLimit && m_firstResidentPage < m_pages.size() - 1) {
+        if (!m_spillFile) {
+            m_spillFile = new QTemporaryFile(QDir::tempPath() + "/llvmbuilder_log_XXXXXX");
+            if (!m_spillFile->open()) {
+                delete m_spillFile;
+                m_spillFile = nullptr;
+                return;
+            }
+        }
+
+        Page &page = m_pages[m_firstResidentPage];
+        qint64 offset = m_spillFile->size();
+        if (!m_spillFile->seek(offset) || m_spillFile->write(page.data) != qint64(page.size)) {
+            return;
+        }
+
+        page.spillOffset = offset;
+        page.data = QByteArray();
+        m_memoryUsage -= page.size;
+        ++m_firstResidentPage;
+    }
+}
+
+int BuildLogStore::pageForLine(int index) const
+{
+    // Binary search for the last page starting at or before the line
+    int low = 0;
+    int high = m_pages.size() - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (m_pages.at(mid).firstLine <= index) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+QByteArray BuildLogStore::pageData(const Page &page) const
+{
+    if (page.spillOffset < 0) {
+        return page.data;
+    }
+
+    if (!m_spillFile || !m_spillFile->seek(page.spillOffset)) {
+        return QByteArray();
+    }
+    return m_spillFile->read(page.size);
+}
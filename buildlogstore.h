@@ -0,0 +1,85 @@
+#ifndef BUILDLOGSTORE_H
+#define BUILDLOGSTORE_H
+
+#include "logbatch.h"
+
+#include <QByteArray>
+#include <QVector>
+#include <QIODevice>
+
+class QTemporaryFile;
+
+// Stores build output as raw UTF-8 in fixed-size pages with a per-page
+// line-offset index. When a memory limit is set, the oldest pages are
+// spilled to a temporary file and read back on demand.
+class BuildLogStore
+{
+public:
+    BuildLogStore();
+    ~BuildLogStore();
+
+    // Append raw output; only complete lines become visible
+    void append(const QByteArray &data);
+
+    // Append lines that were already split by the producer
+    void appendBatch(const LogBatch &batch);
+
+    // Commit a trailing partial line, if any
+    void flush();
+
+    // Check if output ended without a newline
+    bool hasPartialLine() const;
+
+    // Remove all lines and the spill file
+    void clear();
+
+    // Number of complete lines stored
+    int lineCount() const;
+
+    // Get a line without its terminating newline
+    QByteArray line(int index) const;
+
+    // Limit the bytes kept in memory (0 means unlimited)
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+
+    // Bytes of line data currently held in memory
+    qint64 memoryUsage() const;
+
+    // Write the whole log, including spilled pages, to a device
+    bool writeTo(QIODevice *device) const;
+
+private:
+    struct Page {
+        QByteArray data;              // Lines joined with '\n', empty once spilled
+        QVector<quint32> lineOffsets; // Start of each line within the page
+        quint32 size = 0;             // Size of the page data in bytes
+        int firstLine = 0;            // Index of the first line in the page
+        qint64 spillOffset = -1;      // Offset in the spill file, -1 if in memory
+    };
+
+    QVector<Page> m_pages;
+    QByteArray m_partialLine;
+    int m_lineCount;
+    qint64 m_memoryUsage;
+    qint64 m_memoryLimit;
+    int m_firstResidentPage;
+    mutable QTemporaryFile *m_spillFile;
+
+    // Add a complete line (without newline) to the last page
+    void appendLine(const char *data, int length);
+
+    // Move the oldest resident pages to disk until under the limit
+    void enforceMemoryLimit();
+
+    // Find the page containing a line
+    int pageForLine(int index) const;
+
+    // Get the data of a page, reading it back from disk if spilled
+    QByteArray pageData(const Page &page) const;
+
+    // Preferred page size in bytes
+    static const int PageSize = 256 * 1024;
+};
+
+#endif // BUILDLOGSTORE_H
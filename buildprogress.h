@@ -0,0 +1,20 @@
+#ifndef BUILDPROGRESS_H
+#define BUILDPROGRESS_H
+
+#include <QMetaType>
+
+// Snapshot of ninja's progress, sent from the executor to the UI
+struct BuildProgress
+{
+    int finishedEdges = 0;
+    int totalEdges = 0;
+    int runningEdges = 0;
+    double edgesPerSecond = 0.0;   // Throughput over the recent window
+    qint64 elapsedMs = 0;          // Time since the first status line
+    qint64 etaMs = -1;             // Estimated time remaining, -1 if unknown
+    bool historyWeighted = false;  // ETA based on a previous .ninja_log
+};
+
+Q_DECLARE_METATYPE(BuildProgress)
+
+#endif // BUILDPROGRESS_H
@@ -0,0 +1,179 @@
+#include "buildreport.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+double CacheStats::hitRate() const
+{
+    int cacheable = hits + misses;
+    return cacheable > 0 ? 100.0 * hits / cacheable : 0.0;
+}
+
+BuildReport::BuildReport()
+    : m_success(false)
+{
+}
+
+void BuildReport::clear()
+{
+    m_stages.clear();
+    m_retries.clear();
+    m_cacheStats = CacheStats();
+    m_success = false;
+}
+
+void BuildReport::beginStage(const QString &name, qint64 timestampMs)
+{
+    if (!m_stages.isEmpty() && m_stages.last().endMs == 0) {
+        m_stages.last().endMs = timestampMs;
+    }
+
+    BuildStage stage;
+    stage.name = name;
+    stage.startMs = timestampMs;
+    m_stages.append(stage);
+}
+
+void BuildReport::finish(qint64 timestampMs, bool success)
+{
+    if (!m_stages.isEmpty() && m_stages.last().endMs == 0) {
+        m_stages.last().endMs = timestampMs;
+    }
+    m_success = success;
+}
+
+void BuildReport::addRetry(const BuildRetry &retry)
+{
+    m_retries.append(retry);
+}
+
+void BuildReport::setCacheStats(const CacheStats &stats)
+{
+    m_cacheStats = stats;
+}
+
+QVector<BuildStage> BuildReport::stages() const
+{
+    return m_stages;
+}
+
+QVector<BuildRetry> BuildReport::retries() const
+{
+    return m_retries;
+}
+
+CacheStats BuildReport::cacheStats() const
+{
+    return m_cacheStats;
+}
+
+bool BuildReport::success() const
+{
+    return m_success;
+}
+
+QJsonObject BuildReport::toJson() const
+{
+    QJsonObject json;
+
+    QJsonArray stages;
+    for (const BuildStage &stage : m_stages) {
+        QJsonObject entry;
+        entry["name"] = stage.name;
+        entry["startMs"] = stage.startMs;
+        entry["endMs"] = stage.endMs;
+        stages.append(entry);
+    }
+    json["stages"] = stages;
+
+    QJsonArray retries;
+    for (const BuildRetry &retry : m_retries) {
+        QJsonObject entry;
+        entry["timestampMs"] = retry.timestampMs;
+        entry["jobs"] = retry.jobs;
+        entry["targets"] = QJsonArray::fromStringList(retry.targets);
+        retries.append(entry);
+    }
+    json["retries"] = retries;
+
+    if (!m_cacheStats.tool.isEmpty()) {
+        QJsonObject cache;
+        cache["tool"] = m_cacheStats.tool;
+        cache["hits"] = m_cacheStats.hits;
+        cache["misses"] = m_cacheStats.misses;
+        cache["uncacheable"] = m_cacheStats.uncacheable;
+        json["cache"] = cache;
+    }
+    json["success"] = m_success;
+
+    return json;
+}
+
+void BuildReport::fromJson(const QJsonObject &json)
+{
+    clear();
+
+    const QJsonArray stages = json["stages"].toArray();
+    for (const QJsonValue &value : stages) {
+        QJsonObject entry = value.toObject();
+        BuildStage stage;
+        stage.name = entry["name"].toString();
+        stage.startMs = entry["startMs"].toVariant().toLongLong();
+        stage.endMs = entry["endMs"].toVariant().toLongLong();
+        m_stages.append(stage);
+    }
+
+    const QJsonArray retries = json["retries"].toArray();
+    for (const QJsonValue &value : retries) {
+        QJsonObject entry = value.toObject();
+        BuildRetry retry;
+        retry.timestampMs = entry["timestampMs"].toVariant().toLongLong();
+        retry.jobs = entry["jobs"].toInt();
+        for (const QJsonValue &target : entry["targets"].toArray()) {
+            retry.targets.append(target.toString());
+        }
+        m_retries.append(retry);
+    }
+
+    QJsonObject cache = json["cache"].toObject();
+    m_cacheStats.tool = cache["tool"].toString();
+    m_cacheStats.hits = cache["hits"].toInt();
+    m_cacheStats.misses = cache["misses"].toInt();
+    m_cacheStats.uncacheable = cache["uncacheable"].toInt();
+    m_success = json["success"].toBool();
+}
+
+bool BuildReport::saveToFile(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc(toJson());
+    file.write(doc.toJson());
+    return true;
+}
+
+bool BuildReport::loadFromFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isNull() || !doc.isObject()) {
+        return false;
+    }
+
+    fromJson(doc.object());
+    return true;
+}
+
+QString BuildReport::defaultPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".llvmbuilder_report.json");
+}
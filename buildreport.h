@@ -0,0 +1,80 @@
+#ifndef BUILDREPORT_H
+#define BUILDREPORT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+
+// A named stage of the build script (git pull, configure, build, install)
+struct BuildStage
+{
+    QString name;
+    qint64 startMs = 0;   // Milliseconds since the epoch
+    qint64 endMs = 0;
+};
+
+// An automatic resume of the build after edges were killed for lack of memory
+struct BuildRetry
+{
+    qint64 timestampMs = 0;
+    int jobs = 0;            // Job count the killed targets were retried with
+    QStringList targets;     // Outputs of the killed edges
+};
+
+// Compiler cache counters for one build
+struct CacheStats
+{
+    QString tool;            // Empty when no compiler cache was used
+    int hits = 0;
+    int misses = 0;
+    int uncacheable = 0;
+
+    // Hits as a share of cacheable compilations, in percent
+    double hitRate() const;
+};
+
+// Timing record of one run of the build script, stored in the build directory
+class BuildReport
+{
+public:
+    BuildReport();
+
+    // Start a new report
+    void clear();
+
+    // Record that a stage began; the previous stage ends at the same time
+    void beginStage(const QString &name, qint64 timestampMs);
+
+    // Close the last stage and record the outcome
+    void finish(qint64 timestampMs, bool success);
+
+    // Record an automatic retry at reduced parallelism
+    void addRetry(const BuildRetry &retry);
+
+    // Record the compiler cache counters of the build
+    void setCacheStats(const CacheStats &stats);
+
+    QVector<BuildStage> stages() const;
+    QVector<BuildRetry> retries() const;
+    CacheStats cacheStats() const;
+    bool success() const;
+
+    // Save/load the report
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject &json);
+
+    bool saveToFile(const QString &filePath) const;
+    bool loadFromFile(const QString &filePath);
+
+    // The conventional report location inside a build directory
+    static QString defaultPath(const QString &buildDir);
+
+private:
+    QVector<BuildStage> m_stages;
+    QVector<BuildRetry> m_retries;
+    CacheStats m_cacheStats;
+    bool m_success;
+};
+
+#endif // BUILDREPORT_H
@@ -0,0 +1,248 @@
+#include "cmakestate.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace {
+
+// Tools other than the compilers whose cache entries name the toolchain
+const char *const ToolchainEntries[] = {
+    "CMAKE_OSX_SYSROOT", "CMAKE_AR",      "CMAKE_NM",    "CMAKE_RANLIB",    "CMAKE_LIBTOOL",
+    "CMAKE_LINKER",      "CMAKE_OBJCOPY", "CMAKE_STRIP", "LLVM_USE_LINKER", "LD64_EXECUTABLE",
+};
+
+// Whether a cache entry selects part of the toolchain. CMake answers a
+// changed compiler by deleting its whole cache, and keeps the tools it
+// found before when only they change, so neither works as a partial
+// reconfigure.
+bool isToolchainEntry(const QString &name)
+{
+    if (name.startsWith("CMAKE_") && name.endsWith("_COMPILER")) {
+        return true;
+    }
+    for (const char *entry : ToolchainEntries) {
+        if (name == QLatin1String(entry)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+CMakeState::CMakeState()
+    : m_configureMs(0)
+{
+}
+
+CMakeState CMakeState::fromGenerator(const CommandGenerator &generator)
+{
+    CMakeState state;
+    state.m_defines = generator.cmakeDefines();
+    state.m_generator = generator.cmakeGenerator();
+    state.m_sourceDir = generator.cmakeSourceDir();
+    return state;
+}
+
+QString CMakeState::digest() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(m_generator.toUtf8() + '\n');
+    hash.addData(m_sourceDir.toUtf8() + '\n');
+    for (const CMakeDefine &define : m_defines) {
+        if (!define.hostDerived) {
+            hash.addData(define.name.toUtf8() + '=' + define.value.toUtf8() + '\n');
+        }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+ConfigurePlan CMakeState::planFrom(const CMakeState &previous) const
+{
+    ConfigurePlan plan;
+    plan.lastConfigureMs = previous.m_configureMs;
+
+    if (previous.m_defines.isEmpty()) {
+        plan.reason = "no record of an earlier configure";
+        return plan;
+    }
+    if (previous.m_generator != m_generator || previous.m_sourceDir != m_sourceDir) {
+        plan.reason = "generator or source directory changed";
+        return plan;
+    }
+    if (previous.digest() == digest()) {
+        plan.mode = ConfigurePlan::Skip;
+        plan.reason = "CMake arguments unchanged";
+        return plan;
+    }
+
+    QHash<QString, CMakeDefine> previousDefines;
+    for (const CMakeDefine &define : previous.m_defines) {
+        previousDefines.insert(define.name, define);
+    }
+
+    // Job pools sized from the host follow free memory; re-running CMake
+    // only for those would cost more than it gains. A configured pool
+    // size that became derived is a change of its own.
+    QVector<CMakeDefine> hostDerived;
+    for (const CMakeDefine &define : m_defines) {
+        auto it = previousDefines.constFind(define.name);
+        bool known = it != previousDefines.constEnd();
+        if (!known || (it->value != define.value && !(define.hostDerived && it->hostDerived))) {
+            plan.changed.append(define);
+        } else if (define.hostDerived) {
+            hostDerived.append(define);
+        }
+        previousDefines.remove(define.name);
+    }
+    for (auto it = previousDefines.constBegin(); it != previousDefines.constEnd(); ++it) {
+        plan.removed.append(it.key());
+    }
+    plan.removed.sort();
+
+    if (plan.changed.isEmpty() && plan.removed.isEmpty()) {
+        plan.mode = ConfigurePlan::Skip;
+        plan.reason = "CMake arguments unchanged";
+        return plan;
+    }
+
+    QStringList names;
+    for (const CMakeDefine &define : plan.changed) {
+        names.append(define.name);
+    }
+    names.append(plan.removed);
+
+    // Once CMake runs anyway, the pools follow the host's current memory
+    plan.changed += hostDerived;
+
+    // A new toolchain needs every argument again, and the generator
+    QStringList toolchain;
+    for (const QString &name : names) {
+        if (isToolchainEntry(name)) {
+            toolchain.append(name);
+        }
+    }
+    if (!toolchain.isEmpty()) {
+        plan.changed.clear();
+        plan.removed.clear();
+        plan.reason = QString("toolchain changed (%1), which makes CMake discard its cache").arg(toolchain.join(", "));
+        return plan;
+    }
+
+    plan.mode = ConfigurePlan::Changed;
+    plan.reason = QString("%1 cache entries changed (%2)").arg(names.size()).arg(names.join(", "));
+    return plan;
+}
+
+qint64 CMakeState::configureMs() const
+{
+    return m_configureMs;
+}
+
+void CMakeState::setConfigureMs(qint64 milliseconds)
+{
+    m_configureMs = milliseconds;
+}
+
+QJsonObject CMakeState::toJson() const
+{
+    QJsonObject json;
+    json["digest"] = digest();
+    json["generator"] = m_generator;
+    json["sourceDir"] = m_sourceDir;
+    json["configureMs"] = m_configureMs;
+
+    QJsonArray defines;
+    for (const CMakeDefine &define : m_defines) {
+        QJsonObject entry;
+        entry["name"] = define.name;
+        entry["value"] = define.value;
+        if (define.hostDerived) {
+            entry["hostDerived"] = true;
+        }
+        defines.append(entry);
+    }
+    json["defines"] = defines;
+
+    return json;
+}
+
+void CMakeState::fromJson(const QJsonObject &json)
+{
+    m_defines.clear();
+    m_generator = json["generator"].toString();
+    m_sourceDir = json["sourceDir"].toString();
+    m_configureMs = json["configureMs"].toVariant().toLongLong();
+
+    const QJsonArray defines = json["defines"].toArray();
+    for (const QJsonValue &value : defines) {
+        QJsonObject entry = value.toObject();
+        CMakeDefine define;
+        define.name = entry["name"].toString();
+        define.value = entry["value"].toString();
+        define.hostDerived = entry["hostDerived"].toBool();
+        m_defines.append(define);
+    }
+}
+
+QHash<QString, QString> CMakeState::cacheValues(const QString &cacheFile, const QStringList &names)
+{
+    QHash<QString, QString> values;
+    QFile cache(cacheFile);
+    if (!cache.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return values;
+    }
+
+    // NAME:TYPE=VALUE
+    while (!cache.atEnd()) {
+        QString line = QString::fromUtf8(cache.readLine()).trimmed();
+        int colon = line.indexOf(':');
+        int equals = line.indexOf('=', colon + 1);
+        if (colon > 0 && equals > 0 && names.contains(line.left(colon))) {
+            values.insert(line.left(colon), line.mid(equals + 1));
+        }
+    }
+    return values;
+}
+
+bool CMakeState::saveToFile(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc(toJson());
+    file.write(doc.toJson());
+    return true;
+}
+
+bool CMakeState::loadFromFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isNull() || !doc.isObject()) {
+        return false;
+    }
+
+    fromJson(doc.object());
+    return true;
+}
+
+QString CMakeState::defaultPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".llvmbuilder_cmake_state.json");
+}
+
+QString CMakeState::pendingPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".llvmbuilder_cmake_state.pending");
+}
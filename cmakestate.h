@@ -0,0 +1,70 @@
+#ifndef CMAKESTATE_H
+#define CMAKESTATE_H
+
+#include "commandgenerator.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+
+// How the configure stage of a build runs
+struct ConfigurePlan
+{
+    enum Mode {
+        Full,       // Run the complete CMake command
+        Changed,    // Pass only the changed and removed cache entries
+        Skip        // Leave the existing configuration untouched
+    };
+
+    Mode mode = Full;
+    QVector<CMakeDefine> changed;
+    QStringList removed;
+    QString reason;             // Why this mode was chosen, for the build log
+    qint64 lastConfigureMs = 0; // Duration of the last full configure, 0 if unknown
+    bool recordState = false;   // Commit the pending state once CMake succeeds
+    QString seedFile;           // Initial cache of probe results for a clean configure
+};
+
+// The CMake arguments a build directory was last configured with, stored
+// in the build directory so the next build can tell what changed
+class CMakeState
+{
+public:
+    CMakeState();
+
+    // Capture the arguments the generator would pass for its configuration
+    static CMakeState fromGenerator(const CommandGenerator &generator);
+
+    // SHA-1 of the arguments, leaving out host-derived job pool sizes
+    QString digest() const;
+
+    // Decide how to bring a directory configured as previous up to this state
+    ConfigurePlan planFrom(const CMakeState &previous) const;
+
+    // Duration of the last full configure with these arguments
+    qint64 configureMs() const;
+    void setConfigureMs(qint64 milliseconds);
+
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject &json);
+
+    // Values of the named entries in a CMakeCache.txt, by name
+    static QHash<QString, QString> cacheValues(const QString &cacheFile, const QStringList &names);
+
+    bool saveToFile(const QString &filePath) const;
+    bool loadFromFile(const QString &filePath);
+
+    // Where the applied state lives, and where a build stages the new one
+    static QString defaultPath(const QString &buildDir);
+    static QString pendingPath(const QString &buildDir);
+
+private:
+    QVector<CMakeDefine> m_defines;
+    QString m_generator;
+    QString m_sourceDir;
+    qint64 m_configureMs;
+};
+
+#endif // CMAKESTATE_H
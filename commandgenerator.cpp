@@ -1,223 +1,390 @@
 #include "commandgenerator.h"
+#include "resourceplanner.h"
+#include "compilercache.h"
+#include "cmakestate.h"
+#include "rebuildforecast.h"
+#include "distributionplanner.h"
+#include "pgopipeline.h"
+#include "boltstage.h"
+#include "littestrunner.h"
+#include "stagepipeline.h"
+#include "sourcecheckout.h"
+#include "sourceprefetcher.h"
+
+#include <algorithm>
+
+namespace {
+
+const char *const CMakePath = "/Applications/CMake.app/Contents/bin/cmake";
+
+} // namespace
 
 CommandGenerator::CommandGenerator(const BuilderConfiguration &config)
+    : CommandGenerator(config, ResourcePlanner::plan(config))
+{
+}
+
+CommandGenerator::CommandGenerator(const BuilderConfiguration &config, const ResourcePlan &plan)
     : m_config(config)
+    , m_plan(plan)
 {
 }
 
-QString CommandGenerator::generateCMakeCommand() const
+void CommandGenerator::setExtraDefines(const QVector<CMakeDefine> &defines)
 {
-    QString command = "/Applications/CMake.app/Contents/bin/cmake";
+    m_extraDefines = defines;
+}
+
+QVector<CMakeDefine> CommandGenerator::cmakeDefines() const
+{
+    QVector<CMakeDefine> defines;
+    auto define = [&defines](const QString &name, const QString &value) {
+        defines.append({name, value, false});
+    };
     
     // Set compiler paths
     if (m_config.useXcodeGcc()) {
-        command += " -DLLVM_USE_LINKER=\"/usr/bin/ld\" -DCMAKE_LIBTOOL=\"/usr/bin/libtool\" "
-                   "-DCMAKE_CXX_COMPILER=\"/usr/bin/g++\" -DCMAKE_C_COMPILER=\"/usr/bin/gcc\" "
-                   "-DLLVM_LOCAL_RPATH=\"" + m_config.installPath() + "/lib\" "
-                   "-DCMAKE_OBJDUMP=\"/usr/bin/objdump\" -DCMAKE_NM=\"/usr/bin/nm\" "
-                   "-DCMAKE_STRIP=\"/usr/bin/strip\" -DCMAKE_AR=\"/usr/bin/ar\" "
-                   "-DCMAKE_INSTALL_NAME_TOOL=\"/usr/bin/install_name_tool\"";
+        define("LLVM_USE_LINKER", "/usr/bin/ld");
+        define("CMAKE_LIBTOOL", "/usr/bin/libtool");
+        define("CMAKE_CXX_COMPILER", "/usr/bin/g++");
+        define("CMAKE_C_COMPILER", "/usr/bin/gcc");
+        define("LLVM_LOCAL_RPATH", m_config.installPath() + "/lib");
+        define("CMAKE_OBJDUMP", "/usr/bin/objdump");
+        define("CMAKE_NM", "/usr/bin/nm");
+        define("CMAKE_STRIP", "/usr/bin/strip");
+        define("CMAKE_AR", "/usr/bin/ar");
+        define("CMAKE_INSTALL_NAME_TOOL", "/usr/bin/install_name_tool");
     } else {
-        command += " -DLLVM_USE_LINKER=\"" + m_config.compilerPath() + "/bin/" + m_config.linker() + "\" "
-                   "-DLD64_EXECUTABLE=\"" + m_config.compilerPath() + "/bin/lld\" "
-                   "-DCMAKE_LIBTOOL=\"" + m_config.compilerPath() + "/bin/llvm-libtool-darwin\" "
-                   "-DCMAKE_CXX_COMPILER=\"" + m_config.compilerPath() + "/bin/" + m_config.cxxCompiler() + "\" "
-                   "-DCMAKE_C_COMPILER=\"" + m_config.compilerPath() + "/bin/" + m_config.compiler() + "\" "
-                   "-DLLVM_LOCAL_RPATH=\"" + m_config.installPath() + "/lib\" "
-                   "-DLLVM_INSTALL_BINUTILS_SYMLINKS=\"ON\" "
-                   "-DCMAKE_OBJDUMP=\"" + m_config.compilerPath() + "/bin/llvm-objdump\" "
-                   "-DCMAKE_OBJCOPY=\"" + m_config.compilerPath() + "/bin/llvm-objcopy\" "
-                   "-DCMAKE_NM=\"" + m_config.compilerPath() + "/bin/llvm-nm\" "
-                   "-DCMAKE_STRIP=\"" + m_config.compilerPath() + "/bin/llvm-strip\" "
-                   "-DCMAKE_AR=\"" + m_config.compilerPath() + "/bin/llvm-ar\" "
-                   "-DCMAKE_INSTALL_NAME_TOOL=\"" + m_config.compilerPath() + "/bin/llvm-install-name-tool\"";
+        define("LLVM_USE_LINKER", m_config.compilerPath() + "/bin/" + m_config.linker());
+        define("LD64_EXECUTABLE", m_config.compilerPath() + "/bin/lld");
+        define("CMAKE_LIBTOOL", m_config.compilerPath() + "/bin/llvm-libtool-darwin");
+        define("CMAKE_CXX_COMPILER", m_config.compilerPath() + "/bin/" + m_config.cxxCompiler());
+        define("CMAKE_C_COMPILER", m_config.compilerPath() + "/bin/" + m_config.compiler());
+        define("LLVM_LOCAL_RPATH", m_config.installPath() + "/lib");
+        define("LLVM_INSTALL_BINUTILS_SYMLINKS", "ON");
+        define("CMAKE_OBJDUMP", m_config.compilerPath() + "/bin/llvm-objdump");
+        define("CMAKE_OBJCOPY", m_config.compilerPath() + "/bin/llvm-objcopy");
+        define("CMAKE_NM", m_config.compilerPath() + "/bin/llvm-nm");
+        define("CMAKE_STRIP", m_config.compilerPath() + "/bin/llvm-strip");
+        define("CMAKE_AR", m_config.compilerPath() + "/bin/llvm-ar");
+        define("CMAKE_INSTALL_NAME_TOOL", m_config.compilerPath() + "/bin/llvm-install-name-tool");
     }
     
     // Build flags
     QString commonFlags = "-fno-stack-protector -fno-common -O" + m_config.optLevel();
-    command += " -DCMAKE_C_FLAGS_RELEASE=\"" + commonFlags + "\" "
-               "-DCMAKE_CXX_FLAGS_RELEASE=\"" + commonFlags + "\" "
-               "-DCMAKE_ASM_FLAGS_RELEASE=\"" + commonFlags + "\"";
+    // -ftime-trace writes a per-TU JSON next to each object; not for assembly
+    QString compileFlags = commonFlags;
+    if (m_config.timeTrace()) {
+        compileFlags += " -ftime-trace";
+    }
+    define("CMAKE_C_FLAGS_RELEASE", compileFlags);
+    define("CMAKE_CXX_FLAGS_RELEASE", compileFlags);
+    define("CMAKE_ASM_FLAGS_RELEASE", commonFlags);
+    
+    // Job pools sized for this host; derived sizes vary with free memory
+    // from one build to the next
+    defines.append({"LLVM_PARALLEL_LINK_JOBS", QString::number(m_plan.linkJobs), !m_plan.linkJobsOverridden});
+    defines.append({"LLVM_PARALLEL_COMPILE_JOBS", QString::number(m_plan.compileJobs), !m_plan.compileJobsOverridden});
+    
+    // Compiler cache
+    if (CompilerCache::isEnabled(m_config)) {
+        QString launcher = CompilerCache::launcher(m_config);
+        define("CMAKE_C_COMPILER_LAUNCHER", launcher);
+        define("CMAKE_CXX_COMPILER_LAUNCHER", launcher);
+    }
     
     // Set architecture
-    command += " -DLLVM_TARGETS_TO_BUILD=\"" + m_config.arch() + "\" "
-               "-DCMAKE_OSX_ARCHITECTURES=\"" + m_config.osxArch() + "\"";
+    define("LLVM_TARGETS_TO_BUILD", m_config.arch());
+    define("CMAKE_OSX_ARCHITECTURES", m_config.osxArch());
     
     // Common flags for macOS builds
-    command += " -DLLVM_INSTALL_CCTOOLS_SYMLINKS=\"ON\" -DLLVM_INSTALL_UTILS=\"ON\" "
-               "-DLIBCLANG_BUILD_STATIC=\"ON\" -DCMAKE_MACOSX_RPATH=\"ON\" "
-               "-DCLANG_DEFAULT_RTLIB=\"compiler-rt\" -DCMAKE_CXX_STANDARD=\"20\" "
-               "-DLLVM_PARALLEL_LINK_JOBS=\"24\" -DLLVM_PARALLEL_COMPILE_JOBS=\"24\" "
-               "-DDEFAULT_SYSROOT=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk\" "
-               "-DCLANG_SPAWN_CC1=\"ON\" -DCOMPILER_RT_BUILD_BUILTINS=\"OFF\" "
-               "-DCOMPILER_RT_USE_BUILTINS_LIBRARY=\"OFF\" -DLLDB_USE_SYSTEM_DEBUGSERVER=\"ON\" "
-               "-DLLDB_EMBED_PYTHON_HOME=\"OFF\" -DLLDB_ENABLE_LZMA=\"OFF\" -DLLVM_ENABLE_ZSTD=\"OFF\" "
-               "-DLLDB_ENABLE_CURSES=\"OFF\" -DLLVM_ENABLE_LIBEDIT=\"OFF\" -DLLVM_ENABLE_Z3_SOLVER=\"OFF\"";
+    define("LLVM_INSTALL_CCTOOLS_SYMLINKS", "ON");
+    define("LLVM_INSTALL_UTILS", "ON");
+    define("LIBCLANG_BUILD_STATIC", "ON");
+    define("CMAKE_MACOSX_RPATH", "ON");
+    define("CLANG_DEFAULT_RTLIB", "compiler-rt");
+    define("CMAKE_CXX_STANDARD", "20");
+    define("DEFAULT_SYSROOT", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk");
+    define("CLANG_SPAWN_CC1", "ON");
+    define("COMPILER_RT_BUILD_BUILTINS", "OFF");
+    define("COMPILER_RT_USE_BUILTINS_LIBRARY", "OFF");
+    define("LLDB_USE_SYSTEM_DEBUGSERVER", "ON");
+    define("LLDB_EMBED_PYTHON_HOME", "OFF");
+    define("LLDB_ENABLE_LZMA", "OFF");
+    define("LLVM_ENABLE_ZSTD", "OFF");
+    define("LLDB_ENABLE_CURSES", "OFF");
+    define("LLVM_ENABLE_LIBEDIT", "OFF");
+    define("LLVM_ENABLE_Z3_SOLVER", "OFF");
     
     // Warnings
-    if (m_config.doNotWarn()) {
-        command += " -DLLVM_ENABLE_WARNINGS=\"OFF\"";
-    } else {
-        command += " -DLLVM_ENABLE_WARNINGS=\"ON\"";
-    }
+    define("LLVM_ENABLE_WARNINGS", m_config.doNotWarn() ? "OFF" : "ON");
     
     // Tests
-    if (m_config.doTesting()) {
-        command += " -DLLVM_BUILD_TESTS=\"ON\" -DLLDB_INCLUDE_TESTS=\"ON\" "
-                   "-DMLIR_INCLUDE_INTEGRATION_TEST=\"ON\" -DMLIR_INCLUDE_TESTS=\"ON\" "
-                   "-DCLANG_INCLUDE_TESTS=\"ON\" -DFLANG_INCLUDE_TESTS=\"ON\" "
-                   "-DLLVM_INCLUDE_TESTS=\"ON\" -DLLVM_TOOL_CROSS_PROJECT_TESTS_BUILD=\"ON\" "
-                   "-DLLVM_INDIVIDUAL_TEST_COVERAGE=\"ON\"";
-    } else {
-        command += " -DLLVM_BUILD_TESTS=\"OFF\" -DLLDB_INCLUDE_TESTS=\"OFF\" "
-                   "-DMLIR_INCLUDE_INTEGRATION_TEST=\"OFF\" -DMLIR_INCLUDE_TESTS=\"OFF\" "
-                   "-DCLANG_INCLUDE_TESTS=\"OFF\" -DFLANG_INCLUDE_TESTS=\"OFF\" "
-                   "-DLLVM_INCLUDE_TESTS=\"OFF\" -DLLVM_TOOL_CROSS_PROJECT_TESTS_BUILD=\"OFF\" "
-                   "-DLLVM_INDIVIDUAL_TEST_COVERAGE=\"OFF\"";
-    }
+    QString tests = m_config.doTesting() ? "ON" : "OFF";
+    define("LLVM_BUILD_TESTS", tests);
+    define("LLDB_INCLUDE_TESTS", tests);
+    define("MLIR_INCLUDE_INTEGRATION_TEST", tests);
+    define("MLIR_INCLUDE_TESTS", tests);
+    define("CLANG_INCLUDE_TESTS", tests);
+    define("FLANG_INCLUDE_TESTS", tests);
+    define("LLVM_INCLUDE_TESTS", tests);
+    define("LLVM_TOOL_CROSS_PROJECT_TESTS_BUILD", tests);
+    define("LLVM_INDIVIDUAL_TEST_COVERAGE", tests);
     
     // Benchmark
-    if (m_config.benchmark()) {
-        command += " -DLLVM_INCLUDE_BENCHMARKS=\"ON\" -DLLVM_BUILD_BENCHMARKS=\"ON\"";
-    } else {
-        command += " -DLLVM_INCLUDE_BENCHMARKS=\"OFF\" -DLLVM_BUILD_BENCHMARKS=\"OFF\"";
-    }
+    QString benchmarks = m_config.benchmark() ? "ON" : "OFF";
+    define("LLVM_INCLUDE_BENCHMARKS", benchmarks);
+    define("LLVM_BUILD_BENCHMARKS", benchmarks);
     
     // Python configuration
     if (m_config.useLocalPython()) {
-        command += " -DPython3_EXECUTABLE=\"/Library/Frameworks/Python.framework/Versions/Current/bin/python3\" "
-                   "-DPYTHON_LIBRARY=\"/Library/Frameworks/Python.framework/Versions/Current/Python\" "
-                   "-DPYTHON_INCLUDE_DIR=\"/Library/Frameworks/Python.framework/Versions/Current/Headers\"";
+        define("Python3_EXECUTABLE", "/Library/Frameworks/Python.framework/Versions/Current/bin/python3");
+        define("PYTHON_LIBRARY", "/Library/Frameworks/Python.framework/Versions/Current/Python");
+        define("PYTHON_INCLUDE_DIR", "/Library/Frameworks/Python.framework/Versions/Current/Headers");
     } else {
-        command += " -DPython3_EXECUTABLE=\"/Applications/Xcode.app/Contents/Developer/Library/Frameworks/Python3.framework/Versions/Current/bin/python3\" "
-                   "-DPYTHON_LIBRARY=\"/Applications/Xcode.app/Contents/Developer/Library/Frameworks/Python3.framework/Versions/Current/Python\" "
-                   "-DPYTHON_INCLUDE_DIR=\"/Applications/Xcode.app/Contents/Developer/Library/Frameworks/Python3.framework/Versions/Current/Headers\"";
+        define("Python3_EXECUTABLE", "/Applications/Xcode.app/Contents/Developer/Library/Frameworks/Python3.framework/Versions/Current/bin/python3");
+        define("PYTHON_LIBRARY", "/Applications/Xcode.app/Contents/Developer/Library/Frameworks/Python3.framework/Versions/Current/Python");
+        define("PYTHON_INCLUDE_DIR", "/Applications/Xcode.app/Contents/Developer/Library/Frameworks/Python3.framework/Versions/Current/Headers");
     }
     
     // Projects and runtimes
-    command += " -DCMAKE_INSTALL_PREFIX=\"" + m_config.installPath() + "\" "
-               "-DLLVM_ENABLE_RUNTIMES=\"" + m_config.runtimes() + "\" "
-               "-DLLVM_ENABLE_PROJECTS=\"" + m_config.projects() + "\"";
+    define("CMAKE_INSTALL_PREFIX", m_config.installPath());
+    define("LLVM_ENABLE_RUNTIMES", m_config.runtimes());
+    define("LLVM_ENABLE_PROJECTS", projects());
     
-    // Backtraces
-    if (m_config.backtraces()) {
-        command += " -DLLVM_ENABLE_BACKTRACES=\"ON\"";
-    } else {
-        command += " -DLLVM_ENABLE_BACKTRACES=\"OFF\"";
+    // Distribution components
+    if (buildsDistribution()) {
+        define("LLVM_DISTRIBUTION_COMPONENTS", DistributionPlanner::components(m_config).join(";"));
     }
     
+    // Backtraces
+    define("LLVM_ENABLE_BACKTRACES", m_config.backtraces() ? "ON" : "OFF");
+    
     // Modules
-    if (m_config.modules()) {
-        command += " -DLLVM_ENABLE_MODULES=\"ON\"";
-    } else {
-        command += " -DLLVM_ENABLE_MODULES=\"OFF\"";
-    }
+    define("LLVM_ENABLE_MODULES", m_config.modules() ? "ON" : "OFF");
     
     // Terminfo
     if (m_config.terminfo()) {
-        command += " -DLLVM_ENABLE_TERMINFO=\"ON\" "
-                   "-DTerminfo_LIBRARIES=\"/Applications/Xcode-beta.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libcurses.tbd\"";
+        define("LLVM_ENABLE_TERMINFO", "ON");
+        define("Terminfo_LIBRARIES", "/Applications/Xcode-beta.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libcurses.tbd");
     } else {
-        command += " -DLLVM_ENABLE_TERMINFO=\"OFF\"";
+        define("LLVM_ENABLE_TERMINFO", "OFF");
     }
     
     // FFI
     if (m_config.ffi()) {
-        command += " -DLLVM_ENABLE_FFI=\"ON\" "
-                   "-DFFI_INCLUDE_DIR=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include/ffi\" "
-                   "-DFFI_LIBRARY_DIR=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libffi.tbd\"";
+        define("LLVM_ENABLE_FFI", "ON");
+        define("FFI_INCLUDE_DIR", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include/ffi");
+        define("FFI_LIBRARY_DIR", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libffi.tbd");
     } else {
-        command += " -DLLVM_ENABLE_FFI=\"OFF\"";
+        define("LLVM_ENABLE_FFI", "OFF");
     }
     
     // XML2
     if (m_config.xml2()) {
-        command += " -DLLVM_ENABLE_LIBXML2=\"ON\" -DLLDB_ENABLE_LIBXML2=\"ON\" "
-                   "-DLIBXML2_INCLUDE_DIR=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include/libxml\" "
-                   "-DLIBXML2_LIBRARY=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libxml2.2.tbd\"";
+        define("LLVM_ENABLE_LIBXML2", "ON");
+        define("LLDB_ENABLE_LIBXML2", "ON");
+        define("LIBXML2_INCLUDE_DIR", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include/libxml");
+        define("LIBXML2_LIBRARY", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libxml2.2.tbd");
     } else {
-        command += " -DLLVM_ENABLE_LIBXML2=\"OFF\" -DLLDB_ENABLE_LIBXML2=\"OFF\"";
+        define("LLVM_ENABLE_LIBXML2", "OFF");
+        define("LLDB_ENABLE_LIBXML2", "OFF");
     }
     
     // ZLIB
     if (m_config.zlib()) {
-        command += " -DLLVM_ENABLE_ZLIB=\"ON\" "
-                   "-DZLIB_INCLUDE_DIR=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include\" "
-                   "-DZLIB_LIBRARY_RELEASE=\"/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libz.1.tbd\"";
+        define("LLVM_ENABLE_ZLIB", "ON");
+        define("ZLIB_INCLUDE_DIR", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/include");
+        define("ZLIB_LIBRARY_RELEASE", "/Applications/Xcode.app/Contents/Developer/Platforms/MacOSX.platform/Developer/SDKs/MacOSX.sdk/usr/lib/libz.1.tbd");
     } else {
-        command += " -DLLVM_ENABLE_ZLIB=\"OFF\"";
+        define("LLVM_ENABLE_ZLIB", "OFF");
     }
     
     // LTO
     if (m_config.noLto()) {
-        command += " -DLLVM_ENABLE_LTO=\"Off\"";
+        define("LLVM_ENABLE_LTO", "Off");
     } else if (m_config.fullLto()) {
-        command += " -DLLVM_ENABLE_LTO=\"Full\"";
+        define("LLVM_ENABLE_LTO", "Full");
     } else {
-        command += " -DLLVM_ENABLE_LTO=\"Thin\"";
+        define("LLVM_ENABLE_LTO", "Thin");
     }
     
     // DYLIB
-    if (m_config.useDylib()) {
-        command += " -DLLVM_BUILD_LLVM_DYLIB=\"ON\" -DLLVM_LINK_LLVM_DYLIB=\"ON\"";
-    } else {
-        command += " -DLLVM_BUILD_LLVM_DYLIB=\"OFF\" -DLLVM_LINK_LLVM_DYLIB=\"OFF\"";
+    QString dylib = m_config.useDylib() ? "ON" : "OFF";
+    define("LLVM_BUILD_LLVM_DYLIB", dylib);
+    define("LLVM_LINK_LLVM_DYLIB", dylib);
+    
+    // BOLT rewrites ELF binaries best with their relocations kept
+    if (boltOptimizes()) {
+        define("CMAKE_EXE_LINKER_FLAGS", "-Wl,--emit-relocs");
     }
     
     // Xcode Toolchain
-    if (m_config.xcodeToolchain()) {
-        command += " -DLLVM_CREATE_XCODE_TOOLCHAIN=\"ON\"";
-    } else {
-        command += " -DLLVM_CREATE_XCODE_TOOLCHAIN=\"OFF\"";
+    define("LLVM_CREATE_XCODE_TOOLCHAIN", m_config.xcodeToolchain() ? "ON" : "OFF");
+    
+    define("CMAKE_BUILD_TYPE", "Release");
+    
+    // Entries added by a pipeline stage replace generated ones of the same name
+    for (const CMakeDefine &extra : m_extraDefines) {
+        auto it = std::find_if(defines.begin(), defines.end(),
+                               [&extra](const CMakeDefine &define) { return define.name == extra.name; });
+        if (it != defines.end()) {
+            *it = extra;
+        } else {
+            defines.append(extra);
+        }
+    }
+    
+    return defines;
+}
+
+QString CommandGenerator::cmakeGenerator() const
+{
+    return m_config.useMake() ? "Unix Makefiles" : "Ninja";
+}
+
+QString CommandGenerator::cmakeSourceDir() const
+{
+    return m_config.llvmDir() + "/llvm";
+}
+
+QString CommandGenerator::generateCMakeCommand(const QString &initialCache) const
+{
+    QString command = CMakePath;
+    if (!initialCache.isEmpty()) {
+        command += " -C \"" + initialCache + "\"";
+    }
+    
+    const QVector<CMakeDefine> defines = cmakeDefines();
+    for (const CMakeDefine &define : defines) {
+        command += " " + defineArgument(define);
     }
     
     // Build system
-    if (m_config.useMake()) {
-        command += " -DCMAKE_BUILD_TYPE=\"Release\" -G \"Unix Makefiles\" -S \"" + 
-                   m_config.llvmDir() + "/llvm\" -B \"" + m_config.buildDir() + "\"";
-    } else {
-        command += " -DCMAKE_BUILD_TYPE=\"Release\" -GNinja -S \"" + 
-                   m_config.llvmDir() + "/llvm\" -B \"" + m_config.buildDir() + "\"";
+    command += " -G \"" + cmakeGenerator() + "\" -S \"" + cmakeSourceDir() + "\" -B \"" + m_config.buildDir() + "\"";
+    
+    return command;
+}
+
+QString CommandGenerator::generateReconfigureCommand(const ConfigurePlan &configure) const
+{
+    // Everything not mentioned keeps its value from CMakeCache.txt
+    QString command = CMakePath;
+    for (const CMakeDefine &define : configure.changed) {
+        command += " " + defineArgument(define);
     }
+    for (const QString &name : configure.removed) {
+        command += " -U\"" + name + "\"";
+    }
+    command += " -S \"" + cmakeSourceDir() + "\" -B \"" + m_config.buildDir() + "\"";
     
     return command;
 }
 
+QString CommandGenerator::defineArgument(const CMakeDefine &define)
+{
+    return "-D" + define.name + "=\"" + define.value + "\"";
+}
+
 QString CommandGenerator::generateBuildExecutionCommand() const
 {
     QString command;
     
+    // Only what the distribution components need, rather than "all"
+    QString target = buildsDistribution() ? " distribution" : "";
+    
+    // With the executor's jobserver, parallelism comes from MAKEFLAGS; an
+    // explicit -j would make ninja ignore it. The executor turns the
+    // jobserver off for a make or ninja too old to use it.
+    if (m_config.useJobServer()) {
+        return (m_config.useMake() ? "make" : "ninja") + target;
+    }
+    
     if (m_config.useMake()) {
-        command = "make -j24 -l24";
+        command = "make" + jobFlags(m_plan);
     } else {
-        command = "ninja -j24";
+        command = "ninja -j" + QString::number(m_plan.compileJobs);
     }
     
-    return command;
+    return command + target;
 }
 
 QString CommandGenerator::generateInstallCommand() const
 {
     QString command;
+    QString jobs = jobFlags(m_plan);
+    
+    // A distribution installs just its components, optionally stripped
+    QString target = "install";
+    if (buildsDistribution()) {
+        target = m_config.stripDistribution() ? "install-distribution-stripped" : "install-distribution";
+    }
     
     if (m_config.useMake()) {
         if (m_config.sudoInstall()) {
-            command = "sudo make install -j24 -l24";
+            command = "sudo make " + target + jobs;
         } else {
-            command = "make install -j24 -l24";
+            command = "make " + target + jobs;
         }
     } else {
         if (m_config.sudoInstall()) {
-            command = "sudo ninja install -j24 -l24";
+            command = "sudo ninja " + target + jobs;
         } else {
-            command = "ninja install -j24 -l24";
+            command = "ninja " + target + jobs;
         }
     }
     
     return command;
 }
 
+QString CommandGenerator::projects() const
+{
+    // llvm-bolt for the BOLT stage comes from the build itself
+    QString projects = m_config.projects();
+    if (boltOptimizes() && !projects.split(';').contains("bolt")) {
+        projects += projects.isEmpty() ? "bolt" : ";bolt";
+    }
+    return projects;
+}
+
+QString CommandGenerator::pipelinedBuildCommand() const
+{
+    StagePipeline pipeline(m_config, m_plan);
+    if (!pipeline.isEnabled()) {
+        return generateBuildExecutionCommand();
+    }
+
+    // Naming targets replaces ninja's default one
+    return generateBuildExecutionCommand() + (buildsDistribution() ? "" : " all") + " " + pipeline.targets().join(' ');
+}
+
+bool CommandGenerator::buildsDistribution() const
+{
+    return m_config.useDistribution() && !DistributionPlanner::components(m_config).isEmpty();
+}
+
+bool CommandGenerator::boltOptimizes() const
+{
+    return m_config.boltOptimize() && BoltStage::isSupported();
+}
+
+QString CommandGenerator::recordRevisionCommand() const
+{
+    return "git -C \"" + m_config.llvmDir() + "\" rev-parse HEAD > \"" +
+           RebuildForecaster::revisionPath(m_config.buildDir()) + "\"";
+}
+
+QString CommandGenerator::jobFlags(const ResourcePlan &plan)
+{
+    return " -j" + QString::number(plan.compileJobs) + " -l" + QString::number(plan.loadLimit);
+}
+
 QString CommandGenerator::generateBuildCommand() const
+{
+    return generateBuildCommand(ConfigurePlan());
+}
+
+QString CommandGenerator::generateBuildCommand(const ConfigurePlan &configure) const
 {
     if (m_config.dryRun()) {
         return generateCMakeCommand();
@@ -225,30 +392,141 @@ QString CommandGenerator::generateBuildCommand() const
     
     QString command = "#!/bin/bash\n\n";
     
-    // Git pull if needed
-    if (!m_config.skipGitPull()) {
+    // Git pull if needed, into a sparse checkout when the tool manages it
+    if (m_config.sparseCheckout()) {
+        command += SourceCheckout(m_config).generateCommands();
+    } else if (!m_config.skipGitPull()) {
+        command += stageMarker("git-pull");
         command += "cd " + m_config.llvmDir() + "\n";
-        command += "/usr/bin/time -h git pull\n\n";
+        command += SourcePrefetcher::updateCommand(m_config) + "\n";
+    }
+    
+    // A PGO pipeline builds its training stages, then the final stage like any build
+    if (m_config.pgoPipeline()) {
+        PgoPipeline pipeline(m_config, m_plan);
+        CommandGenerator finalStage(pipeline.finalConfig(), m_plan);
+        finalStage.setExtraDefines(pipeline.finalDefines());
+        return command + pipeline.generateTrainingStages() + finalStage.generateBuildSteps(configure);
     }
     
+    return command + generateBuildSteps(configure);
+}
+
+QString CommandGenerator::generateBuildSteps(const ConfigurePlan &configure) const
+{
+    QString command;
+    
     // Change to build directory
     command += "cd " + m_config.buildDir() + "\n\n";
     
     // Clean build directory if needed
     if (m_config.cleanBuildDir()) {
+        command += stageMarker("clean");
         command += "rm -rf " + m_config.buildDir() + "/*\n\n";
     }
     
-    // CMake configuration
-    command += generateCMakeCommand() + "\n\n";
+    // Compiler cache location, size and fresh counters
+    if (CompilerCache::isEnabled(m_config)) {
+        command += CompilerCache::setupCommands(m_config, true) + "\n";
+    }
+    
+    // CMake configuration; ninja still re-runs CMake on its own when a
+    // CMakeLists.txt changes, so an unchanged cache needs no configure step
+    if (configure.mode == ConfigurePlan::Skip) {
+        command += "# CMake configuration skipped: " + configure.reason + "\n\n";
+    } else {
+        command += stageMarker("configure");
+        command += configure.mode == ConfigurePlan::Changed ? generateReconfigureCommand(configure)
+                                                            : generateCMakeCommand(configure.seedFile);
+        
+        // The arguments count as applied only once CMake accepted them
+        if (configure.recordState) {
+            command += " && mv -f \"" + CMakeState::pendingPath(m_config.buildDir()) + "\" \"" +
+                       CMakeState::defaultPath(m_config.buildDir()) + "\"";
+        }
+        command += "\n\n";
+    }
     
-    // Build
+    // Build, with the install and tests of pipelined components inside it
+    StagePipeline pipeline(m_config, m_plan);
+    command += stageMarker("build");
+    command += pipeline.prepareCommands();
     command += "printf \"STARTING COMPILE WITH CLANG IN DIR=" + m_config.compilerPath() + "\\n\" >> " + m_config.timerFile() + "\n";
-    command += "/usr/bin/time -a -o " + m_config.timerFile() + " " + generateBuildExecutionCommand() + "\n";
+    command += pipeline.environment() + "/usr/bin/time -a -o " + m_config.timerFile() + " " + pipelinedBuildCommand() +
+               " && " + recordRevisionCommand() + "\n";
+    command += "build_status=$?\n";
     command += "printf \"DONE\\n\" >> " + m_config.timerFile() + "\n\n";
     
+    // Cache counters for the build report
+    if (CompilerCache::isEnabled(m_config)) {
+        command += CompilerCache::statsCommand(m_config) + "\n";
+    }
+    
+    // A failed build, including edges killed for lack of memory, ends the
+    // script here; the executor retries those edges with a resume script
+    // that carries on with the stages below
+    command += "[ $build_status -eq 0 ] || exit $build_status\n\n";
+    
+    // Fetch the next build's sources while the install and tests run
+    if (m_config.prefetchSources() && (m_config.doInstall() || m_config.doTesting())) {
+        command += SourcePrefetcher::backgroundCommand(m_config) + "\n";
+    }
+    
+    // Post-link optimization of clang and lld before they are installed
+    if (boltOptimizes()) {
+        command += BoltStage(m_config, m_plan).generateCommands() + "\n";
+    }
+    
+    // The lit suites of the tested projects, against the binaries to be installed
+    if (m_config.doTesting()) {
+        command += LitTestRunner(m_config, m_plan).generateCommands() + "\n";
+    }
+    
     // Install if needed
     if (m_config.doInstall()) {
+        command += stageMarker("install");
+        command += generateInstallCommand() + "\n";
+    }
+    
+    return command;
+}
+
+QString CommandGenerator::generateResumeCommand(const QStringList &targets, int reducedJobs) const
+{
+    QString command = "#!/bin/bash\n\n";
+    command += "cd " + m_config.buildDir() + " || exit 1\n\n";
+    
+    // Keep using the same cache, and its counters from the interrupted run
+    if (CompilerCache::isEnabled(m_config)) {
+        command += CompilerCache::setupCommands(m_config, false) + "\n";
+    }
+    
+    // The edges that ran out of memory, with fewer jobs beside them
+    command += stageMarker("retry");
+    command += "ninja -j" + QString::number(reducedJobs);
+    for (const QString &target : targets) {
+        command += " '" + QString(target).replace("'", "'\\''") + "'";
+    }
+    command += " || exit $?\n\n";
+    
+    // Everything else at full parallelism
+    StagePipeline pipeline(m_config, m_plan);
+    command += stageMarker("build");
+    command += pipeline.prepareCommands();
+    command += pipeline.environment() + pipelinedBuildCommand() + " || exit $?\n";
+    command += recordRevisionCommand() + "\n\n";
+    if (CompilerCache::isEnabled(m_config)) {
+        command += CompilerCache::statsCommand(m_config) + "\n";
+    }
+    if (boltOptimizes()) {
+        command += BoltStage(m_config, m_plan).generateCommands();
+    }
+    if (m_config.doTesting()) {
+        command += LitTestRunner(m_config, m_plan).generateCommands();
+    }
+    
+    if (m_config.doInstall()) {
+        command += stageMarker("install");
         command += generateInstallCommand() + "\n";
     }
     
@@ -259,3 +537,13 @@ QString CommandGenerator::generateFullScript() const
 {
     return generateBuildCommand();
 }
+
+QString CommandGenerator::stagePrefix()
+{
+    return "[stage] ";
+}
+
+QString CommandGenerator::stageMarker(const QString &stage)
+{
+    return "echo \"" + stagePrefix() + stage + "\"\n";
+}
@@ -2,18 +2,53 @@
 #define COMMANDGENERATOR_H
 
 #include "builderconfiguration.h"
+#include "resourceplanner.h"
 #include <QString>
+#include <QStringList>
+#include <QVector>
+
+struct ConfigurePlan;
+
+// One -D cache entry of the CMake command line
+struct CMakeDefine
+{
+    QString name;
+    QString value;
+    bool hostDerived = false;   // Sized from the build host rather than configured
+};
 
 class CommandGenerator
 {
 public:
+    // Plans the job counts for this host, or takes those of the build
     CommandGenerator(const BuilderConfiguration &config);
+    CommandGenerator(const BuilderConfiguration &config, const ResourcePlan &plan);
+    
+    // Cache entries to add to, or replace in, the generated CMake arguments
+    void setExtraDefines(const QVector<CMakeDefine> &defines);
     
     // Generate the full build command
     QString generateBuildCommand() const;
     
-    // Generate just the CMake configuration command
-    QString generateCMakeCommand() const;
+    // Generate the full build command with the configure step run as planned
+    QString generateBuildCommand(const ConfigurePlan &configure) const;
+    
+    // Generate the steps from entering the build directory to the install,
+    // without the script header and the git pull
+    QString generateBuildSteps(const ConfigurePlan &configure) const;
+    
+    // Generate just the CMake configuration command, optionally preloading
+    // the cache from an initial cache file (-C)
+    QString generateCMakeCommand(const QString &initialCache = QString()) const;
+    
+    // Generate a configure of an existing build directory that passes only
+    // the changed and removed cache entries
+    QString generateReconfigureCommand(const ConfigurePlan &configure) const;
+    
+    // The cache entries, generator and source directory of the CMake command
+    QVector<CMakeDefine> cmakeDefines() const;
+    QString cmakeGenerator() const;
+    QString cmakeSourceDir() const;
     
     // Generate the build execution command (ninja or make)
     QString generateBuildExecutionCommand() const;
@@ -21,11 +56,45 @@ public:
     // Generate the install command
     QString generateInstallCommand() const;
     
+    // LLVM_ENABLE_PROJECTS, with anything the enabled stages need
+    QString projects() const;
+    
+    // Generate a script that resumes an interrupted ninja build in place:
+    // the given targets at reducedJobs, then the rest of the build and the
+    // install at full parallelism
+    QString generateResumeCommand(const QStringList &targets, int reducedJobs) const;
+    
     // Generate the full script that would be equivalent to buildersalone.sh
     QString generateFullScript() const;
     
+    // Prefix of the lines the build script prints when a stage begins
+    static QString stagePrefix();
+    
+    // Generate the line that announces a stage of the build script
+    static QString stageMarker(const QString &stage);
+    
 private:
+    // -j and -l arguments for make and ninja install
+    static QString jobFlags(const ResourcePlan &plan);
+    
+    // -DNAME="value"
+    static QString defineArgument(const CMakeDefine &define);
+    
+    // The build execution command plus the targets of a stage pipeline
+    QString pipelinedBuildCommand() const;
+    
+    // Whether the build is limited to the distribution components
+    bool buildsDistribution() const;
+    
+    // Whether the BOLT stage runs: configured, and supported by the host
+    bool boltOptimizes() const;
+    
+    // Note the source revision after a successful build, for the rebuild forecast
+    QString recordRevisionCommand() const;
+    
     const BuilderConfiguration &m_config;
+    ResourcePlan m_plan;
+    QVector<CMakeDefine> m_extraDefines;
 };
 
 #endif // COMMANDGENERATOR_H
@@ -0,0 +1,433 @@
+#include "compilerbenchmark.h"
+#include "builddirpool.h"
+#include "rebuildforecast.h"
+#include "statistics.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QStandardPaths>
+
+#include <vector>
+
+#if defined(Q_OS_UNIX)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#if defined(Q_OS_LINUX)
+#include <sched.h>
+#endif
+
+namespace {
+
+// Without a corpus of its own, the benchmark compiles the sources built
+// into the application, which need nothing but the C and C++ standard
+// libraries and stay the same from one LLVM revision to the next
+const char *const BuiltinCorpus = ":/benchmarkcorpus";
+
+// Source files a corpus directory contributes
+const QStringList CorpusPatterns{"*.c", "*.cpp", "*.cc", "*.cxx"};
+
+// Significance level of the comparisons
+const double SignificanceLevel = 0.05;
+
+bool isCSource(const QString &path)
+{
+    return path.endsWith(".c");
+}
+
+// Copy the built-in corpus where the compilers can read it, rewriting only
+// files that differ so their timestamps and page cache stay put; returns
+// the directory, or an empty string when it cannot be written
+QString extractBuiltinCorpus()
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/benchmark-corpus");
+    if (!dir.mkpath(".")) {
+        return QString();
+    }
+
+    QStringList names;
+    QDirIterator it(BuiltinCorpus, CorpusPatterns, QDir::Files);
+    while (it.hasNext()) {
+        QFile resource(it.next());
+        names.append(it.fileName());
+        QFile file(dir.filePath(it.fileName()));
+        if (!resource.open(QIODevice::ReadOnly)) {
+            return QString();
+        }
+        QByteArray contents = resource.readAll();
+        if (file.open(QIODevice::ReadOnly) && file.readAll() == contents) {
+            continue;
+        }
+        file.close();
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(contents) != contents.size()) {
+            return QString();
+        }
+    }
+
+    // Files an older version of the corpus had
+    for (const QString &name : dir.entryList(CorpusPatterns, QDir::Files)) {
+        if (!names.contains(name)) {
+            dir.remove(name);
+        }
+    }
+    return dir.absolutePath();
+}
+
+QVector<double> metricValues(const QVector<BenchmarkSample> &samples, double BenchmarkSample::*metric)
+{
+    QVector<double> values;
+    for (const BenchmarkSample &sample : samples) {
+        values.append(sample.*metric);
+    }
+    return values;
+}
+
+QJsonArray samplesToJson(const QVector<BenchmarkSample> &samples)
+{
+    QJsonArray array;
+    for (const BenchmarkSample &sample : samples) {
+        QJsonObject json;
+        json["wallSeconds"] = sample.wallSeconds;
+        json["userSeconds"] = sample.userSeconds;
+        json["maxRssMB"] = sample.maxRssMB;
+        array.append(json);
+    }
+    return array;
+}
+
+} // namespace
+
+double BenchmarkComparison::baselineMean() const
+{
+    return Statistics::mean(baseline);
+}
+
+double BenchmarkComparison::candidateMean() const
+{
+    return Statistics::mean(candidate);
+}
+
+double BenchmarkComparison::changePercent() const
+{
+    double base = baselineMean();
+    return base > 0.0 ? (candidateMean() - base) / base * 100.0 : 0.0;
+}
+
+double BenchmarkComparison::pValue() const
+{
+    return Statistics::welchPValue(baseline, candidate);
+}
+
+bool BenchmarkComparison::isSignificant() const
+{
+    return pValue() < SignificanceLevel;
+}
+
+QString BenchmarkComparison::summary() const
+{
+    return QString("%1: %2 ± %3 %4 -> %5 ± %6 %4 (%7%8%, p = %9%10)")
+        .arg(metric)
+        .arg(baselineMean(), 0, 'f', 2)
+        .arg(Statistics::standardDeviation(baseline), 0, 'f', 2)
+        .arg(unit)
+        .arg(candidateMean(), 0, 'f', 2)
+        .arg(Statistics::standardDeviation(candidate), 0, 'f', 2)
+        .arg(changePercent() >= 0 ? "+" : "")
+        .arg(changePercent(), 0, 'f', 1)
+        .arg(pValue(), 0, 'g', 2)
+        .arg(isSignificant() ? ", significant" : "");
+}
+
+QVector<BenchmarkComparison> BenchmarkResult::comparisons() const
+{
+    QVector<BenchmarkComparison> result;
+    result.append({"Wall time", "s", metricValues(baseline, &BenchmarkSample::wallSeconds),
+                   metricValues(candidate, &BenchmarkSample::wallSeconds)});
+    result.append({"User time", "s", metricValues(baseline, &BenchmarkSample::userSeconds),
+                   metricValues(candidate, &BenchmarkSample::userSeconds)});
+    result.append({"Max RSS", "MB", metricValues(baseline, &BenchmarkSample::maxRssMB),
+                   metricValues(candidate, &BenchmarkSample::maxRssMB)});
+    return result;
+}
+
+QJsonObject BenchmarkResult::toJson() const
+{
+    QJsonObject json;
+    json["revision"] = revision;
+    json["configuration"] = configuration;
+    json["description"] = description;
+    json["baselineCompiler"] = baselineCompiler;
+    json["candidateCompiler"] = candidateCompiler;
+    json["corpus"] = QJsonArray::fromStringList(corpus);
+    json["cpu"] = cpu;
+    json["timestampMs"] = timestampMs;
+    json["baseline"] = samplesToJson(baseline);
+    json["candidate"] = samplesToJson(candidate);
+
+    QJsonArray comparisonArray;
+    for (const BenchmarkComparison &comparison : comparisons()) {
+        QJsonObject entry;
+        entry["metric"] = comparison.metric;
+        entry["changePercent"] = comparison.changePercent();
+        entry["pValue"] = comparison.pValue();
+        entry["significant"] = comparison.isSignificant();
+        comparisonArray.append(entry);
+    }
+    json["comparisons"] = comparisonArray;
+    return json;
+}
+
+bool BenchmarkResult::saveToHistory() const
+{
+    QString path = CompilerBenchmark::historyPath(revision);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+
+    // Keep the results of the revision's other configurations
+    QJsonArray results;
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly)) {
+        const QJsonArray existing = QJsonDocument::fromJson(file.readAll()).object().value("results").toArray();
+        for (const QJsonValue &value : existing) {
+            if (value.toObject()["configuration"].toString() != configuration) {
+                results.append(value);
+            }
+        }
+        file.close();
+    }
+    results.append(toJson());
+
+    QJsonObject json;
+    json["revision"] = revision;
+    json["results"] = results;
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(json).toJson());
+    return true;
+}
+
+CompilerBenchmark::CompilerBenchmark(const BuilderConfiguration &config)
+    : m_config(config)
+{
+}
+
+BenchmarkResult CompilerBenchmark::run(const std::atomic<bool> &cancelled,
+                                       const std::function<void(const QString &)> &progress) const
+{
+    BenchmarkResult result;
+    result.configuration = BuildDirPool::configHash(m_config);
+    result.description = BuildDirPool::describe(m_config);
+    result.baselineCompiler = baselineCompiler();
+    result.candidateCompiler = candidateCompiler();
+    result.corpus = corpus();
+    result.cpu = pinnedCpu();
+    result.timestampMs = QDateTime::currentMSecsSinceEpoch();
+
+    QFile revisionFile(RebuildForecaster::revisionPath(m_config.buildDir()));
+    if (revisionFile.open(QIODevice::ReadOnly)) {
+        result.revision = QString::fromLatin1(revisionFile.readAll().trimmed());
+    }
+    if (result.revision.isEmpty()) {
+        result.revision = "unknown";
+    }
+
+    if (result.corpus.isEmpty()) {
+        result.error = "The benchmark corpus has no C or C++ sources";
+        return result;
+    }
+
+    // An untimed pass warms the page cache and catches a broken corpus early
+    BenchmarkSample warmup;
+    if (!compileCorpus(result.baselineCompiler, result.cpu, warmup, result.error) ||
+        !compileCorpus(result.candidateCompiler, result.cpu, warmup, result.error)) {
+        return result;
+    }
+
+    // Alternate which compiler goes first, so drift in the machine's state
+    // affects both alike
+    int runs = qMax(2, m_config.abBenchmarkRuns());
+    for (int run = 0; run < runs; ++run) {
+        if (cancelled) {
+            result.error = "Benchmark cancelled";
+            return result;
+        }
+
+        BenchmarkSample baselineSample;
+        BenchmarkSample candidateSample;
+        bool ok = run % 2 == 0
+                      ? compileCorpus(result.baselineCompiler, result.cpu, baselineSample, result.error) &&
+                            compileCorpus(result.candidateCompiler, result.cpu, candidateSample, result.error)
+                      : compileCorpus(result.candidateCompiler, result.cpu, candidateSample, result.error) &&
+                            compileCorpus(result.baselineCompiler, result.cpu, baselineSample, result.error);
+        if (!ok) {
+            return result;
+        }
+        result.baseline.append(baselineSample);
+        result.candidate.append(candidateSample);
+
+        progress(QString("Benchmark run %1/%2: baseline %3 s, new compiler %4 s")
+                     .arg(run + 1)
+                     .arg(runs)
+                     .arg(baselineSample.wallSeconds, 0, 'f', 2)
+                     .arg(candidateSample.wallSeconds, 0, 'f', 2));
+    }
+    return result;
+}
+
+QStringList CompilerBenchmark::corpus() const
+{
+    QStringList files;
+    QString directory = m_config.benchmarkCorpus().isEmpty() ? extractBuiltinCorpus() : m_config.benchmarkCorpus();
+    if (directory.isEmpty()) {
+        return files;
+    }
+
+    QDirIterator it(directory, CorpusPatterns, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+    files.sort();
+    return files;
+}
+
+QString CompilerBenchmark::historyPath(const QString &revision)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/compiler-benchmarks/" + revision +
+           ".json";
+}
+
+QString CompilerBenchmark::baselineCompiler() const
+{
+    return m_config.compilerPath() + "/bin";
+}
+
+QString CompilerBenchmark::candidateCompiler() const
+{
+    return m_config.buildDir() + "/bin";
+}
+
+QStringList CompilerBenchmark::compileArguments(const QString &file) const
+{
+    // Keep cc1 in the driver's process, so its time and memory are measured
+    QStringList arguments{"-fintegrated-cc1", "-O2", "-w", "-c", "-o", "/dev/null"};
+    if (m_config.benchmarkCorpus().isEmpty() && !isCSource(file)) {
+        arguments << "-std=c++17";
+    }
+    arguments += QProcess::splitCommand(m_config.benchmarkCorpusFlags());
+    return arguments;
+}
+
+bool CompilerBenchmark::compileCorpus(const QString &compiler, int cpu, BenchmarkSample &sample, QString &error) const
+{
+    sample = BenchmarkSample();
+    const QStringList files = corpus();
+    for (const QString &file : files) {
+        QString driver = compiler + (isCSource(file) ? "/clang" : "/clang++");
+        BenchmarkSample compile;
+        if (!runMeasured(QStringList() << driver << compileArguments(file) << file, cpu, compile)) {
+            error = QString("%1 failed to compile %2").arg(driver, file);
+            return false;
+        }
+        sample.wallSeconds += compile.wallSeconds;
+        sample.userSeconds += compile.userSeconds;
+        sample.maxRssMB = qMax(sample.maxRssMB, compile.maxRssMB);
+    }
+    return true;
+}
+
+bool CompilerBenchmark::runMeasured(const QStringList &arguments, int cpu, BenchmarkSample &sample)
+{
+#if defined(Q_OS_UNIX)
+    // Everything the child needs is prepared before the fork
+    std::vector<QByteArray> storage;
+    for (const QString &argument : arguments) {
+        storage.push_back(argument.toLocal8Bit());
+    }
+    std::vector<char *> argv;
+    for (QByteArray &argument : storage) {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    int devNull = ::open("/dev/null", O_WRONLY);
+    QElapsedTimer timer;
+    timer.start();
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+#if defined(Q_OS_LINUX)
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            sched_setaffinity(0, sizeof(set), &set);
+        }
+#else
+        Q_UNUSED(cpu);
+#endif
+        if (devNull >= 0) {
+            ::dup2(devNull, STDOUT_FILENO);
+            ::dup2(devNull, STDERR_FILENO);
+        }
+        ::execv(argv[0], argv.data());
+        ::_exit(127);
+    }
+    if (devNull >= 0) {
+        ::close(devNull);
+    }
+    if (pid < 0) {
+        return false;
+    }
+
+    int status = 0;
+    struct rusage usage;
+    while (::wait4(pid, &status, 0, &usage) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+
+    sample.wallSeconds = timer.nsecsElapsed() / 1e9;
+    sample.userSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6;
+#if defined(Q_OS_MACOS)
+    sample.maxRssMB = usage.ru_maxrss / (1024.0 * 1024.0);   // Bytes
+#else
+    sample.maxRssMB = usage.ru_maxrss / 1024.0;              // Kilobytes
+#endif
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+    Q_UNUSED(arguments);
+    Q_UNUSED(cpu);
+    Q_UNUSED(sample);
+    return false;
+#endif
+}
+
+int CompilerBenchmark::pinnedCpu()
+{
+    // The highest CPU this process may use; macOS has no way to pin a process
+#if defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = CPU_SETSIZE - 1; cpu >= 0; --cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                return cpu;
+            }
+        }
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,105 @@
+#ifndef COMPILERBENCHMARK_H
+#define COMPILERBENCHMARK_H
+
+#include "builderconfiguration.h"
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+// One pass of a compiler over the benchmark corpus
+struct BenchmarkSample
+{
+    double wallSeconds = 0.0;   // Sum over the corpus files
+    double userSeconds = 0.0;
+    double maxRssMB = 0.0;      // Largest of any single compile
+};
+
+// One metric of the baseline and the candidate compiler side by side
+struct BenchmarkComparison
+{
+    QString metric;
+    QString unit;
+    QVector<double> baseline;
+    QVector<double> candidate;
+
+    double baselineMean() const;
+    double candidateMean() const;
+
+    // Change of the candidate against the baseline, in percent
+    double changePercent() const;
+
+    // Welch's t-test of the two samples
+    double pValue() const;
+    bool isSignificant() const;
+
+    QString summary() const;
+};
+
+// An A/B comparison of the built compiler against the baseline compiler
+struct BenchmarkResult
+{
+    QString revision;           // Source revision of the candidate
+    QString configuration;      // Build directory pool hash of the configuration
+    QString description;
+    QString baselineCompiler;
+    QString candidateCompiler;
+    QStringList corpus;
+    int cpu = -1;               // CPU the compiles were pinned to, -1 for none
+    qint64 timestampMs = 0;
+    QVector<BenchmarkSample> baseline;
+    QVector<BenchmarkSample> candidate;
+    QString error;              // Set when the benchmark could not complete
+
+    QVector<BenchmarkComparison> comparisons() const;
+
+    QJsonObject toJson() const;
+
+    // Add the result to the file of its revision, replacing an earlier one
+    // of the same configuration
+    bool saveToHistory() const;
+};
+
+// Compiles a fixed corpus with the baseline compiler in compilerPath and
+// the newly built one, alternating between them over repeated runs, each
+// compile pinned to one CPU where the host allows it
+class CompilerBenchmark
+{
+public:
+    explicit CompilerBenchmark(const BuilderConfiguration &config);
+
+    // Run the benchmark; progress lines are passed to the callback, which is
+    // called on the benchmark's thread
+    BenchmarkResult run(const std::atomic<bool> &cancelled,
+                        const std::function<void(const QString &)> &progress) const;
+
+    // Source files of the corpus, in compile order
+    QStringList corpus() const;
+
+    // Results of a revision, one per configuration
+    static QString historyPath(const QString &revision);
+
+private:
+    BuilderConfiguration m_config;
+
+    // Compiler directories, and the arguments a corpus file is compiled with
+    QString baselineCompiler() const;
+    QString candidateCompiler() const;
+    QStringList compileArguments(const QString &file) const;
+
+    // Compile the whole corpus once, adding up the measurements
+    bool compileCorpus(const QString &compiler, int cpu, BenchmarkSample &sample, QString &error) const;
+
+    // Run a process to completion, measuring its wall and user time and peak
+    // memory; returns false when it could not be run or did not succeed
+    static bool runMeasured(const QStringList &arguments, int cpu, BenchmarkSample &sample);
+
+    // The CPU to pin compiles to, -1 when pinning is unavailable
+    static int pinnedCpu();
+};
+
+#endif // COMPILERBENCHMARK_H
@@ -0,0 +1,150 @@
+#include "compilercache.h"
+#include "builderconfiguration.h"
+
+#include <QDir>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+
+namespace {
+
+// ccache --print-stats counters for compilations that cannot be cached
+const char *const CcacheUncacheableKeys[] = {
+    "autoconf_test",
+    "bad_compiler_arguments",
+    "bad_input_file",
+    "bad_output_file",
+    "called_for_link",
+    "called_for_preprocessing",
+    "compiler_check_failed",
+    "compiler_produced_empty_output",
+    "compiler_produced_no_output",
+    "compiler_produced_stdout",
+    "could_not_find_compiler",
+    "could_not_use_modules",
+    "could_not_use_precompiled_header",
+    "multiple_source_files",
+    "no_input_file",
+    "output_to_stdout",
+    "preprocessor_error",
+    "unsupported_code_directive",
+    "unsupported_compiler_option",
+    "unsupported_environment_variable",
+    "unsupported_source_encoding",
+    "unsupported_source_language",
+};
+
+// Sum the per-language counts of an sccache counter
+int sumCounts(const QJsonObject &counter)
+{
+    int total = 0;
+    const QJsonObject counts = counter["counts"].toObject();
+    for (auto it = counts.constBegin(); it != counts.constEnd(); ++it) {
+        total += it.value().toInt();
+    }
+    return total;
+}
+
+} // namespace
+
+bool CompilerCache::isEnabled(const BuilderConfiguration &config)
+{
+    return config.compilerCache() == "ccache" || config.compilerCache() == "sccache";
+}
+
+QString CompilerCache::launcher(const BuilderConfiguration &config)
+{
+    QString program = QStandardPaths::findExecutable(config.compilerCache());
+    return program.isEmpty() ? config.compilerCache() : program;
+}
+
+QString CompilerCache::setupCommands(const BuilderConfiguration &config, bool resetStats)
+{
+    QString size = QString::number(config.cacheSize()) + "G";
+    QString commands;
+
+    if (config.compilerCache() == "ccache") {
+        if (!config.cacheDir().isEmpty()) {
+            commands += "export CCACHE_DIR=\"" + config.cacheDir() + "\"\n";
+        }
+        // Paths under the source tree hash the same from any build directory
+        commands += "export CCACHE_BASEDIR=\"" + config.llvmDir() + "\"\n";
+        commands += "export CCACHE_MAXSIZE=\"" + size + "\"\n";
+        if (resetStats) {
+            commands += "ccache --zero-stats > /dev/null\n";
+        }
+    } else if (config.compilerCache() == "sccache") {
+        if (!config.cacheDir().isEmpty()) {
+            commands += "export SCCACHE_DIR=\"" + config.cacheDir() + "\"\n";
+        }
+        commands += "export SCCACHE_CACHE_SIZE=\"" + size + "\"\n";
+        // The server reads its settings at startup and keeps the counters,
+        // so it is only restarted for a new build
+        if (resetStats) {
+            commands += "sccache --stop-server > /dev/null 2>&1\n";
+            commands += "sccache --start-server > /dev/null\n";
+            commands += "sccache --zero-stats > /dev/null\n";
+        }
+    }
+
+    return commands;
+}
+
+QString CompilerCache::statsCommand(const BuilderConfiguration &config)
+{
+    QString path = "\"" + statsPath(config.buildDir()) + "\"";
+    if (config.compilerCache() == "ccache") {
+        return "ccache --print-stats > " + path + "\n";
+    }
+    if (config.compilerCache() == "sccache") {
+        return "sccache --show-stats --stats-format=json > " + path + "\n";
+    }
+    return QString();
+}
+
+QString CompilerCache::statsPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".llvmbuilder_cache_stats");
+}
+
+CacheStats CompilerCache::parseStats(const QString &tool, const QByteArray &data)
+{
+    CacheStats stats;
+
+    if (tool == "ccache") {
+        // One "key<TAB>value" pair per line
+        QHash<QByteArray, int> counters;
+        const QList<QByteArray> lines = data.split('\n');
+        for (const QByteArray &line : lines) {
+            int tab = line.indexOf('\t');
+            if (tab > 0) {
+                counters.insert(line.left(tab), line.mid(tab + 1).trimmed().toInt());
+            }
+        }
+        if (counters.isEmpty()) {
+            return stats;
+        }
+
+        stats.tool = tool;
+        stats.hits = counters.value("direct_cache_hit") + counters.value("preprocessed_cache_hit");
+        stats.misses = counters.value("cache_miss");
+        for (const char *key : CcacheUncacheableKeys) {
+            stats.uncacheable += counters.value(key);
+        }
+    } else if (tool == "sccache") {
+        QJsonDocument doc = QJsonDocument::fromJson(data);
+        QJsonObject counters = doc.object()["stats"].toObject();
+        if (counters.isEmpty()) {
+            return stats;
+        }
+
+        stats.tool = tool;
+        stats.hits = sumCounts(counters["cache_hits"].toObject());
+        stats.misses = sumCounts(counters["cache_misses"].toObject());
+        stats.uncacheable = counters["requests_not_cacheable"].toInt() +
+                            counters["requests_unsupported_compiler"].toInt();
+    }
+
+    return stats;
+}
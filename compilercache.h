@@ -0,0 +1,37 @@
+#ifndef COMPILERCACHE_H
+#define COMPILERCACHE_H
+
+#include "buildreport.h"
+
+#include <QByteArray>
+#include <QString>
+
+class BuilderConfiguration;
+
+// ccache/sccache support: the compiler launcher for CMake, the shell
+// commands that set up the cache around a build, and parsing of the
+// statistics the build script leaves in the build directory.
+class CompilerCache
+{
+public:
+    // Whether the configuration uses a compiler cache
+    static bool isEnabled(const BuilderConfiguration &config);
+
+    // Program to pass as CMAKE_<LANG>_COMPILER_LAUNCHER
+    static QString launcher(const BuilderConfiguration &config);
+
+    // Script lines that point the cache at its directory and size budget,
+    // optionally resetting its counters for a new build
+    static QString setupCommands(const BuilderConfiguration &config, bool resetStats);
+
+    // Script line that writes the cache counters to statsPath()
+    static QString statsCommand(const BuilderConfiguration &config);
+
+    // Where the build script leaves the cache counters
+    static QString statsPath(const QString &buildDir);
+
+    // Parse the output of statsCommand() for the given tool
+    static CacheStats parseStats(const QString &tool, const QByteArray &data);
+};
+
+#endif // COMPILERCACHE_H
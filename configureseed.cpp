@@ -0,0 +1,192 @@
+#include "configureseed.h"
+#include "commandgenerator.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QStandardPaths>
+#include <QTextStream>
+
+namespace {
+
+// Cache entries that end up on the compile or link command lines CMake's
+// probes run with, besides the compilers and the SDK
+const char *const CommandLineDefines[] = {
+    "CMAKE_BUILD_TYPE",          // Selects the CMAKE_*_FLAGS_<CONFIG> in use
+    "CMAKE_OSX_ARCHITECTURES",
+    "CMAKE_CXX_STANDARD",
+    "LLVM_USE_LINKER",
+    "LD64_EXECUTABLE",
+    "LLVM_ENABLE_LIBCXX",
+    "LLVM_ENABLE_LTO",
+    "LLVM_ENABLE_MODULES",
+    "LLVM_BUILD_INSTRUMENTED",
+    "LLVM_BUILD_INSTRUMENTED_COVERAGE",
+    "LLVM_PROFDATA_FILE",
+    "LLVM_ENABLE_IR_PGO",
+    "LLVM_USE_SANITIZER",
+};
+
+// Whether a cache entry changes the command lines of the probes
+bool affectsCommandLines(const CMakeDefine &define)
+{
+    if (define.hostDerived) {
+        return false;
+    }
+    // CMAKE_C_FLAGS, CMAKE_CXX_FLAGS_RELEASE, CMAKE_EXE_LINKER_FLAGS and the like
+    if (define.name.startsWith("CMAKE_") && define.name.contains("_FLAGS")) {
+        return true;
+    }
+    for (const char *name : CommandLineDefines) {
+        if (define.name == QLatin1String(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Value of a cache entry in the generator's command line
+QString defineValue(const QVector<CMakeDefine> &defines, const QString &name)
+{
+    for (const CMakeDefine &define : defines) {
+        if (define.name == name) {
+            return define.value;
+        }
+    }
+    return QString();
+}
+
+// Quote a value for a CMake set() command
+QString cmakeQuoted(QString value)
+{
+    value.replace("\\", "\\\\").replace("\"", "\\\"").replace("$", "\\$");
+    return "\"" + value + "\"";
+}
+
+} // namespace
+
+QString ConfigureSeed::toolchainKey(const CommandGenerator &generator)
+{
+    const QVector<CMakeDefine> defines = generator.cmakeDefines();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // The binaries themselves, so a rebuilt compiler at the same path is a new toolchain
+    QStringList compilers;
+    for (const QString &name : {QString("CMAKE_C_COMPILER"), QString("CMAKE_CXX_COMPILER")}) {
+        QString path = QFileInfo(defineValue(defines, name)).canonicalFilePath();
+        if (path.isEmpty()) {
+            return QString();
+        }
+        if (!compilers.contains(path)) {
+            compilers.append(path);
+        }
+    }
+    for (const QString &path : compilers) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file)) {
+            return QString();
+        }
+    }
+
+    // The SDK's versioned directory name and its settings identify the SDK
+    QString sysroot = defineValue(defines, "DEFAULT_SYSROOT");
+    QString sdk = QFileInfo(sysroot).canonicalFilePath();
+    hash.addData((sdk.isEmpty() ? sysroot : sdk).toUtf8() + '\n');
+    QFile settings(QDir(sysroot).filePath("SDKSettings.json"));
+    if (settings.open(QIODevice::ReadOnly)) {
+        hash.addData(settings.readAll());
+    }
+
+    // Flags, linker, LTO and instrumentation, sorted so the key does not
+    // depend on the order the generator emits them in
+    QMap<QString, QString> options;
+    for (const CMakeDefine &define : defines) {
+        if (affectsCommandLines(define)) {
+            options.insert(define.name, define.value);
+        }
+    }
+    for (auto it = options.constBegin(); it != options.constEnd(); ++it) {
+        hash.addData((it.key() + '=' + it.value() + '\n').toUtf8());
+    }
+    return QString::fromLatin1(hash.result().toHex().left(16));
+}
+
+QString ConfigureSeed::seedPath(const QString &key)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/configure-seeds/" + key + ".cmake";
+}
+
+int ConfigureSeed::harvest(const QString &cacheFile, const QString &seedFile, const QString &description)
+{
+    QFile cache(cacheFile);
+    if (!cache.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    // NAME:TYPE=VALUE, sorted so the seed file is stable between harvests
+    QMap<QString, QString> results;
+    QTextStream in(&cache);
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith("//")) {
+            continue;
+        }
+        int colon = line.indexOf(':');
+        int equals = line.indexOf('=', colon + 1);
+        if (colon <= 0 || equals < 0) {
+            continue;
+        }
+        QString name = line.left(colon);
+        QString type = line.mid(colon + 1, equals - colon - 1);
+        if (isProbeResult(name, type)) {
+            results.insert(name, line.mid(equals + 1));
+        }
+    }
+
+    if (!QDir().mkpath(QFileInfo(seedFile).absolutePath())) {
+        return -1;
+    }
+    QFile seed(seedFile);
+    if (!seed.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return -1;
+    }
+
+    // A failed check is cached as an empty value, which CMake also skips
+    QTextStream out(&seed);
+    out << "# Configure check results for " << description << "\n";
+    out << "# Harvested from " << cacheFile << "\n\n";
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        out << "set(" << it.key() << " " << cmakeQuoted(it.value()) << " CACHE INTERNAL \"\")\n";
+    }
+    return results.size();
+}
+
+int ConfigureSeed::entryCount(const QString &seedFile)
+{
+    QFile seed(seedFile);
+    if (!seed.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return 0;
+    }
+
+    int count = 0;
+    QTextStream in(&seed);
+    while (!in.atEnd()) {
+        if (in.readLine().startsWith("set(")) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool ConfigureSeed::isProbeResult(const QString &name, const QString &type)
+{
+    // check_include_file, check_symbol_exists, check_c_source_compiles and
+    // friends cache HAVE_*; flag and feature checks use *_SUPPORTS_* and *_HAS_*
+    if (type != "INTERNAL") {
+        return false;
+    }
+    return name.startsWith("HAVE_") || name.startsWith("HAS_") || name.contains("_HAS_") ||
+           name.contains("_SUPPORTS_") || name.startsWith("SUPPORTS_");
+}
@@ -0,0 +1,36 @@
+#ifndef CONFIGURESEED_H
+#define CONFIGURESEED_H
+
+#include <QString>
+
+class CommandGenerator;
+
+// Results of CMake's try_compile and check_* probes for one toolchain,
+// harvested from a configured CMakeCache.txt into an initial cache file.
+// Passing that file with -C to a clean configure makes CMake find the
+// answers already cached and skip the probes.
+class ConfigureSeed
+{
+public:
+    // Key of the toolchain the generator configures with: a hash of the C
+    // and C++ compiler binaries, the SDK, and the configured cache entries
+    // that change compile or link command lines (flags, linker, libc++,
+    // LTO, PGO instrumentation, target architectures). Empty when a
+    // compiler cannot be read.
+    static QString toolchainKey(const CommandGenerator &generator);
+
+    // Seed file of a toolchain key
+    static QString seedPath(const QString &key);
+
+    // Write the probe results found in cacheFile to seedFile; returns the
+    // number of entries written, or -1 when either file cannot be accessed
+    static int harvest(const QString &cacheFile, const QString &seedFile, const QString &description);
+
+    // Number of entries in a seed file, 0 when there is none
+    static int entryCount(const QString &seedFile);
+
+    // Whether a CMakeCache.txt entry holds the outcome of a probe
+    static bool isProbeResult(const QString &name, const QString &type);
+};
+
+#endif // CONFIGURESEED_H
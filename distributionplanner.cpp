@@ -0,0 +1,115 @@
+#include "distributionplanner.h"
+#include "builderconfiguration.h"
+#include "ninjamanifest.h"
+
+#include <QVector>
+
+namespace {
+
+// Number of real (non-phony) edges needed to build the given nodes
+int closureSize(const NinjaManifest &manifest, const QVector<int> &roots)
+{
+    const QVector<NinjaBuildEdge> &edges = manifest.edges();
+    QVector<bool> visited(edges.size(), false);
+    QVector<int> queue;
+    for (int node : roots) {
+        int edge = manifest.producer(node);
+        if (edge >= 0 && !visited.at(edge)) {
+            visited[edge] = true;
+            queue.append(edge);
+        }
+    }
+
+    int count = 0;
+    while (!queue.isEmpty()) {
+        const NinjaBuildEdge &edge = edges.at(queue.takeLast());
+        if (edge.rule != "phony") {
+            ++count;
+        }
+        for (const QVector<int> *inputs : {&edge.inputs, &edge.orderOnly}) {
+            for (int input : *inputs) {
+                int producer = manifest.producer(input);
+                if (producer >= 0 && !visited.at(producer)) {
+                    visited[producer] = true;
+                    queue.append(producer);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+QString DistributionEstimate::summary() const
+{
+    if (!valid) {
+        return "No distribution estimate: " + errorString;
+    }
+    QString text = QString("Distribution build: %1 of %2 edges, about %3 fewer than a full build")
+                       .arg(distributionEdges)
+                       .arg(fullEdges)
+                       .arg(savedEdges());
+    if (!unknownComponents.isEmpty()) {
+        text += " (not yet targets: " + unknownComponents.join(", ") + ")";
+    }
+    return text;
+}
+
+QStringList DistributionPlanner::knownComponents()
+{
+    return QStringList() << "clang" << "clang-resource-headers" << "clangd" << "clang-format" << "clang-tidy"
+                         << "lld" << "lldb" << "liblldb" << "LTO" << "llvm-ar" << "llvm-nm" << "llvm-objcopy"
+                         << "llvm-objdump" << "llvm-strip" << "llvm-symbolizer" << "llvm-profdata" << "llvm-cov"
+                         << "llvm-dwarfdump" << "llvm-config" << "runtimes";
+}
+
+QStringList DistributionPlanner::components(const BuilderConfiguration &config)
+{
+    QStringList result;
+    const QStringList names = config.distributionComponents().split(';', Qt::SkipEmptyParts);
+    for (const QString &name : names) {
+        QString component = name.trimmed();
+        if (!component.isEmpty() && !result.contains(component)) {
+            result.append(component);
+        }
+    }
+    return result;
+}
+
+DistributionEstimate DistributionPlanner::estimate(const QString &buildDir, const QStringList &components)
+{
+    DistributionEstimate estimate;
+    NinjaManifest manifest;
+    if (!manifest.load(NinjaManifest::defaultPath(buildDir))) {
+        estimate.errorString = manifest.errorString();
+        return estimate;
+    }
+
+    // A component is the phony target of the same name
+    QVector<int> roots;
+    for (const QString &component : components) {
+        int node = manifest.find(component.toUtf8());
+        if (node >= 0 && manifest.producer(node) >= 0) {
+            roots.append(node);
+        } else {
+            estimate.unknownComponents.append(component);
+        }
+    }
+    estimate.distributionEdges = closureSize(manifest, roots);
+
+    // "all" is the default target; without it, everything counts
+    int all = manifest.find("all");
+    if (all >= 0 && manifest.producer(all) >= 0) {
+        estimate.fullEdges = closureSize(manifest, QVector<int>() << all);
+    } else {
+        for (const NinjaBuildEdge &edge : manifest.edges()) {
+            if (edge.rule != "phony") {
+                ++estimate.fullEdges;
+            }
+        }
+    }
+
+    estimate.valid = true;
+    return estimate;
+}
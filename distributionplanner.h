@@ -0,0 +1,37 @@
+#ifndef DISTRIBUTIONPLANNER_H
+#define DISTRIBUTIONPLANNER_H
+
+#include <QString>
+#include <QStringList>
+
+class BuilderConfiguration;
+
+// Edges a distribution build runs compared with a full build, counted in
+// the build directory's current build.ninja
+struct DistributionEstimate
+{
+    bool valid = false;
+    QString errorString;
+    int fullEdges = 0;
+    int distributionEdges = 0;
+    QStringList unknownComponents;   // Not a target of the current build.ninja
+
+    int savedEdges() const { return fullEdges - distributionEdges; }
+    QString summary() const;
+};
+
+// Support for building and installing only LLVM_DISTRIBUTION_COMPONENTS
+class DistributionPlanner
+{
+public:
+    // Components the selector offers; any other target name can be added
+    static QStringList knownComponents();
+
+    // The configured components, in order and without duplicates
+    static QStringList components(const BuilderConfiguration &config);
+
+    // Count the edges the components need against those of "all"
+    static DistributionEstimate estimate(const QString &buildDir, const QStringList &components);
+};
+
+#endif // DISTRIBUTIONPLANNER_H
@@ -0,0 +1,205 @@
+#include "jobserver.h"
+#include "resourceplanner.h"
+
+#include <QDir>
+#include <QFile>
+#include <QCoreApplication>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QVersionNumber>
+
+#if defined(Q_OS_UNIX)
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// How often memory and load are sampled
+const int SampleIntervalMs = 1000;
+
+// Load above this multiple of the core count counts as pressure
+const double LoadPressureFactor = 1.5;
+
+// First releases that read --jobserver-auth=fifo: from MAKEFLAGS; older
+// ninja ignores it and older make rejects it
+const QVersionNumber MinimumMake(4, 4);
+const QVersionNumber MinimumNinja(1, 13);
+
+} // namespace
+
+JobServer::JobServer(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))
+    , m_fd(-1)
+    , m_maxJobs(0)
+    , m_withheld(0)
+    , m_reserveMB(0)
+{
+    m_timer->setInterval(SampleIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &JobServer::adjustTokens);
+}
+
+JobServer::~JobServer()
+{
+    stop();
+}
+
+bool JobServer::start(int maxJobs, qint64 reserveMB)
+{
+    stop();
+
+#if defined(Q_OS_UNIX)
+    m_fifoPath = QDir(QDir::tempPath()).filePath(
+        QString("llvmbuilder_jobserver_%1").arg(QCoreApplication::applicationPid()));
+    QByteArray path = QFile::encodeName(m_fifoPath);
+    unlink(path.constData());
+    if (mkfifo(path.constData(), 0600) != 0) {
+        m_fifoPath.clear();
+        return false;
+    }
+
+    // Held open read-write so the FIFO never sees EOF between clients
+    m_fd = open(path.constData(), O_RDWR | O_NONBLOCK);
+    if (m_fd < 0) {
+        unlink(path.constData());
+        m_fifoPath.clear();
+        return false;
+    }
+
+    // The client's first job runs on its implicit token
+    m_maxJobs = qMax(1, maxJobs);
+    m_reserveMB = reserveMB;
+    m_withheld = m_maxJobs - 1;
+    release(m_withheld);
+
+    m_timer->start();
+    return true;
+#else
+    Q_UNUSED(maxJobs);
+    Q_UNUSED(reserveMB);
+    return false;
+#endif
+}
+
+void JobServer::stop()
+{
+    m_timer->stop();
+
+#if defined(Q_OS_UNIX)
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (!m_fifoPath.isEmpty()) {
+        unlink(QFile::encodeName(m_fifoPath).constData());
+        m_fifoPath.clear();
+    }
+#endif
+
+    m_withheld = 0;
+}
+
+bool JobServer::isActive() const
+{
+    return m_fd >= 0;
+}
+
+QString JobServer::makeFlags() const
+{
+    return QString("-j%1 --jobserver-auth=fifo:%2").arg(m_maxJobs).arg(m_fifoPath);
+}
+
+int JobServer::withheldTokens() const
+{
+    return m_withheld;
+}
+
+bool JobServer::clientSupported(bool useMake, QString *version)
+{
+    QProcess process;
+    process.start(useMake ? "make" : "ninja", {"--version"});
+    QString output;
+    if (process.waitForFinished(5000) && process.exitStatus() == QProcess::NormalExit) {
+        output = QString::fromUtf8(process.readAllStandardOutput());
+    } else {
+        process.kill();
+        process.waitForFinished();
+    }
+
+    // "1.12.1" from ninja, "GNU Make 4.3" from make
+    QRegularExpressionMatch match = QRegularExpression("(\\d+(\\.\\d+)+)").match(output);
+    QVersionNumber found = match.hasMatch() ? QVersionNumber::fromString(match.captured(1)) : QVersionNumber();
+    if (version) {
+        *version = found.toString();
+    }
+    return !found.isNull() && found >= (useMake ? MinimumMake : MinimumNinja);
+}
+
+void JobServer::adjustTokens()
+{
+#if defined(Q_OS_UNIX)
+    qint64 availableMB = ResourcePlanner::availableMemoryMB();
+    int cores = ResourcePlanner::onlineCores();
+    double load = 0.0;
+    getloadavg(&load, 1);
+
+    int before = m_withheld;
+    bool memoryPressure = availableMB > 0 && availableMB < m_reserveMB;
+    bool loadPressure = load > cores * LoadPressureFactor;
+
+    if (memoryPressure || loadPressure) {
+        // Back off quickly under memory pressure; tokens in use are taken
+        // as their jobs finish
+        int step = memoryPressure ? qMax(1, m_maxJobs / 4) : 1;
+        withhold(qMin(step, m_maxJobs - 1 - m_withheld));
+    } else if (m_withheld > 0 && (availableMB <= 0 || availableMB > 2 * m_reserveMB) && load < cores) {
+        // Recover one job at a time
+        release(1);
+    }
+
+    if (m_withheld != before) {
+        emit message(QString("[jobserver] %1 of %2 jobs (%3 GB available, load %4)")
+                         .arg(m_maxJobs - m_withheld)
+                         .arg(m_maxJobs)
+                         .arg(availableMB / 1024.0, 0, 'f', 1)
+                         .arg(load, 0, 'f', 1));
+    }
+#endif
+}
+
+int JobServer::withhold(int count)
+{
+    int taken = 0;
+#if defined(Q_OS_UNIX)
+    char tokens[64];
+    while (count > 0) {
+        ssize_t result = read(m_fd, tokens, size_t(qMin(count, int(sizeof(tokens)))));
+        if (result <= 0) {
+            break;
+        }
+        taken += int(result);
+        count -= int(result);
+    }
+#else
+    Q_UNUSED(count);
+#endif
+    m_withheld += taken;
+    return taken;
+}
+
+void JobServer::release(int count)
+{
+#if defined(Q_OS_UNIX)
+    count = qMin(count, m_withheld);
+    QByteArray tokens(count, '+');
+    ssize_t written = count > 0 ? write(m_fd, tokens.constData(), size_t(tokens.size())) : 0;
+    if (written > 0) {
+        m_withheld -= int(written);
+    }
+#else
+    Q_UNUSED(count);
+#endif
+}
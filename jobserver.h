@@ -0,0 +1,64 @@
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+// A GNU make style jobserver backed by a named FIFO. make (4.4+) and ninja
+// (1.13+) take a token from the FIFO before starting a job and write it
+// back when the job finishes. The server watches memory and load and
+// withholds tokens under pressure, handing them back once the pressure
+// eases, so the build's parallelism follows the machine instead of a
+// fixed -j.
+class JobServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JobServer(QObject *parent = nullptr);
+    ~JobServer();
+
+    // Create the FIFO with maxJobs tokens. Memory below reserveMB causes
+    // tokens to be withheld, down to a single job.
+    bool start(int maxJobs, qint64 reserveMB);
+
+    // Withhold nothing more and remove the FIFO
+    void stop();
+
+    bool isActive() const;
+
+    // MAKEFLAGS value that points clients at this server
+    QString makeFlags() const;
+
+    // Tokens currently withheld from the build
+    int withheldTokens() const;
+
+    // Whether the make or ninja on PATH takes its jobs from a jobserver;
+    // version receives the version it reported, empty if it didn't run
+    static bool clientSupported(bool useMake, QString *version = nullptr);
+
+signals:
+    // A change in the number of tokens handed out, for the build log
+    void message(const QString &text);
+
+private slots:
+    // Sample memory and load and adjust the tokens in circulation
+    void adjustTokens();
+
+private:
+    QTimer *m_timer;
+    QString m_fifoPath;
+    int m_fd;
+    int m_maxJobs;
+    int m_withheld;
+    qint64 m_reserveMB;
+
+    // Take up to count free tokens out of the FIFO; returns how many were taken
+    int withhold(int count);
+
+    // Return up to count withheld tokens to the FIFO
+    void release(int count);
+};
+
+#endif // JOBSERVER_H
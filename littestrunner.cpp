@@ -0,0 +1,257 @@
+#include "littestrunner.h"
+#include "builddirpool.h"
+#include "commandgenerator.h"
+#include "resourceplanner.h"
+#include "stagepipeline.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace {
+
+// Lit suite of each project in an LLVM build directory
+const struct
+{
+    const char *project;
+    const char *suite;
+} ProjectSuites[] = {
+    {"clang", "tools/clang/test"},
+    {"clang-tools-extra", "tools/clang/tools/extra/test"},
+    {"lld", "tools/lld/test"},
+    {"lldb", "tools/lldb/test"},
+    {"mlir", "tools/mlir/test"},
+    {"polly", "tools/polly/test"},
+    {"bolt", "tools/bolt/test"},
+    {"flang", "tools/flang/test"},
+};
+
+// lit's record of test durations in each suite's execution directory
+const char *const TimesFile = ".lit_test_times.txt";
+
+QString quoted(const QString &path)
+{
+    return "\"" + path + "\"";
+}
+
+QString shellQuoted(const QString &text)
+{
+    return "'" + QString(text).replace("'", "'\\''") + "'";
+}
+
+} // namespace
+
+bool LitTestResult::isFailure() const
+{
+    return code == "FAIL" || code == "XPASS" || code == "TIMEOUT" || code == "UNRESOLVED";
+}
+
+LitTestRunner::LitTestRunner(const BuilderConfiguration &config)
+    : LitTestRunner(config, ResourcePlanner::plan(config))
+{
+}
+
+LitTestRunner::LitTestRunner(const BuilderConfiguration &config, const ResourcePlan &plan)
+    : m_config(config)
+    , m_plan(plan)
+{
+}
+
+QStringList LitTestRunner::suites() const
+{
+    // LLVM's own tests always run
+    QStringList suites{"test"};
+    const QStringList projects = m_config.projects().split(';', Qt::SkipEmptyParts);
+    for (const auto &entry : ProjectSuites) {
+        if (projects.contains(entry.project)) {
+            suites.append(entry.suite);
+        }
+    }
+    return suites;
+}
+
+QString LitTestRunner::generateCommands() const
+{
+    QString results = resultsDir(m_config.buildDir());
+
+    // The test tools build on their own, whatever the build itself was limited to
+    BuilderConfiguration toolsConfig = m_config;
+    toolsConfig.setUseDistribution(false);
+    CommandGenerator tools(toolsConfig, m_plan);
+
+    QString command = CommandGenerator::stageMarker("test");
+    command += "run_tests() {\n";
+    // Suites a pipelined build already ran keep their results
+    const QStringList tested = StagePipeline(m_config, m_plan).testedSuites();
+    QStringList remaining = suites();
+    for (const QString &suite : tested) {
+        remaining.removeAll(suite);
+    }
+
+    command += "local results=" + quoted(results) + " shard suite suites=()\n";
+    if (tested.isEmpty()) {
+        command += "rm -rf \"$results\" && mkdir -p \"$results\" || return 1\n";
+    } else {
+        command += "mkdir -p \"$results\" && rm -f \"$results\"/shard-* \"$results\"/rerun-* || return 1\n";
+    }
+    command += tools.generateBuildExecutionCommand() + " test-depends || return 1\n";
+    command += collectSuites(remaining);
+    command += "[ ${#suites[@]} -gt 0 ] || { echo \"No lit suites are configured\"; return 1; }\n";
+    command += restoreTimings();
+
+    // Every shard is a lit process of its own, taking every Nth test of the
+    // longest-first order; failing tests are reported through the results,
+    // not the script's status
+    command += "for shard in $(seq 1 " + QString::number(m_plan.testShards) + "); do\n" +
+               quoted(litPath()) + " -s --order=smart --num-shards " + QString::number(m_plan.testShards) +
+               " --run-shard \"$shard\" -j" + QString::number(m_plan.testJobsPerShard) +
+               " -o \"$results/shard-$shard.json\" \"${suites[@]}\" > \"$results/shard-$shard.log\" 2>&1 &\n"
+               "done\n"
+               "wait\n"
+               "cat \"$results\"/shard-*.log\n";
+    command += saveTimings();
+    command += "}\n";
+    command += "run_tests || echo \"Warning: The lit tests could not be run\"\n\n";
+    return command;
+}
+
+QString LitTestRunner::generateRerunCommand(const QStringList &testNames) const
+{
+    QString results = resultsDir(m_config.buildDir());
+
+    // lit matches --filter against the full "Suite :: path" name
+    QStringList patterns;
+    for (const QString &name : testNames) {
+        patterns.append(QRegularExpression::escape(name));
+    }
+    QString filter = "^(" + patterns.join('|') + ")$";
+    QString output = results + "/rerun-" + QString::number(QDateTime::currentMSecsSinceEpoch()) + ".json";
+
+    QString command = "#!/bin/bash\n\n";
+    command += "cd " + quoted(m_config.buildDir()) + " || exit 1\n";
+    command += "mkdir -p " + quoted(results) + " || exit 1\n";
+    command += "suites=()\n";
+    command += collectSuites(suites());
+    command += "[ ${#suites[@]} -gt 0 ] || { echo \"No lit suites are configured\"; exit 1; }\n";
+    command += CommandGenerator::stageMarker("test");
+    command += quoted(litPath()) + " -v -j" + QString::number(m_plan.testShards * m_plan.testJobsPerShard) +
+               " --filter " + shellQuoted(filter) + " -o " + quoted(output) + " \"${suites[@]}\"\n";
+    return command;
+}
+
+QString LitTestRunner::resultsDir(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".llvmbuilder_tests");
+}
+
+QVector<LitTestResult> LitTestRunner::loadResults(const QString &buildDir)
+{
+    // Reruns are newer than the shards and the suites a pipelined build
+    // ran, and later reruns newer than earlier ones
+    QDir dir(resultsDir(buildDir));
+    QStringList files = dir.entryList(QStringList() << "early*.json", QDir::Files, QDir::Name);
+    files += dir.entryList(QStringList() << "shard-*.json", QDir::Files, QDir::Name);
+    files += dir.entryList(QStringList() << "rerun-*.json", QDir::Files, QDir::Name);
+
+    QMap<QString, LitTestResult> byName;
+    for (const QString &fileName : files) {
+        QFile file(dir.filePath(fileName));
+        QVector<LitTestResult> results;
+        if (!file.open(QIODevice::ReadOnly) || !parseResults(file.readAll(), results)) {
+            continue;
+        }
+        for (const LitTestResult &result : results) {
+            byName.insert(result.name, result);
+        }
+    }
+    return byName.values();
+}
+
+bool LitTestRunner::parseResults(const QByteArray &json, QVector<LitTestResult> &results)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject()) {
+        return false;
+    }
+
+    const QJsonArray tests = doc.object()["tests"].toArray();
+    for (const QJsonValue &value : tests) {
+        QJsonObject test = value.toObject();
+        LitTestResult result;
+        result.name = test["name"].toString();
+        result.code = test["code"].toString();
+        result.elapsedSeconds = test["elapsed"].toDouble();   // null for tests that did not run
+        result.output = test["output"].toString();
+        // Tests left to other shards or outside a rerun's filter are not results
+        if (!result.name.isEmpty() && result.code != "EXCLUDED" && result.code != "SKIPPED") {
+            results.append(result);
+        }
+    }
+    return true;
+}
+
+QVector<LitTestResult> LitTestRunner::slowTests(const QVector<LitTestResult> &results, double thresholdSeconds)
+{
+    QVector<LitTestResult> slow;
+    for (const LitTestResult &result : results) {
+        if (result.elapsedSeconds > thresholdSeconds) {
+            slow.append(result);
+        }
+    }
+    std::sort(slow.begin(), slow.end(), [](const LitTestResult &a, const LitTestResult &b) {
+        return a.elapsedSeconds > b.elapsedSeconds;
+    });
+    return slow;
+}
+
+QString LitTestRunner::timingsDir(const BuilderConfiguration &config)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/lit-test-times/" +
+           BuildDirPool::configHash(config);
+}
+
+QString LitTestRunner::collectSuites(const QStringList &candidates) const
+{
+    // A suite exists once CMake generated its site configuration
+    return "for suite in " + candidates.join(' ') + "; do\n"
+           "[ -f " + quoted(m_config.buildDir() + "/$suite/lit.site.cfg.py") + " ] && suites+=(" +
+           quoted(m_config.buildDir() + "/$suite") + ")\n"
+           "done\n";
+}
+
+QString LitTestRunner::litPath() const
+{
+    return m_config.buildDir() + "/bin/llvm-lit";
+}
+
+QString LitTestRunner::restoreTimings() const
+{
+    // A timing file in the build directory is newer than the kept one
+    return copyTimings(timingsDir(m_config), m_config.buildDir(), false);
+}
+
+QString LitTestRunner::saveTimings() const
+{
+    // Every shard rewrites the timing files of the suites it ran, so a
+    // shard finishing at the same moment as another can leave some tests
+    // with their previous duration; the order only needs to be roughly right
+    return copyTimings(m_config.buildDir(), timingsDir(m_config), true);
+}
+
+QString LitTestRunner::copyTimings(const QString &from, const QString &to, bool replace)
+{
+    QString target = quoted(to) + "/\"$times\"";
+    QString copy = "mkdir -p \"$(dirname " + target + ")\" && cp \"$times\" " + target;
+    return "[ -d " + quoted(from) + " ] && (cd " + quoted(from) + " && find . -name " + TimesFile +
+           " -type f | while read -r times; do\n" +
+           (replace ? copy : "[ -f " + target + " ] || { " + copy + "; }") + "\n"
+           "done)\n";
+}
@@ -0,0 +1,84 @@
+#ifndef LITTESTRUNNER_H
+#define LITTESTRUNNER_H
+
+#include "builderconfiguration.h"
+#include "resourceplanner.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// The outcome of one lit test
+struct LitTestResult
+{
+    QString name;                 // "Suite :: path/to/test"
+    QString code;                 // PASS, FAIL, XFAIL, UNSUPPORTED, ...
+    double elapsedSeconds = 0.0;
+    QString output;               // Commands and output of a failing test
+
+    // Whether the test counts as failed, as lit's exit status does
+    bool isFailure() const;
+};
+
+// Runs the lit suites of the configured projects after the build: the
+// test tools are built, then the suites are split into shards that run
+// as concurrent lit processes, each writing its results as JSON into the
+// build directory. Failed tests can be rerun on their own; the newest
+// result of each test wins when the results are loaded.
+//
+// lit orders tests by the durations it keeps in each suite's
+// .lit_test_times.txt, longest first, and deals them out to the shards in
+// that order. Those files are kept per configuration outside the build
+// directory, so a clean build or a new pooled directory still starts
+// its slowest tests first.
+class LitTestRunner
+{
+public:
+    // Plans the job counts for this host, or takes those of the build
+    explicit LitTestRunner(const BuilderConfiguration &config);
+    LitTestRunner(const BuilderConfiguration &config, const ResourcePlan &plan);
+
+    // Lit suite directories of the configured projects, relative to the build directory
+    QStringList suites() const;
+
+    // Commands of the test stage, run after a successful build
+    QString generateCommands() const;
+
+    // A script that runs just the named tests again
+    QString generateRerunCommand(const QStringList &testNames) const;
+
+    // Where the test stage of a build directory writes its results
+    static QString resultsDir(const QString &buildDir);
+
+    // The results of the last test stage and any reruns since, by test name
+    static QVector<LitTestResult> loadResults(const QString &buildDir);
+
+    // Read the tests of one lit JSON report (lit -o)
+    static bool parseResults(const QByteArray &json, QVector<LitTestResult> &results);
+
+    // Tests that took longer than the threshold, slowest first
+    static QVector<LitTestResult> slowTests(const QVector<LitTestResult> &results, double thresholdSeconds);
+
+    // Where the lit timing files of a configuration are kept between runs
+    static QString timingsDir(const BuilderConfiguration &config);
+
+private:
+    BuilderConfiguration m_config;
+    ResourcePlan m_plan;
+
+    // Shell lines that collect the configured suites of the candidates into
+    // the array "suites"
+    QString collectSuites(const QStringList &candidates) const;
+
+    // Shell lines that restore the kept timing files missing from the build
+    // directory, and that keep the ones the run updated
+    QString restoreTimings() const;
+    QString saveTimings() const;
+
+    // Copy the timing files under one directory to the same places under another
+    static QString copyTimings(const QString &from, const QString &to, bool replace);
+
+    QString litPath() const;
+};
+
+#endif // LITTESTRUNNER_H
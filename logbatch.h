@@ -0,0 +1,44 @@
+#ifndef LOGBATCH_H
+#define LOGBATCH_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QMetaType>
+
+// A batch of complete output lines, split on the worker thread.
+// The lines are stored back to back in one buffer, each terminated by
+// '\n', with the start offset of every line alongside.
+struct LogBatch
+{
+    QByteArray data;
+    QVector<quint32> lineOffsets;
+
+    int lineCount() const { return lineOffsets.size(); }
+    bool isEmpty() const { return lineOffsets.isEmpty(); }
+
+    // Append a line (without its newline)
+    void appendLine(const char *line, int length)
+    {
+        lineOffsets.append(quint32(data.size()));
+        data.append(line, length);
+        data.append('\n');
+    }
+
+    // Get a line without its newline
+    QByteArray line(int index) const
+    {
+        quint32 start = lineOffsets.at(index);
+        quint32 end = (index + 1 < lineOffsets.size()) ? lineOffsets.at(index + 1) : quint32(data.size());
+        return data.mid(start, end - start - 1);
+    }
+
+    void clear()
+    {
+        data.clear();
+        lineOffsets.clear();
+    }
+};
+
+Q_DECLARE_METATYPE(LogBatch)
+
+#endif // LOGBATCH_H
@@ -5,6 +5,19 @@
 #include "buildexecutor.h"
 #include "configurationdialog.h"
 #include "fielddefaultsmanager.h"
+#include "buildlogmodel.h"
+#include "buildprogress.h"
+#include "ninjalog.h"
+#include "ninjaloganalyzer.h"
+#include "traceexporter.h"
+#include "timetraceaggregator.h"
+#include "resourceplanner.h"
+#include "builddirpool.h"
+#include "builddirpooldialog.h"
+#include "distributionplanner.h"
+#include "pgopipeline.h"
+#include "boltstage.h"
+#include "sourceprefetcher.h"
 
 #include <QToolBar>
 #include <QLabel>
@@ -18,26 +31,52 @@
 #include <QDateTime>
 #include <QDir>
 #include <QScrollBar>
+#include <QThread>
+#include <QTreeWidget>
+#include <QElapsedTimer>
+
+#include <memory>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_config(new BuilderConfiguration())
     , m_generator(new CommandGenerator(*m_config))
-    , m_executor(new BuildExecutor(this))
+    , m_executor(new BuildExecutor())
+    , m_workerThread(new QThread(this))
     , m_configDialog(new ConfigurationDialog(this))
+    , m_logModel(new BuildLogModel(this))
+    , m_timeTraceThread(nullptr)
+    , m_rerunningTests(false)
+    , m_prefetcher(new SourcePrefetcher(m_config, this))
 {
     ui->setupUi(this);
 
-    // Set up the output text edit
-    ui->outputTextEdit->setReadOnly(true);
-    ui->outputTextEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
-    ui->outputTextEdit->setFont(QFont("Courier New", 10));
+    // Set up the output view; only visible rows are ever rendered
+    ui->outputListView->setModel(m_logModel);
+    ui->outputListView->setUniformItemSizes(true);
+    ui->outputListView->setFont(QFont("Courier New", 10));
+
+    // Run the executor, its process and output splitting on a worker thread
+    m_executor->moveToThread(m_workerThread);
+    connect(m_workerThread, &QThread::finished, m_executor, &QObject::deleteLater);
+    m_workerThread->start();
 
-    // Connect build executor signals
+    // Connect build executor signals (queued across threads)
     connect(m_executor, &BuildExecutor::buildStarted, this, &MainWindow::onBuildStarted);
     connect(m_executor, &BuildExecutor::buildFinished, this, &MainWindow::onBuildFinished);
     connect(m_executor, &BuildExecutor::outputAvailable, this, &MainWindow::onOutputAvailable);
+    connect(m_executor, &BuildExecutor::progressChanged, this, &MainWindow::onBuildProgress);
+
+    // Background source prefetch; its settings apply without waiting for a build
+    connect(m_prefetcher, &SourcePrefetcher::prefetchFinished, this,
+            [this](bool, const QString &message) { statusBar()->showMessage(message, 3000); });
+    connect(ui->prefetchSourcesCheckBox, &QCheckBox::toggled, this,
+            [this](bool checked) { m_config->setPrefetchSources(checked); });
+    connect(ui->prefetchIntervalSpinBox, &QSpinBox::valueChanged, this,
+            [this](int minutes) { m_config->setPrefetchIntervalMinutes(minutes); });
+    connect(ui->warmPageCacheCheckBox, &QCheckBox::toggled, this,
+            [this](bool checked) { m_config->setWarmPageCache(checked); });
 
     // Set up the UI
     updateUIFromConfig();
@@ -58,6 +97,15 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // Stop the worker thread; the executor is deleted as it finishes
+    m_workerThread->quit();
+    m_workerThread->wait();
+
+    // Let a running time trace aggregation finish before tearing down
+    if (m_timeTraceThread) {
+        m_timeTraceThread->wait();
+    }
+
     delete ui;
     delete m_config;
     delete m_generator;
@@ -134,6 +182,39 @@ void MainWindow::on_actionReset_to_Defaults_triggered()
     statusBar()->showMessage("Configuration reset to defaults", 3000);
 }
 
+void MainWindow::on_actionExport_Build_Trace_triggered()
+{
+    // Update the configuration from the UI
+    updateConfigFromUI();
+
+    // Get the file path
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Build Trace",
+                                                  QDir::homePath() + "/llvm_build_trace.json",
+                                                  "Chrome Trace Files (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    // Export the timeline of the last build; a PGO pipeline's report is in
+    // the root and the final stage's ninja log in its own directory
+    QString errorMessage;
+    if (TraceExporter::exportTrace(BuildDirPool::buildDirFor(*m_config), testBuildDir(), fileName, &errorMessage)) {
+        statusBar()->showMessage("Build trace exported to: " + fileName, 3000);
+    } else {
+        QMessageBox::warning(this, "Export Error", errorMessage);
+    }
+}
+
+void MainWindow::on_actionBuild_Directory_Pool_triggered()
+{
+    // Update the configuration from the UI
+    updateConfigFromUI();
+
+    BuildDirPoolDialog dialog(m_config->buildDirPoolRoot(),
+                              qint64(m_config->buildDirPoolBudget()) * 1024 * 1024 * 1024, this);
+    dialog.exec();
+}
+
 void MainWindow::on_generateButton_clicked()
 {
     // Validate projects and runtimes
@@ -168,10 +249,16 @@ void MainWindow::on_buildButton_clicked()
     // Update the configuration from the UI
     updateConfigFromUI();
 
+    // The host is probed once; every stage of the script, the jobserver and
+    // any resume use the job counts shown here
+    ResourcePlan plan = ResourcePlanner::plan(*m_config);
+    ui->resourcePlanLabel->setText(plan.summary());
+
     // Confirm if this is not a dry run
     if (!m_config->dryRun()) {
         QMessageBox::StandardButton reply = QMessageBox::question(this, "Start Build",
-                                                                "Are you sure you want to start the build?",
+                                                                "Are you sure you want to start the build?\n\n" +
+                                                                    plan.summary(),
                                                                 QMessageBox::Yes | QMessageBox::No);
         if (reply != QMessageBox::Yes) {
             return;
@@ -179,10 +266,11 @@ void MainWindow::on_buildButton_clicked()
     }
 
     // Clear the output
-    ui->outputTextEdit->clear();
+    m_logModel->clear();
+    m_logModel->store().setMemoryLimit(qint64(m_config->outputMemoryLimit()) * 1024 * 1024);
 
     // Start the build
-    m_executor->executeBuild(*m_config);
+    m_executor->executeBuild(*m_config, plan);
 
     // Switch to the output tab
     ui->tabWidget->setCurrentIndex(3);
@@ -209,14 +297,13 @@ void MainWindow::on_cancelButton_clicked()
 
 void MainWindow::on_clearOutputButton_clicked()
 {
-    ui->outputTextEdit->clear();
+    m_logModel->clear();
 }
 
 void MainWindow::on_saveOutputButton_clicked()
 {
-    // Get the output text
-    QString output = ui->outputTextEdit->toPlainText();
-    if (output.isEmpty()) {
+    // Check there is output to save
+    if (m_logModel->rowCount() == 0) {
         QMessageBox::information(this, "Save Output", "There is no output to save.");
         return;
     }
@@ -229,11 +316,9 @@ void MainWindow::on_saveOutputButton_clicked()
         return;
     }
 
-    // Save the output
+    // Save the output straight from the log pages
     QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream stream(&file);
-        stream << output;
+    if (file.open(QIODevice::WriteOnly) && m_logModel->store().writeTo(&file)) {
         file.close();
 
         statusBar()->showMessage("Output saved to: " + fileName, 3000);
@@ -257,6 +342,306 @@ void MainWindow::on_copyCommandButton_clicked()
     statusBar()->showMessage("Command copied to clipboard", 3000);
 }
 
+void MainWindow::on_analyzeNinjaLogButton_clicked()
+{
+    updateConfigFromUI();
+    analyzeNinjaLog(true);
+}
+
+bool MainWindow::analyzeNinjaLog(bool showErrors)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Parse the log and analyze the most recent run
+    NinjaLog log;
+    if (!log.load(NinjaLog::defaultPath(testBuildDir()))) {
+        if (showErrors) {
+            QMessageBox::warning(this, "Analyze .ninja_log", log.errorString());
+        }
+        return false;
+    }
+    NinjaLogAnalyzer::Report report = NinjaLogAnalyzer::analyze(log.lastRun(),
+                                                                ui->analysisTopCountSpinBox->value());
+
+    // Summary
+    auto seconds = [](qint64 ms) { return QString::number(ms / 1000.0, 'f', 1); };
+    QStringList kinds;
+    for (int kind = NinjaLogAnalyzer::Compile; kind <= NinjaLogAnalyzer::Other; ++kind) {
+        kinds.append(NinjaLogAnalyzer::kindName(NinjaLogAnalyzer::EdgeKind(kind)) + " " +
+                     seconds(report.kindTotalMs[kind]) + " s");
+    }
+    ui->analysisSummaryLabel->setText(
+        QString("%1 edges, wall %2 s, CPU %3 s, average parallelism %4, critical path %5 s (%6 edges).\n%7.\n"
+                "Parsed %8 log entries in %9 ms.")
+            .arg(report.edgeCount)
+            .arg(seconds(report.wallMs))
+            .arg(seconds(report.totalMs))
+            .arg(report.averageParallelism, 0, 'f', 1)
+            .arg(seconds(report.criticalPathMs))
+            .arg(report.criticalPath.size())
+            .arg(kinds.join(", "))
+            .arg(log.edges().size())
+            .arg(timer.elapsed()));
+
+    // Sections
+    QTreeWidget *tree = ui->analysisTreeWidget;
+    tree->setUpdatesEnabled(false);
+    tree->clear();
+
+    auto addEdges = [&](const QString &title, const QVector<NinjaEdge> &edges, bool showStart) {
+        QTreeWidgetItem *section = new QTreeWidgetItem(tree, QStringList() << title);
+        for (const NinjaEdge &edge : edges) {
+            QString details = NinjaLogAnalyzer::kindName(NinjaLogAnalyzer::classify(edge));
+            if (showStart) {
+                details += ", starts at " + seconds(edge.start) + " s";
+            }
+            new QTreeWidgetItem(section, QStringList() << QString::fromUtf8(edge.outputs.first())
+                                                      << seconds(edge.duration()) << details);
+        }
+        return section;
+    };
+
+    addEdges("Critical Path", report.criticalPath, true)->setExpanded(true);
+    addEdges("Slowest Compile Edges", report.slowestCompiles, false)->setExpanded(true);
+    addEdges("Slowest Link Edges", report.slowestLinks, false)->setExpanded(true);
+
+    QTreeWidgetItem *directories = new QTreeWidgetItem(tree, QStringList() << "Output Directories");
+    for (const NinjaLogAnalyzer::DirectoryTotal &directory : report.directories) {
+        double share = report.totalMs > 0 ? 100.0 * directory.totalMs / report.totalMs : 0.0;
+        new QTreeWidgetItem(directories, QStringList() << directory.directory << seconds(directory.totalMs)
+                                                       << QString("%1 edges, %2% of CPU time")
+                                                              .arg(directory.edgeCount)
+                                                              .arg(share, 0, 'f', 1));
+    }
+
+    tree->resizeColumnToContents(1);
+    tree->setUpdatesEnabled(true);
+    return true;
+}
+
+void MainWindow::on_aggregateTimeTraceButton_clicked()
+{
+    updateConfigFromUI();
+    aggregateTimeTraces();
+}
+
+void MainWindow::aggregateTimeTraces()
+{
+    if (m_timeTraceThread) {
+        return;
+    }
+
+    QString buildDir = testBuildDir();
+    int topCount = ui->analysisTopCountSpinBox->value();
+    ui->aggregateTimeTraceButton->setEnabled(false);
+    ui->timeTraceSummaryLabel->setText("Aggregating time traces...");
+
+    // Parsing thousands of traces takes a while; keep it off the UI thread
+    auto report = std::make_shared<TimeTraceAggregator::Report>();
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+    m_timeTraceThread = QThread::create([buildDir, topCount, report]() {
+        *report = TimeTraceAggregator::aggregate(buildDir, TimeTraceAggregator::findTraceFiles(buildDir), topCount);
+    });
+
+    connect(m_timeTraceThread, &QThread::finished, this, [this, report, timer]() {
+        m_timeTraceThread->deleteLater();
+        m_timeTraceThread = nullptr;
+        ui->aggregateTimeTraceButton->setEnabled(true);
+
+        auto seconds = [](qint64 us) { return QString::number(us / 1000000.0, 'f', 1); };
+        if (report->fileCount == 0) {
+            ui->timeTraceSummaryLabel->setText("No -ftime-trace files found. Enable \"Collect Time Traces\" "
+                                               "and rebuild.");
+            ui->timeTraceTreeWidget->clear();
+            return;
+        }
+
+        ui->timeTraceSummaryLabel->setText(
+            QString("%1 traces (%2 unreadable), compile %3 s: frontend %4 s, backend %5 s.\n"
+                    "Aggregated in %6 ms.")
+                .arg(report->fileCount)
+                .arg(report->failedFiles)
+                .arg(seconds(report->compileUs))
+                .arg(seconds(report->frontendUs))
+                .arg(seconds(report->backendUs))
+                .arg(timer->elapsed()));
+
+        QTreeWidget *tree = ui->timeTraceTreeWidget;
+        tree->setUpdatesEnabled(false);
+        tree->clear();
+
+        auto addEntries = [&](const QString &title, const QVector<TimeTraceAggregator::Entry> &entries) {
+            QTreeWidgetItem *section = new QTreeWidgetItem(tree, QStringList() << title);
+            for (const TimeTraceAggregator::Entry &entry : entries) {
+                new QTreeWidgetItem(section, QStringList() << entry.name << seconds(entry.totalUs)
+                                                          << QString::number(entry.count));
+            }
+            section->setExpanded(true);
+        };
+
+        addEntries("Compile Time per Project", report->projects);
+        addEntries("Most Expensive Headers", report->headers);
+        addEntries("Most Expensive Template Instantiations", report->instantiations);
+        addEntries("Most Expensive Backend Passes", report->passes);
+
+        tree->resizeColumnToContents(1);
+        tree->setUpdatesEnabled(true);
+    });
+    m_timeTraceThread->start();
+}
+
+void MainWindow::on_loadTestResultsButton_clicked()
+{
+    updateConfigFromUI();
+    loadTestResults(true);
+}
+
+bool MainWindow::loadTestResults(bool showErrors)
+{
+    QString buildDir = testBuildDir();
+    m_testResults = LitTestRunner::loadResults(buildDir);
+    showTestResults();
+    if (m_testResults.isEmpty()) {
+        ui->testsSummaryLabel->setText("No lit results found in " + LitTestRunner::resultsDir(buildDir) +
+                                       ". Check \"Enable Testing\" and rebuild.");
+        if (showErrors) {
+            QMessageBox::information(this, "Load Test Results",
+                                     "No lit results found in " + LitTestRunner::resultsDir(buildDir) + ".");
+        }
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::showTestResults()
+{
+    // Summary by result code
+    QMap<QString, int> codes;
+    int failures = 0;
+    double totalSeconds = 0.0;
+    for (const LitTestResult &result : m_testResults) {
+        codes[result.code]++;
+        totalSeconds += result.elapsedSeconds;
+        if (result.isFailure()) {
+            failures++;
+        }
+    }
+    QStringList counts;
+    for (auto it = codes.constBegin(); it != codes.constEnd(); ++it) {
+        counts.append(it.key() + " " + QString::number(it.value()));
+    }
+
+    // The long tail that bounds the wall time of the test stage
+    double threshold = ui->slowTestThresholdSpinBox->value();
+    const QVector<LitTestResult> slow = LitTestRunner::slowTests(m_testResults, threshold);
+    double slowSeconds = 0.0;
+    for (const LitTestResult &result : slow) {
+        slowSeconds += result.elapsedSeconds;
+    }
+
+    ui->testsSummaryLabel->setText(QString("%1 tests, %2 failed, %3 s of test time.\n%4.\n"
+                                           "%5 slow tests over %6 s took %7 s%8.")
+                                       .arg(m_testResults.size())
+                                       .arg(failures)
+                                       .arg(totalSeconds, 0, 'f', 1)
+                                       .arg(counts.join(", "))
+                                       .arg(slow.size())
+                                       .arg(threshold)
+                                       .arg(slowSeconds, 0, 'f', 1)
+                                       .arg(slow.isEmpty() ? QString()
+                                                           : QString(", the slowest %1 in %2 s")
+                                                                 .arg(slow.first().name)
+                                                                 .arg(slow.first().elapsedSeconds, 0, 'f', 1)));
+
+    // One row per test, the index of its result kept for the output pane
+    enum { Failures, SlowTests, AllTests };
+    int filter = ui->testsFilterComboBox->currentIndex();
+    QTreeWidget *tree = ui->testsTreeWidget;
+    tree->setUpdatesEnabled(false);
+    tree->setSortingEnabled(false);
+    tree->clear();
+    ui->testOutputTextEdit->clear();
+    for (int i = 0; i < m_testResults.size(); ++i) {
+        const LitTestResult &result = m_testResults[i];
+        if ((filter == Failures && !result.isFailure()) ||
+            (filter == SlowTests && result.elapsedSeconds <= threshold)) {
+            continue;
+        }
+        QTreeWidgetItem *item = new QTreeWidgetItem(tree, QStringList() << result.name << result.code);
+        item->setData(2, Qt::DisplayRole, qRound(result.elapsedSeconds * 100.0) / 100.0);
+        item->setData(0, Qt::UserRole, i);
+    }
+    tree->setSortingEnabled(true);
+    if (filter == SlowTests) {
+        tree->sortByColumn(2, Qt::DescendingOrder);
+    }
+    tree->resizeColumnToContents(0);
+    tree->setUpdatesEnabled(true);
+
+    ui->rerunFailedTestsButton->setEnabled(failures > 0 && !m_executor->isRunning());
+}
+
+void MainWindow::on_testsFilterComboBox_currentIndexChanged(int index)
+{
+    Q_UNUSED(index);
+    showTestResults();
+}
+
+void MainWindow::on_slowTestThresholdSpinBox_valueChanged(int value)
+{
+    Q_UNUSED(value);
+    showTestResults();
+}
+
+void MainWindow::on_testsTreeWidget_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous)
+{
+    Q_UNUSED(previous);
+    if (!current) {
+        ui->testOutputTextEdit->clear();
+        return;
+    }
+    int index = current->data(0, Qt::UserRole).toInt();
+    if (index >= 0 && index < m_testResults.size()) {
+        ui->testOutputTextEdit->setPlainText(m_testResults[index].output);
+    }
+}
+
+void MainWindow::on_rerunFailedTestsButton_clicked()
+{
+    if (m_executor->isRunning()) {
+        return;
+    }
+
+    QStringList failed;
+    for (const LitTestResult &result : m_testResults) {
+        if (result.isFailure()) {
+            failed.append(result.name);
+        }
+    }
+    if (failed.isEmpty()) {
+        return;
+    }
+
+    // Rerun in the directory the results came from; the new results
+    // replace the old ones of the same tests when they are loaded
+    updateConfigFromUI();
+    BuilderConfiguration config = *m_config;
+    config.setBuildDir(testBuildDir());
+    m_rerunningTests = true;
+    m_executor->executeCommand(LitTestRunner(config).generateRerunCommand(failed));
+    ui->testsSummaryLabel->setText(QString("Rerunning %1 failed tests...").arg(failed.size()));
+    ui->rerunFailedTestsButton->setEnabled(false);
+}
+
+QString MainWindow::testBuildDir() const
+{
+    BuilderConfiguration config = *m_config;
+    config.setBuildDir(BuildDirPool::buildDirFor(config));
+    return config.pgoPipeline() ? PgoPipeline(config).finalConfig().buildDir() : config.buildDir();
+}
+
 void MainWindow::on_botModeCheckBox_toggled(bool checked)
 {
     if (checked) {
@@ -501,6 +886,8 @@ void MainWindow::onBuildStarted()
 {
     // Update UI state
     updateUIState(true);
+    m_prefetcher->setBuildRunning(true);
+    resetBuildProgress();
 
     // Update status bar
     statusBar()->showMessage("Build started");
@@ -510,18 +897,78 @@ void MainWindow::onBuildFinished(bool success, const QString &message)
 {
     // Update UI state
     updateUIState(false);
+    m_prefetcher->setBuildRunning(false);
+
+    // Refresh the timing analysis from the build that just ran
+    if (!m_config->useMake()) {
+        analyzeNinjaLog(false);
+    }
+    if (m_config->timeTrace()) {
+        aggregateTimeTraces();
+    }
+
+    // Show the results of the test stage or rerun that just ran
+    if (m_config->doTesting() || m_rerunningTests) {
+        m_rerunningTests = false;
+        loadTestResults(false);
+    }
 
     // Update status bar
     statusBar()->showMessage(success ? "Build completed successfully" : "Build failed: " + message);
 }
 
-void MainWindow::onOutputAvailable(const QString &output)
+void MainWindow::onOutputAvailable(const LogBatch &batch)
 {
-    // Append the output
-    ui->outputTextEdit->appendPlainText(output);
+    // Only follow the output if the user is already looking at the tail
+    QScrollBar *scrollBar = ui->outputListView->verticalScrollBar();
+    bool atBottom = scrollBar->value() >= scrollBar->maximum();
+
+    // Append the whole batch as a single row insertion
+    m_logModel->appendBatch(batch);
 
     // Scroll to the bottom
-    ui->outputTextEdit->verticalScrollBar()->setValue(ui->outputTextEdit->verticalScrollBar()->maximum());
+    if (atBottom) {
+        ui->outputListView->scrollToBottom();
+    }
+}
+
+void MainWindow::onBuildProgress(const BuildProgress &progress)
+{
+    // Progress bar
+    ui->buildProgressBar->setMaximum(qMax(progress.totalEdges, 1));
+    ui->buildProgressBar->setValue(progress.finishedEdges);
+
+    // Throughput gauge
+    ui->buildThroughputLabel->setText(QString("%1 edges/s, %2 running")
+                                          .arg(progress.edgesPerSecond, 0, 'f', 1)
+                                          .arg(progress.runningEdges));
+
+    // ETA, marking whether it is based on a previous build
+    if (progress.etaMs < 0) {
+        ui->buildEtaLabel->setText("ETA: --");
+    } else {
+        ui->buildEtaLabel->setText("ETA: " + formatDuration(progress.etaMs) +
+                                   (progress.historyWeighted ? " (from .ninja_log)" : ""));
+    }
+    ui->buildEtaLabel->setToolTip("Elapsed: " + formatDuration(progress.elapsedMs));
+}
+
+void MainWindow::resetBuildProgress()
+{
+    ui->buildProgressBar->setMaximum(1);
+    ui->buildProgressBar->setValue(0);
+    ui->buildThroughputLabel->setText("-- edges/s");
+    ui->buildEtaLabel->setText("ETA: --");
+    ui->buildEtaLabel->setToolTip(QString());
+}
+
+QString MainWindow::formatDuration(qint64 ms) const
+{
+    qint64 seconds = ms / 1000;
+    return QString("%1:%2:%3")
+        .arg(seconds / 3600)
+        .arg((seconds / 60) % 60, 2, 10, QChar('0'))
+        .arg(seconds % 60, 2, 10, QChar('0'));
 }
 
 void MainWindow::updateUIFromConfig()
@@ -529,6 +976,11 @@ void MainWindow::updateUIFromConfig()
     // Update path fields
     ui->compilerPathLineEdit->setText(m_config->compilerPath());
     ui->llvmDirLineEdit->setText(m_config->llvmDir());
+    ui->sourceRepositoryLineEdit->setText(m_config->sourceRepository());
+    ui->sparseCheckoutCheckBox->setChecked(m_config->sparseCheckout());
+    ui->prefetchSourcesCheckBox->setChecked(m_config->prefetchSources());
+    ui->prefetchIntervalSpinBox->setValue(m_config->prefetchIntervalMinutes());
+    ui->warmPageCacheCheckBox->setChecked(m_config->warmPageCache());
     ui->buildDirLineEdit->setText(m_config->buildDir());
     ui->installPathLineEdit->setText(m_config->installPath());
     ui->timerFileLineEdit->setText(m_config->timerFile());
@@ -584,6 +1036,64 @@ void MainWindow::updateUIFromConfig()
     ui->doTestingCheckBox->setChecked(m_config->doTesting());
     ui->benchmarkCheckBox->setChecked(m_config->benchmark());
     ui->botModeCheckBox->setChecked(m_config->botMode());
+    ui->timeTraceCheckBox->setChecked(m_config->timeTrace());
+    ui->seedConfigureCheckBox->setChecked(m_config->seedConfigure());
+    ui->pipelineStagesCheckBox->setChecked(m_config->pipelineStages());
+    ui->forecastRebuildCheckBox->setChecked(m_config->forecastRebuild());
+
+    // Update output settings
+    ui->outputUpdateRateSpinBox->setValue(m_config->outputUpdateRate());
+    ui->outputMemoryLimitSpinBox->setValue(m_config->outputMemoryLimit());
+
+    // Update parallelism settings
+    ui->compileJobsSpinBox->setValue(m_config->compileJobs());
+    ui->linkJobsSpinBox->setValue(m_config->linkJobs());
+    ui->useJobServerCheckBox->setChecked(m_config->useJobServer());
+
+    // Update compiler cache settings
+    ui->compilerCacheComboBox->setCurrentText(m_config->compilerCache());
+    ui->cacheDirLineEdit->setText(m_config->cacheDir());
+    ui->cacheSizeSpinBox->setValue(m_config->cacheSize());
+
+    ui->resourcePlanLabel->setText(ResourcePlanner::plan(*m_config).summary());
+
+    // Update build directory pool settings
+    ui->useBuildDirPoolCheckBox->setChecked(m_config->useBuildDirPool());
+    ui->buildDirPoolRootLineEdit->setText(m_config->buildDirPoolRoot());
+    ui->buildDirPoolBudgetSpinBox->setValue(m_config->buildDirPoolBudget());
+    ui->cleanPooledBuildDirCheckBox->setChecked(m_config->cleanPooledBuildDir());
+
+    // Update distribution settings; components without a check box go to the line edit
+    ui->useDistributionCheckBox->setChecked(m_config->useDistribution());
+    QStringList components = DistributionPlanner::components(*m_config);
+    ui->distributionListWidget->clear();
+    const QStringList known = DistributionPlanner::knownComponents();
+    for (const QString &component : known) {
+        QListWidgetItem *item = new QListWidgetItem(component, ui->distributionListWidget);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(components.removeAll(component) > 0 ? Qt::Checked : Qt::Unchecked);
+    }
+    ui->extraComponentsLineEdit->setText(components.join(";"));
+    ui->stripDistributionCheckBox->setChecked(m_config->stripDistribution());
+
+    // Update PGO and BOLT settings
+    ui->pgoPipelineCheckBox->setChecked(m_config->pgoPipeline());
+    ui->pgoCorpusLineEdit->setText(m_config->pgoCorpus());
+    ui->pgoCorpusFlagsLineEdit->setText(m_config->pgoCorpusFlags());
+    ui->boltOptimizeCheckBox->setChecked(m_config->boltOptimize() && BoltStage::isSupported());
+    ui->boltProfileComboBox->setCurrentText(m_config->boltProfile());
+    if (!BoltStage::isSupported()) {
+        ui->boltOptimizeCheckBox->setEnabled(false);
+        ui->boltProfileComboBox->setEnabled(false);
+        ui->boltOptimizeCheckBox->setToolTip("BOLT needs ELF binaries and its runtime or perf, which this platform lacks");
+    }
+
+    // Update benchmark settings
+    ui->abBenchmarkCheckBox->setChecked(m_config->abBenchmark());
+    ui->abBenchmarkRunsSpinBox->setValue(m_config->abBenchmarkRuns());
+    ui->benchmarkCorpusLineEdit->setText(m_config->benchmarkCorpus());
+    ui->benchmarkCorpusFlagsLineEdit->setText(m_config->benchmarkCorpusFlags());
+    ui->benchmarkRepetitionsSpinBox->setValue(m_config->benchmarkRepetitions());
 
     // Update dependent UI states
     ui->sudoInstallCheckBox->setEnabled(m_config->doInstall());
@@ -610,6 +1120,13 @@ void MainWindow::updateConfigFromUI()
     m_config->setBuildDir(ui->buildDirLineEdit->text());
     m_config->setInstallPath(ui->installPathLineEdit->text());
     m_config->setTimerFile(ui->timerFileLineEdit->text());
+    if (!ui->sourceRepositoryLineEdit->text().isEmpty()) {
+        m_config->setSourceRepository(ui->sourceRepositoryLineEdit->text());
+    }
+    m_config->setSparseCheckout(ui->sparseCheckoutCheckBox->isChecked());
+    m_config->setPrefetchSources(ui->prefetchSourcesCheckBox->isChecked());
+    m_config->setPrefetchIntervalMinutes(ui->prefetchIntervalSpinBox->value());
+    m_config->setWarmPageCache(ui->warmPageCacheCheckBox->isChecked());
 
     // Update text fields from checkboxes
     updateTextFromCheckboxes();
@@ -647,6 +1164,57 @@ void MainWindow::updateConfigFromUI()
     m_config->setDoTesting(ui->doTestingCheckBox->isChecked());
     m_config->setBenchmark(ui->benchmarkCheckBox->isChecked());
     m_config->setBotMode(ui->botModeCheckBox->isChecked());
+    m_config->setTimeTrace(ui->timeTraceCheckBox->isChecked());
+    m_config->setSeedConfigure(ui->seedConfigureCheckBox->isChecked());
+    m_config->setPipelineStages(ui->pipelineStagesCheckBox->isChecked());
+    m_config->setForecastRebuild(ui->forecastRebuildCheckBox->isChecked());
+
+    // Update output settings
+    m_config->setOutputUpdateRate(ui->outputUpdateRateSpinBox->value());
+    m_config->setOutputMemoryLimit(ui->outputMemoryLimitSpinBox->value());
+
+    // Update parallelism settings
+    m_config->setCompileJobs(ui->compileJobsSpinBox->value());
+    m_config->setLinkJobs(ui->linkJobsSpinBox->value());
+    m_config->setUseJobServer(ui->useJobServerCheckBox->isChecked());
+
+    // Update compiler cache settings
+    m_config->setCompilerCache(ui->compilerCacheComboBox->currentText());
+    m_config->setCacheDir(ui->cacheDirLineEdit->text());
+    m_config->setCacheSize(ui->cacheSizeSpinBox->value());
+
+    // Update build directory pool settings
+    m_config->setUseBuildDirPool(ui->useBuildDirPoolCheckBox->isChecked());
+    m_config->setBuildDirPoolRoot(ui->buildDirPoolRootLineEdit->text());
+    m_config->setBuildDirPoolBudget(ui->buildDirPoolBudgetSpinBox->value());
+    m_config->setCleanPooledBuildDir(ui->cleanPooledBuildDirCheckBox->isChecked());
+
+    // Update distribution settings
+    m_config->setUseDistribution(ui->useDistributionCheckBox->isChecked());
+    QStringList components;
+    for (int i = 0; i < ui->distributionListWidget->count(); ++i) {
+        QListWidgetItem *item = ui->distributionListWidget->item(i);
+        if (item->checkState() == Qt::Checked) {
+            components.append(item->text());
+        }
+    }
+    components += ui->extraComponentsLineEdit->text().split(';', Qt::SkipEmptyParts);
+    m_config->setDistributionComponents(components.join(";"));
+    m_config->setStripDistribution(ui->stripDistributionCheckBox->isChecked());
+
+    // Update PGO and BOLT settings
+    m_config->setPgoPipeline(ui->pgoPipelineCheckBox->isChecked());
+    m_config->setPgoCorpus(ui->pgoCorpusLineEdit->text());
+    m_config->setPgoCorpusFlags(ui->pgoCorpusFlagsLineEdit->text());
+    m_config->setBoltOptimize(ui->boltOptimizeCheckBox->isChecked());
+    m_config->setBoltProfile(ui->boltProfileComboBox->currentText());
+
+    // Update benchmark settings
+    m_config->setAbBenchmark(ui->abBenchmarkCheckBox->isChecked());
+    m_config->setAbBenchmarkRuns(ui->abBenchmarkRunsSpinBox->value());
+    m_config->setBenchmarkCorpus(ui->benchmarkCorpusLineEdit->text());
+    m_config->setBenchmarkCorpusFlags(ui->benchmarkCorpusFlagsLineEdit->text());
+    m_config->setBenchmarkRepetitions(ui->benchmarkRepetitionsSpinBox->value());
 
     // Update the command generator
     delete m_generator;
@@ -659,6 +1227,9 @@ void MainWindow::updateUIState(bool buildRunning)
     ui->buildButton->setEnabled(!buildRunning);
     ui->generateButton->setEnabled(!buildRunning);
     ui->cancelButton->setEnabled(buildRunning);
+    if (buildRunning) {
+        ui->rerunFailedTestsButton->setEnabled(false);
+    }
 
     // Enable/disable configuration tabs
     ui->tabWidget->setTabEnabled(0, !buildRunning);
@@ -669,6 +1240,7 @@ void MainWindow::updateUIState(bool buildRunning)
     ui->actionSave_Configuration->setEnabled(!buildRunning);
     ui->actionLoad_Configuration->setEnabled(!buildRunning);
     ui->actionReset_to_Defaults->setEnabled(!buildRunning);
+    ui->actionBuild_Directory_Pool->setEnabled(!buildRunning);
 }
 
 void MainWindow::applyBotModeSettings()
@@ -6,11 +6,20 @@
 #include <QString>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QVector>
+
+#include "littestrunner.h"
 
 class BuilderConfiguration;
 class CommandGenerator;
 class BuildExecutor;
 class ConfigurationDialog;
+class BuildLogModel;
+class SourcePrefetcher;
+class QThread;
+class QTreeWidgetItem;
+struct LogBatch;
+struct BuildProgress;
 
 namespace Ui {
 class MainWindow;
@@ -31,6 +40,8 @@ private slots:
     void on_actionSave_Configuration_triggered();
     void on_actionLoad_Configuration_triggered();
     void on_actionReset_to_Defaults_triggered();
+    void on_actionExport_Build_Trace_triggered();
+    void on_actionBuild_Directory_Pool_triggered();
 
     void on_generateButton_clicked();
     void on_buildButton_clicked();
@@ -38,6 +49,13 @@ private slots:
     void on_clearOutputButton_clicked();
     void on_saveOutputButton_clicked();
     void on_copyCommandButton_clicked();
+    void on_analyzeNinjaLogButton_clicked();
+    void on_aggregateTimeTraceButton_clicked();
+    void on_loadTestResultsButton_clicked();
+    void on_rerunFailedTestsButton_clicked();
+    void on_testsFilterComboBox_currentIndexChanged(int index);
+    void on_slowTestThresholdSpinBox_valueChanged(int value);
+    void on_testsTreeWidget_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
 
     void on_botModeCheckBox_toggled(bool checked);
     void on_dryRunCheckBox_toggled(bool checked);
@@ -85,14 +103,21 @@ private slots:
     // Build executor event handlers
     void onBuildStarted();
     void onBuildFinished(bool success, const QString &message);
-    void onOutputAvailable(const QString &output);
+    void onOutputAvailable(const LogBatch &batch);
+    void onBuildProgress(const BuildProgress &progress);
 
 private:
     Ui::MainWindow *ui;
     BuilderConfiguration *m_config;
     CommandGenerator *m_generator;
     BuildExecutor *m_executor;
+    QThread *m_workerThread;
     ConfigurationDialog *m_configDialog;
+    BuildLogModel *m_logModel;
+    QThread *m_timeTraceThread;
+    QVector<LitTestResult> m_testResults;
+    bool m_rerunningTests;
+    SourcePrefetcher *m_prefetcher;
 
     // Update the UI from the configuration
     void updateUIFromConfig();
@@ -106,6 +131,28 @@ private:
     // Apply bot mode settings
     void applyBotModeSettings();
 
+    // Analyze the build directory's .ninja_log into the Analysis tab
+    bool analyzeNinjaLog(bool showErrors);
+
+    // Aggregate the build directory's -ftime-trace files in the background
+    void aggregateTimeTraces();
+
+    // Load the lit results of the last test run into the Tests tab
+    bool loadTestResults(bool showErrors);
+
+    // Fill the Tests tab from the loaded results
+    void showTestResults();
+
+    // The build directory the tests and the last ninja run used: the final
+    // stage of a PGO pipeline
+    QString testBuildDir() const;
+
+    // Reset the progress bar, throughput and ETA displays
+    void resetBuildProgress();
+
+    // Format a duration in milliseconds as h:mm:ss
+    QString formatDuration(qint64 ms) const;
+
     // Helper methods for UI updates
     void updatePathFields();
     void updateCompilerFields();
@@ -0,0 +1,328 @@
+#include "microbenchmarks.h"
+#include "ninjamanifest.h"
+#include "statistics.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QStandardPaths>
+
+namespace {
+
+// Runs kept per configuration
+const int MaxHistoryRuns = 20;
+
+// A change counts when it is unlikely to be noise and large enough to matter
+const double SignificanceLevel = 0.05;
+const double MinimumChangePercent = 3.0;
+
+// Nanoseconds per google-benchmark time unit
+double nanosecondsPer(const QString &unit)
+{
+    if (unit == "us") {
+        return 1e3;
+    }
+    if (unit == "ms") {
+        return 1e6;
+    }
+    if (unit == "s") {
+        return 1e9;
+    }
+    return 1.0;
+}
+
+QString formatNanoseconds(double ns)
+{
+    if (ns >= 1e6) {
+        return QString::number(ns / 1e6, 'f', 2) + " ms";
+    }
+    if (ns >= 1e3) {
+        return QString::number(ns / 1e3, 'f', 2) + " us";
+    }
+    return QString::number(ns, 'f', 1) + " ns";
+}
+
+} // namespace
+
+QJsonObject MicrobenchmarkRun::toJson() const
+{
+    QJsonObject benchmarks;
+    for (auto it = samples.constBegin(); it != samples.constEnd(); ++it) {
+        QJsonArray values;
+        for (double value : it.value()) {
+            values.append(value);
+        }
+        benchmarks[it.key()] = values;
+    }
+
+    QJsonObject json;
+    json["revision"] = revision;
+    json["timestampMs"] = timestampMs;
+    json["benchmarks"] = benchmarks;
+    return json;
+}
+
+void MicrobenchmarkRun::fromJson(const QJsonObject &json)
+{
+    revision = json["revision"].toString();
+    timestampMs = json["timestampMs"].toVariant().toLongLong();
+    samples.clear();
+    const QJsonObject benchmarks = json["benchmarks"].toObject();
+    for (auto it = benchmarks.constBegin(); it != benchmarks.constEnd(); ++it) {
+        QVector<double> values;
+        const QJsonArray array = it.value().toArray();
+        for (const QJsonValue &value : array) {
+            values.append(value.toDouble());
+        }
+        samples.insert(it.key(), values);
+    }
+}
+
+double MicrobenchmarkChange::changePercent() const
+{
+    return previousNs > 0.0 ? (currentNs - previousNs) / previousNs * 100.0 : 0.0;
+}
+
+QString MicrobenchmarkChange::summary() const
+{
+    return QString("%1: %2 -> %3 (%4%5%, p = %6)")
+        .arg(name)
+        .arg(formatNanoseconds(previousNs))
+        .arg(formatNanoseconds(currentNs))
+        .arg(changePercent() >= 0 ? "+" : "")
+        .arg(changePercent(), 0, 'f', 1)
+        .arg(pValue, 0, 'g', 2);
+}
+
+MicrobenchmarkHistory::MicrobenchmarkHistory(const QString &configHash)
+    : m_configHash(configHash)
+{
+}
+
+bool MicrobenchmarkHistory::load()
+{
+    m_runs.clear();
+
+    QFile file(filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return !file.exists();
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (doc.isNull() || !doc.isObject()) {
+        return false;
+    }
+
+    const QJsonArray runs = doc.object()["runs"].toArray();
+    for (const QJsonValue &value : runs) {
+        MicrobenchmarkRun run;
+        run.fromJson(value.toObject());
+        m_runs.append(run);
+    }
+    return true;
+}
+
+bool MicrobenchmarkHistory::save() const
+{
+    if (!QDir().mkpath(QFileInfo(filePath()).absolutePath())) {
+        return false;
+    }
+
+    QJsonArray runs;
+    for (const MicrobenchmarkRun &run : m_runs) {
+        runs.append(run.toJson());
+    }
+    QJsonObject json;
+    json["configuration"] = m_configHash;
+    json["runs"] = runs;
+
+    QFile file(filePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(json).toJson());
+    return true;
+}
+
+MicrobenchmarkRun MicrobenchmarkHistory::latest() const
+{
+    return m_runs.isEmpty() ? MicrobenchmarkRun() : m_runs.last();
+}
+
+void MicrobenchmarkHistory::append(const MicrobenchmarkRun &run)
+{
+    m_runs.append(run);
+    while (m_runs.size() > MaxHistoryRuns) {
+        m_runs.removeFirst();
+    }
+}
+
+QString MicrobenchmarkHistory::filePath() const
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/microbenchmarks/" + m_configHash +
+           ".json";
+}
+
+QVector<MicrobenchmarkChange> MicrobenchmarkHistory::regressions(const MicrobenchmarkRun &previous,
+                                                                 const MicrobenchmarkRun &current)
+{
+    return changes(previous, current, true);
+}
+
+QVector<MicrobenchmarkChange> MicrobenchmarkHistory::improvements(const MicrobenchmarkRun &previous,
+                                                                  const MicrobenchmarkRun &current)
+{
+    return changes(previous, current, false);
+}
+
+QVector<MicrobenchmarkChange> MicrobenchmarkHistory::changes(const MicrobenchmarkRun &previous,
+                                                             const MicrobenchmarkRun &current, bool slower)
+{
+    QVector<MicrobenchmarkChange> compared;
+    QVector<double> pValues;
+    for (auto it = current.samples.constBegin(); it != current.samples.constEnd(); ++it) {
+        auto before = previous.samples.constFind(it.key());
+        if (before == previous.samples.constEnd()) {
+            continue;
+        }
+
+        MicrobenchmarkChange change;
+        change.name = it.key();
+        change.previousNs = Statistics::mean(before.value());
+        change.currentNs = Statistics::mean(it.value());
+        compared.append(change);
+        pValues.append(Statistics::welchPValue(before.value(), it.value()));
+    }
+
+    // A run compares hundreds of benchmarks, so some would pass a plain
+    // 5% test by chance alone; the level applies to the false discovery
+    // rate over all of them instead
+    const QVector<double> adjusted = Statistics::benjaminiHochberg(pValues);
+    QVector<MicrobenchmarkChange> result;
+    for (int i = 0; i < compared.size(); ++i) {
+        MicrobenchmarkChange change = compared.at(i);
+        change.pValue = adjusted.at(i);
+
+        double percent = change.changePercent();
+        bool large = slower ? percent >= MinimumChangePercent : percent <= -MinimumChangePercent;
+        if (large && change.pValue < SignificanceLevel) {
+            result.append(change);
+        }
+    }
+    return result;
+}
+
+MicrobenchmarkRunner::MicrobenchmarkRunner(const BuilderConfiguration &config)
+    : m_config(config)
+{
+}
+
+QStringList MicrobenchmarkRunner::discover() const
+{
+    // add_benchmark() links each benchmark into a benchmarks directory of its project
+    QStringList binaries;
+    NinjaManifest manifest;
+    if (!manifest.load(NinjaManifest::defaultPath(m_config.buildDir()))) {
+        return binaries;
+    }
+
+    for (const NinjaBuildEdge &edge : manifest.edges()) {
+        if (!edge.rule.startsWith("CXX_EXECUTABLE_LINKER") || edge.outputs.isEmpty()) {
+            continue;
+        }
+        QString output = QString::fromUtf8(manifest.path(edge.outputs.first()));
+        if (!(output.startsWith("benchmarks/") || output.contains("/benchmarks/")) || output.contains("third-party/")) {
+            continue;
+        }
+        QFileInfo info(QDir(m_config.buildDir()).filePath(output));
+        if (info.isFile() && info.isExecutable()) {
+            binaries.append(info.absoluteFilePath());
+        }
+    }
+    binaries.sort();
+    return binaries;
+}
+
+bool MicrobenchmarkRunner::run(const std::atomic<bool> &cancelled,
+                               const std::function<void(const QString &)> &progress, MicrobenchmarkRun &result,
+                               QString &error) const
+{
+    const QStringList binaries = discover();
+    if (binaries.isEmpty()) {
+        error = "No benchmark executables found in " + m_config.buildDir();
+        return false;
+    }
+
+    // Random interleaving of the repetitions spreads machine noise over
+    // all benchmarks of a binary
+    QStringList arguments{"--benchmark_format=json",
+                          "--benchmark_repetitions=" + QString::number(qMax(2, m_config.benchmarkRepetitions())),
+                          "--benchmark_enable_random_interleaving=true"};
+
+    for (const QString &binary : binaries) {
+        if (cancelled) {
+            error = "Benchmarks cancelled";
+            return false;
+        }
+
+        QString name = QFileInfo(binary).fileName();
+        progress("Running " + name + "...");
+
+        QProcess process;
+        process.setWorkingDirectory(QFileInfo(binary).absolutePath());
+        process.start(binary, arguments);
+        if (!process.waitForStarted()) {
+            progress("Warning: Failed to start " + binary);
+            continue;
+        }
+        while (!process.waitForFinished(500) && process.state() != QProcess::NotRunning) {
+            if (cancelled) {
+                process.kill();
+                process.waitForFinished();
+                error = "Benchmarks cancelled";
+                return false;
+            }
+        }
+
+        // Benchmarks of different binaries may share names
+        MicrobenchmarkRun binaryRun;
+        if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0 ||
+            !parseOutput(process.readAllStandardOutput(), binaryRun)) {
+            progress("Warning: " + name + " failed or produced no JSON results");
+            continue;
+        }
+        for (auto it = binaryRun.samples.constBegin(); it != binaryRun.samples.constEnd(); ++it) {
+            result.samples.insert(name + "/" + it.key(), it.value());
+        }
+    }
+
+    if (result.samples.isEmpty()) {
+        error = "No benchmark produced results";
+        return false;
+    }
+    return true;
+}
+
+bool MicrobenchmarkRunner::parseOutput(const QByteArray &json, MicrobenchmarkRun &run)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject()) {
+        return false;
+    }
+
+    // Aggregates (mean, median, stddev) are recomputed from the repetitions
+    const QJsonArray benchmarks = doc.object()["benchmarks"].toArray();
+    for (const QJsonValue &value : benchmarks) {
+        QJsonObject benchmark = value.toObject();
+        if (benchmark["run_type"].toString("iteration") != "iteration" || benchmark["error_occurred"].toBool()) {
+            continue;
+        }
+        QString name = benchmark["run_name"].toString(benchmark["name"].toString());
+        double ns = benchmark["cpu_time"].toDouble() * nanosecondsPer(benchmark["time_unit"].toString());
+        run.samples[name].append(ns);
+    }
+    return !run.samples.isEmpty();
+}
@@ -0,0 +1,92 @@
+#ifndef MICROBENCHMARKS_H
+#define MICROBENCHMARKS_H
+
+#include "builderconfiguration.h"
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+// The google-benchmark results of one build: CPU time per iteration of
+// every repetition, by benchmark name
+struct MicrobenchmarkRun
+{
+    QString revision;
+    qint64 timestampMs = 0;
+    QMap<QString, QVector<double>> samples;   // Nanoseconds
+
+    QJsonObject toJson() const;
+    void fromJson(const QJsonObject &json);
+};
+
+// A benchmark whose time changed significantly between two runs
+struct MicrobenchmarkChange
+{
+    QString name;
+    double previousNs = 0.0;   // Mean of the repetitions
+    double currentNs = 0.0;
+    double pValue = 1.0;       // Adjusted for the other benchmarks of the run
+
+    double changePercent() const;
+    QString summary() const;
+};
+
+// Runs of one configuration, oldest first, in the application's data directory
+class MicrobenchmarkHistory
+{
+public:
+    explicit MicrobenchmarkHistory(const QString &configHash);
+
+    bool load();
+    bool save() const;
+
+    // The most recent run, or an empty one
+    MicrobenchmarkRun latest() const;
+
+    // Append a run, dropping the oldest beyond the retention limit
+    void append(const MicrobenchmarkRun &run);
+
+    QString filePath() const;
+
+    // Benchmarks that got slower, or faster, beyond noise and a minimum
+    // change; significance is corrected over all benchmarks both runs share
+    static QVector<MicrobenchmarkChange> regressions(const MicrobenchmarkRun &previous, const MicrobenchmarkRun &current);
+    static QVector<MicrobenchmarkChange> improvements(const MicrobenchmarkRun &previous, const MicrobenchmarkRun &current);
+
+private:
+    QString m_configHash;
+    QVector<MicrobenchmarkRun> m_runs;
+
+    static QVector<MicrobenchmarkChange> changes(const MicrobenchmarkRun &previous, const MicrobenchmarkRun &current,
+                                                 bool slower);
+};
+
+// Finds the benchmark executables LLVM_BUILD_BENCHMARKS built and runs
+// them with JSON output and a fixed number of repetitions
+class MicrobenchmarkRunner
+{
+public:
+    explicit MicrobenchmarkRunner(const BuilderConfiguration &config);
+
+    // Benchmark executables linked by build.ninja, as absolute paths
+    QStringList discover() const;
+
+    // Run every benchmark binary; progress lines are passed to the callback
+    // on the calling thread. Returns false with an error when nothing could
+    // be run; a failing binary is reported through progress and skipped.
+    bool run(const std::atomic<bool> &cancelled, const std::function<void(const QString &)> &progress,
+             MicrobenchmarkRun &result, QString &error) const;
+
+    // Add the iteration runs of google-benchmark JSON output to a run
+    static bool parseOutput(const QByteArray &json, MicrobenchmarkRun &run);
+
+private:
+    BuilderConfiguration m_config;
+};
+
+#endif // MICROBENCHMARKS_H
@@ -0,0 +1,131 @@
+#include "ninjadeps.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <cstring>
+
+namespace {
+
+quint32 readWord(const char *data)
+{
+    quint32 value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+NinjaDeps::NinjaDeps()
+    : m_version(0)
+{
+}
+
+QString NinjaDeps::defaultPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".ninja_deps");
+}
+
+bool NinjaDeps::load(const QString &filePath)
+{
+    m_paths.clear();
+    m_deps.clear();
+    m_version = 0;
+    m_errorString.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = "Cannot open " + filePath;
+        return false;
+    }
+
+    const QByteArray content = file.readAll();
+    const char *data = content.constData();
+    const int size = content.size();
+
+    // Header: "# ninjadeps\n" followed by a 32-bit version
+    static const char header[] = "# ninjadeps\n";
+    const int headerLength = sizeof(header) - 1;
+    if (size < headerLength + 4 || memcmp(data, header, headerLength) != 0) {
+        m_errorString = filePath + " is not a ninja deps log";
+        return false;
+    }
+    m_version = int(readWord(data + headerLength));
+    if (m_version != 3 && m_version != 4) {
+        m_errorString = "Unsupported ninja deps version " + QString::number(m_version);
+        return false;
+    }
+
+    // Version 4 stores 64-bit mtimes, version 3 32-bit ones
+    const int mtimeSize = m_version == 4 ? 8 : 4;
+    int offset = headerLength + 4;
+    while (offset + 4 <= size) {
+        quint32 head = readWord(data + offset);
+        bool isDeps = head & 0x80000000u;
+        int recordSize = int(head & 0x7fffffffu);
+        offset += 4;
+        if (recordSize % 4 != 0 || offset + recordSize > size) {
+            break;
+        }
+        const char *record = data + offset;
+        offset += recordSize;
+
+        if (isDeps) {
+            // out id, mtime, then one id per input
+            if (recordSize < 4 + mtimeSize) {
+                break;
+            }
+            int output = int(readWord(record));
+            if (output < 0 || output >= m_paths.size()) {
+                break;
+            }
+            int count = (recordSize - 4 - mtimeSize) / 4;
+            QVector<int> inputs;
+            inputs.reserve(count);
+            const char *ids = record + 4 + mtimeSize;
+            for (int i = 0; i < count; ++i) {
+                int input = int(readWord(ids + 4 * i));
+                if (input >= 0 && input < m_paths.size()) {
+                    inputs.append(input);
+                }
+            }
+            m_deps.insert(output, inputs);
+        } else {
+            // NUL-padded path, then the one's complement of its id as a checksum
+            if (recordSize < 4) {
+                break;
+            }
+            quint32 checksum = readWord(record + recordSize - 4);
+            if (checksum != ~quint32(m_paths.size())) {
+                break;
+            }
+            int length = recordSize - 4;
+            while (length > 0 && record[length - 1] == '\0') {
+                --length;
+            }
+            m_paths.append(QByteArray(record, length));
+        }
+    }
+
+    return true;
+}
+
+const QVector<QByteArray> &NinjaDeps::paths() const
+{
+    return m_paths;
+}
+
+const QHash<int, QVector<int>> &NinjaDeps::deps() const
+{
+    return m_deps;
+}
+
+int NinjaDeps::version() const
+{
+    return m_version;
+}
+
+QString NinjaDeps::errorString() const
+{
+    return m_errorString;
+}
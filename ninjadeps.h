@@ -0,0 +1,43 @@
+#ifndef NINJADEPS_H
+#define NINJADEPS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Reader for ninja's binary .ninja_deps (format versions 3 and 4), which
+// holds the header dependencies the compiler reported for each object.
+//
+// The file is a list of records. Path records assign the next node id to
+// a path; deps records list the node ids an output depends on, and a
+// later record for the same output replaces an earlier one.
+class NinjaDeps
+{
+public:
+    NinjaDeps();
+
+    // Parse a deps file; returns false if it is missing or not a deps log.
+    // A truncated final record is ignored, as ninja itself does.
+    bool load(const QString &filePath);
+
+    // The conventional deps location inside a build directory
+    static QString defaultPath(const QString &buildDir);
+
+    // Paths by node id, as ninja spells them
+    const QVector<QByteArray> &paths() const;
+
+    // Node ids each output node depends on
+    const QHash<int, QVector<int>> &deps() const;
+
+    int version() const;
+    QString errorString() const;
+
+private:
+    QVector<QByteArray> m_paths;
+    QHash<int, QVector<int>> m_deps;
+    int m_version;
+    QString m_errorString;
+};
+
+#endif // NINJADEPS_H
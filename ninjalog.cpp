@@ -0,0 +1,233 @@
+#include "ninjalog.h"
+
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QDir>
+
+#include <cstring>
+
+namespace {
+
+// Parse a decimal field ending at a tab; advances the cursor past the tab
+bool parseNumber(const char *&cursor, const char *end, qint64 &value)
+{
+    value = 0;
+    const char *begin = cursor;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        ++cursor;
+    }
+    if (cursor == begin || cursor >= end || *cursor != '\t') {
+        return false;
+    }
+    ++cursor;
+    return true;
+}
+
+} // namespace
+
+NinjaLog::NinjaLog()
+    : m_version(0)
+{
+}
+
+QString NinjaLog::defaultPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".ninja_log");
+}
+
+bool NinjaLog::load(const QString &filePath)
+{
+    m_edges.clear();
+    m_runs.clear();
+    m_version = 0;
+    m_errorString.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = "Cannot open " + filePath;
+        return false;
+    }
+
+    const QByteArray content = file.readAll();
+    const char *cursor = content.constData();
+    const char *end = cursor + content.size();
+
+    // Header: "# ninja log vN"
+    static const char header[] = "# ninja log v";
+    const int headerLength = sizeof(header) - 1;
+    if (content.size() < headerLength || qstrncmp(cursor, header, headerLength) != 0) {
+        m_errorString = filePath + " is not a ninja log";
+        return false;
+    }
+    cursor += headerLength;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        m_version = m_version * 10 + (*cursor - '0');
+        ++cursor;
+    }
+    if (m_version < 5) {
+        m_errorString = "Unsupported ninja log version " + QString::number(m_version);
+        return false;
+    }
+
+    m_edges.reserve(content.size() / 80);
+    qint64 previousEnd = -1;
+    int runStart = 0;
+
+    while (cursor < end) {
+        // Advance to the start of the next line
+        const char *lineEnd = static_cast<const char *>(memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        if (*cursor == '\n') {
+            ++cursor;
+            continue;
+        }
+
+        // start \t end \t mtime \t output \t hash
+        const char *field = cursor;
+        qint64 start, finish, mtime;
+        cursor = lineEnd + 1;
+        if (!parseNumber(field, lineEnd, start) || !parseNumber(field, lineEnd, finish) ||
+            !parseNumber(field, lineEnd, mtime)) {
+            continue;
+        }
+        const char *tab = static_cast<const char *>(memchr(field, '\t', lineEnd - field));
+        if (!tab) {
+            continue;
+        }
+        QByteArray output(field, int(tab - field));
+        QByteArray hash(tab + 1, int(lineEnd - tab - 1));
+
+        // A drop in end time means a new ninja invocation started
+        if (finish < previousEnd) {
+            m_runs.append(qMakePair(runStart, m_edges.size()));
+            runStart = m_edges.size();
+        }
+        previousEnd = finish;
+
+        // Further outputs of the same edge share its times and command hash
+        if (m_edges.size() > runStart) {
+            NinjaEdge &last = m_edges.last();
+            if (last.start == start && last.end == finish && last.commandHash == hash) {
+                last.outputs.append(output);
+                last.mtime = qMax(last.mtime, mtime);
+                continue;
+            }
+        }
+
+        NinjaEdge edge;
+        edge.start = start;
+        edge.end = finish;
+        edge.mtime = mtime;
+        edge.commandHash = hash;
+        edge.outputs.append(output);
+        m_edges.append(edge);
+    }
+
+    if (m_edges.size() > runStart) {
+        m_runs.append(qMakePair(runStart, m_edges.size()));
+    }
+
+    return true;
+}
+
+const QVector<NinjaEdge> &NinjaLog::edges() const
+{
+    return m_edges;
+}
+
+const QVector<QPair<int, int>> &NinjaLog::runs() const
+{
+    return m_runs;
+}
+
+QVector<NinjaEdge> NinjaLog::lastRun() const
+{
+    return runEdges(m_runs.size() - 1);
+}
+
+qint64 NinjaLog::runFinishedMs(int run) const
+{
+    if (run < 0 || run >= m_runs.size()) {
+        return 0;
+    }
+    qint64 newest = 0;
+    const QPair<int, int> &range = m_runs.at(run);
+    for (int i = range.first; i < range.second; ++i) {
+        newest = qMax(newest, m_edges.at(i).mtime);
+    }
+
+    // Older ninja records mtimes in seconds, newer in nanoseconds
+    if (newest > 100000000000000000LL) {
+        return newest / 1000000;
+    }
+    if (newest > 100000000000000LL) {
+        return newest / 1000;
+    }
+    if (newest > 100000000000LL) {
+        return newest;
+    }
+    return newest * 1000;
+}
+
+QVector<NinjaEdge> NinjaLog::largestRun() const
+{
+    int best = -1;
+    int bestSize = 0;
+    for (int i = 0; i < m_runs.size(); ++i) {
+        int size = m_runs.at(i).second - m_runs.at(i).first;
+        if (size >= bestSize) {
+            best = i;
+            bestSize = size;
+        }
+    }
+    return runEdges(best);
+}
+
+QVector<NinjaEdge> NinjaLog::latestEdges() const
+{
+    // Later records of an output replace earlier ones
+    QHash<QByteArray, int> latest;
+    latest.reserve(m_edges.size());
+    for (int i = 0; i < m_edges.size(); ++i) {
+        for (const QByteArray &output : m_edges.at(i).outputs) {
+            latest.insert(output, i);
+        }
+    }
+
+    QSet<int> used;
+    for (auto it = latest.constBegin(); it != latest.constEnd(); ++it) {
+        used.insert(it.value());
+    }
+
+    QVector<NinjaEdge> result;
+    result.reserve(used.size());
+    for (int i = 0; i < m_edges.size(); ++i) {
+        if (used.contains(i)) {
+            result.append(m_edges.at(i));
+        }
+    }
+    return result;
+}
+
+int NinjaLog::version() const
+{
+    return m_version;
+}
+
+QString NinjaLog::errorString() const
+{
+    return m_errorString;
+}
+
+QVector<NinjaEdge> NinjaLog::runEdges(int run) const
+{
+    if (run < 0 || run >= m_runs.size()) {
+        return QVector<NinjaEdge>();
+    }
+    const QPair<int, int> &range = m_runs.at(run);
+    return m_edges.mid(range.first, range.second - range.first);
+}
@@ -0,0 +1,69 @@
+#ifndef NINJALOG_H
+#define NINJALOG_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// One edge recorded in .ninja_log. Edges with several outputs are
+// written as one line per output; they are merged back into a single edge.
+struct NinjaEdge
+{
+    qint64 start = 0;            // Milliseconds since the ninja run started
+    qint64 end = 0;
+    qint64 mtime = 0;            // Newest output's mtime as ninja recorded it, 0 if none
+    QByteArray commandHash;
+    QList<QByteArray> outputs;
+
+    qint64 duration() const { return end - start; }
+};
+
+// Parser for ninja's .ninja_log (format versions 5 to 7).
+//
+// The log is appended to by every ninja invocation, so it holds several
+// runs back to back. A run boundary is detected when the end times stop
+// increasing, which happens because every run restarts its clock at zero.
+class NinjaLog
+{
+public:
+    NinjaLog();
+
+    // Parse a log file; returns false if it is missing or not a ninja log
+    bool load(const QString &filePath);
+
+    // The conventional log location inside a build directory
+    static QString defaultPath(const QString &buildDir);
+
+    // All edges in file order
+    const QVector<NinjaEdge> &edges() const;
+
+    // Index ranges [first, last) of each run, in file order
+    const QVector<QPair<int, int>> &runs() const;
+
+    // Edges of the most recent run
+    QVector<NinjaEdge> lastRun() const;
+
+    // Wall-clock end of a run in milliseconds since the epoch, estimated
+    // from the newest output it wrote; 0 if it wrote none
+    qint64 runFinishedMs(int run) const;
+
+    // Edges of the run that built the most edges (the best full-build profile)
+    QVector<NinjaEdge> largestRun() const;
+
+    // The most recent record for every output, across all runs
+    QVector<NinjaEdge> latestEdges() const;
+
+    int version() const;
+    QString errorString() const;
+
+private:
+    QVector<NinjaEdge> m_edges;
+    QVector<QPair<int, int>> m_runs;
+    int m_version;
+    QString m_errorString;
+
+    QVector<NinjaEdge> runEdges(int run) const;
+};
+
+#endif // NINJALOG_H
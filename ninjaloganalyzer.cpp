@@ -0,0 +1,163 @@
+#include "ninjaloganalyzer.h"
+
+#include <QHash>
+
+#include <algorithm>
+
+namespace {
+
+QByteArray directoryKey(const QByteArray &output)
+{
+    // Objects live in <dir>/CMakeFiles/<target>.dir/...; attribute them to <dir>
+    int cmakeFiles = output.indexOf("/CMakeFiles/");
+    if (cmakeFiles >= 0) {
+        return output.left(cmakeFiles);
+    }
+    if (output.startsWith("CMakeFiles/")) {
+        return ".";
+    }
+
+    int slash = output.lastIndexOf('/');
+    return slash > 0 ? output.left(slash) : QByteArray(".");
+}
+
+// Keep the topCount longest edges, longest first
+QVector<NinjaEdge> longest(QVector<NinjaEdge> edges, int topCount)
+{
+    auto byDuration = [](const NinjaEdge &a, const NinjaEdge &b) {
+        return a.duration() > b.duration();
+    };
+
+    if (edges.size() > topCount) {
+        std::partial_sort(edges.begin(), edges.begin() + topCount, edges.end(), byDuration);
+        edges.resize(topCount);
+    } else {
+        std::sort(edges.begin(), edges.end(), byDuration);
+    }
+    return edges;
+}
+
+} // namespace
+
+NinjaLogAnalyzer::Report NinjaLogAnalyzer::analyze(const QVector<NinjaEdge> &edges, int topCount)
+{
+    Report report;
+    if (edges.isEmpty()) {
+        return report;
+    }
+
+    // Totals, kinds and per-directory sums in a single pass
+    QVector<NinjaEdge> compiles;
+    QVector<NinjaEdge> links;
+    QHash<QByteArray, DirectoryTotal> directories;
+    qint64 firstStart = edges.first().start;
+    qint64 lastEnd = edges.first().end;
+
+    for (const NinjaEdge &edge : edges) {
+        qint64 duration = edge.duration();
+        firstStart = qMin(firstStart, edge.start);
+        lastEnd = qMax(lastEnd, edge.end);
+        report.totalMs += duration;
+
+        EdgeKind kind = classify(edge);
+        report.kindTotalMs[kind] += duration;
+        if (kind == Compile) {
+            compiles.append(edge);
+        } else if (kind == Link) {
+            links.append(edge);
+        }
+
+        DirectoryTotal &directory = directories[directoryKey(edge.outputs.first())];
+        directory.totalMs += duration;
+        ++directory.edgeCount;
+    }
+
+    report.edgeCount = edges.size();
+    report.wallMs = lastEnd - firstStart;
+    if (report.wallMs > 0) {
+        report.averageParallelism = double(report.totalMs) / report.wallMs;
+    }
+
+    report.slowestCompiles = longest(compiles, topCount);
+    report.slowestLinks = longest(links, topCount);
+
+    for (auto it = directories.begin(); it != directories.end(); ++it) {
+        it.value().directory = QString::fromUtf8(it.key());
+        report.directories.append(it.value());
+    }
+    std::sort(report.directories.begin(), report.directories.end(),
+              [](const DirectoryTotal &a, const DirectoryTotal &b) { return a.totalMs > b.totalMs; });
+
+    // Critical path: .ninja_log has no dependency information, so walk back
+    // from the last edge to finish, each time taking the edge that finished
+    // last before the current one started. That is the chain the build was
+    // waiting on.
+    QVector<NinjaEdge> byEnd = edges;
+    std::sort(byEnd.begin(), byEnd.end(),
+              [](const NinjaEdge &a, const NinjaEdge &b) { return a.end < b.end; });
+    QVector<qint64> ends;
+    ends.reserve(byEnd.size());
+    for (const NinjaEdge &edge : byEnd) {
+        ends.append(edge.end);
+    }
+
+    int current = byEnd.size() - 1;
+    while (current >= 0) {
+        const NinjaEdge &edge = byEnd.at(current);
+        report.criticalPath.append(edge);
+        report.criticalPathMs += edge.duration();
+
+        int predecessor = int(std::upper_bound(ends.begin(), ends.begin() + current, edge.start) - ends.begin()) - 1;
+        current = predecessor;
+    }
+    std::reverse(report.criticalPath.begin(), report.criticalPath.end());
+
+    return report;
+}
+
+NinjaLogAnalyzer::EdgeKind NinjaLogAnalyzer::classify(const NinjaEdge &edge)
+{
+    const QByteArray &output = edge.outputs.first();
+
+    if (output.endsWith(".o") || output.endsWith(".obj")) {
+        return Compile;
+    }
+    if (output.endsWith(".inc")) {
+        return TableGen;
+    }
+
+    // Executables and libraries produced in bin/ and lib/
+    int slash = output.lastIndexOf('/');
+    QByteArray directory = slash >= 0 ? output.left(slash) : QByteArray();
+    QByteArray name = output.mid(slash + 1);
+    if (directory.endsWith("lib")) {
+        if (name.endsWith(".a") || name.endsWith(".dylib") || name.contains(".so")) {
+            return Link;
+        }
+    }
+    if (directory.endsWith("bin") && !name.contains('.')) {
+        return Link;
+    }
+
+    return Other;
+}
+
+QString NinjaLogAnalyzer::kindName(EdgeKind kind)
+{
+    switch (kind) {
+    case Compile:
+        return "Compile";
+    case Link:
+        return "Link";
+    case TableGen:
+        return "TableGen";
+    case Other:
+    default:
+        return "Other";
+    }
+}
+
+QString NinjaLogAnalyzer::outputDirectory(const QByteArray &output)
+{
+    return QString::fromUtf8(directoryKey(output));
+}
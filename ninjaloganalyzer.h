@@ -0,0 +1,53 @@
+#ifndef NINJALOGANALYZER_H
+#define NINJALOGANALYZER_H
+
+#include "ninjalog.h"
+
+#include <QString>
+#include <QVector>
+
+// Timing analysis of one ninja run: critical path, slowest edges by kind
+// and time spent per output directory.
+class NinjaLogAnalyzer
+{
+public:
+    enum EdgeKind {
+        Compile,
+        Link,
+        TableGen,
+        Other
+    };
+
+    struct DirectoryTotal {
+        QString directory;
+        qint64 totalMs = 0;
+        int edgeCount = 0;
+    };
+
+    struct Report {
+        qint64 wallMs = 0;             // First start to last end
+        qint64 totalMs = 0;            // Sum of all edge durations
+        int edgeCount = 0;
+        double averageParallelism = 0.0;
+        qint64 kindTotalMs[Other + 1] = {};
+        QVector<NinjaEdge> criticalPath;   // In execution order
+        qint64 criticalPathMs = 0;
+        QVector<NinjaEdge> slowestCompiles;
+        QVector<NinjaEdge> slowestLinks;
+        QVector<DirectoryTotal> directories;   // Sorted by total time, descending
+    };
+
+    // Analyze a run (typically NinjaLog::lastRun()), keeping topCount edges per list
+    static Report analyze(const QVector<NinjaEdge> &edges, int topCount = 20);
+
+    // Classify an edge by its first output
+    static EdgeKind classify(const NinjaEdge &edge);
+
+    // Human-readable name of an edge kind
+    static QString kindName(EdgeKind kind);
+
+    // The directory an output belongs to, with CMake's object dirs stripped
+    static QString outputDirectory(const QByteArray &output);
+};
+
+#endif // NINJALOGANALYZER_H
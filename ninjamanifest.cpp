@@ -0,0 +1,219 @@
+#include "ninjamanifest.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+
+namespace {
+
+// Includes nest only a few levels in CMake's output
+const int MaxIncludeDepth = 16;
+
+// Split a build statement into paths and the separators ":", "|", "||"
+// and "|@", resolving ninja's $ escapes
+QList<QByteArray> tokenize(const QByteArray &line, int from)
+{
+    QList<QByteArray> tokens;
+    const int size = line.size();
+    int i = from;
+    while (i < size) {
+        char c = line.at(i);
+        if (c == ' ') {
+            ++i;
+            continue;
+        }
+        if (c == ':') {
+            tokens.append(":");
+            ++i;
+            continue;
+        }
+        if (c == '|') {
+            if (i + 1 < size && (line.at(i + 1) == '|' || line.at(i + 1) == '@')) {
+                tokens.append(line.mid(i, 2));
+                i += 2;
+            } else {
+                tokens.append("|");
+                ++i;
+            }
+            continue;
+        }
+
+        QByteArray token;
+        while (i < size) {
+            c = line.at(i);
+            if (c == ' ' || c == ':' || c == '|') {
+                break;
+            }
+            if (c == '$' && i + 1 < size) {
+                char next = line.at(i + 1);
+                if (next == ' ' || next == ':' || next == '$') {
+                    token.append(next);
+                    i += 2;
+                    continue;
+                }
+            }
+            token.append(c);
+            ++i;
+        }
+        tokens.append(token);
+    }
+    return tokens;
+}
+
+} // namespace
+
+NinjaManifest::NinjaManifest()
+{
+}
+
+QString NinjaManifest::defaultPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath("build.ninja");
+}
+
+bool NinjaManifest::load(const QString &filePath)
+{
+    m_edges.clear();
+    m_paths.clear();
+    m_ids.clear();
+    m_producers.clear();
+    m_errorString.clear();
+
+    // Includes are relative to ninja's working directory, the build directory
+    m_baseDir = QFileInfo(filePath).absolutePath();
+    return parseFile(filePath, 0);
+}
+
+bool NinjaManifest::parseFile(const QString &filePath, int depth)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = "Cannot open " + filePath;
+        return false;
+    }
+
+    const QByteArray content = file.readAll();
+    QByteArray line;
+    int start = 0;
+    while (start < content.size()) {
+        int end = content.indexOf('\n', start);
+        if (end < 0) {
+            end = content.size();
+        }
+        QByteArray physical = content.mid(start, end - start);
+        start = end + 1;
+        if (physical.endsWith('\r')) {
+            physical.chop(1);
+        }
+
+        // "$" at the end of a line continues it; the next line's indent is dropped
+        int dollars = 0;
+        while (dollars < physical.size() && physical.at(physical.size() - 1 - dollars) == '$') {
+            ++dollars;
+        }
+        if (!line.isEmpty()) {
+            int indent = 0;
+            while (indent < physical.size() && physical.at(indent) == ' ') {
+                ++indent;
+            }
+            physical = physical.mid(indent);
+        }
+        if (dollars % 2 == 1) {
+            physical.chop(1);
+            line += physical;
+            continue;
+        }
+        line += physical;
+
+        if (line.startsWith("build ")) {
+            parseBuild(line, 6);
+        } else if (line.startsWith("include ") || line.startsWith("subninja ")) {
+            QByteArray name = line.mid(line.indexOf(' ') + 1).trimmed();
+            if (depth >= MaxIncludeDepth || !parseFile(QDir(m_baseDir).filePath(QString::fromUtf8(name)), depth + 1)) {
+                return false;
+            }
+        }
+        line.clear();
+    }
+    return true;
+}
+
+void NinjaManifest::parseBuild(const QByteArray &line, int from)
+{
+    const QList<QByteArray> tokens = tokenize(line, from);
+
+    // outputs [| implicit outputs] : rule inputs [| implicit] [|| order-only] [|@ validations]
+    NinjaBuildEdge edge;
+    int i = 0;
+    for (; i < tokens.size() && tokens.at(i) != ":"; ++i) {
+        if (tokens.at(i) != "|") {
+            edge.outputs.append(intern(tokens.at(i)));
+        }
+    }
+    if (i + 1 >= tokens.size() || edge.outputs.isEmpty()) {
+        return;
+    }
+    edge.rule = tokens.at(i + 1);
+    bool orderOnly = false;
+    for (i += 2; i < tokens.size(); ++i) {
+        const QByteArray &token = tokens.at(i);
+        if (token == "|@") {
+            break;
+        }
+        if (token == "||") {
+            orderOnly = true;
+        } else if (token != "|") {
+            (orderOnly ? edge.orderOnly : edge.inputs).append(intern(token));
+        }
+    }
+
+    int index = m_edges.size();
+    for (int output : edge.outputs) {
+        m_producers[output] = index;
+    }
+    m_edges.append(edge);
+}
+
+const QVector<NinjaBuildEdge> &NinjaManifest::edges() const
+{
+    return m_edges;
+}
+
+int NinjaManifest::intern(const QByteArray &path)
+{
+    auto it = m_ids.constFind(path);
+    if (it != m_ids.constEnd()) {
+        return it.value();
+    }
+    int id = m_paths.size();
+    m_paths.append(path);
+    m_producers.append(-1);
+    m_ids.insert(path, id);
+    return id;
+}
+
+int NinjaManifest::find(const QByteArray &path) const
+{
+    return m_ids.value(path, -1);
+}
+
+QByteArray NinjaManifest::path(int node) const
+{
+    return m_paths.value(node);
+}
+
+int NinjaManifest::nodeCount() const
+{
+    return m_paths.size();
+}
+
+int NinjaManifest::producer(int node) const
+{
+    return m_producers.value(node, -1);
+}
+
+QString NinjaManifest::errorString() const
+{
+    return m_errorString;
+}
@@ -0,0 +1,60 @@
+#ifndef NINJAMANIFEST_H
+#define NINJAMANIFEST_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// A build statement of build.ninja, with paths as node ids
+struct NinjaBuildEdge
+{
+    QByteArray rule;
+    QVector<int> outputs;    // Explicit and implicit outputs
+    QVector<int> inputs;     // Explicit and implicit inputs
+    QVector<int> orderOnly;  // Built first, but never cause a rebuild
+};
+
+// Reader for the build statements of a build.ninja and the files it
+// includes. Rules, pools and variables are skipped; paths keep ninja's
+// spelling, relative to the build directory unless absolute.
+class NinjaManifest
+{
+public:
+    NinjaManifest();
+
+    // Parse a manifest; returns false if it or a file it includes is missing
+    bool load(const QString &filePath);
+
+    // The conventional manifest location inside a build directory
+    static QString defaultPath(const QString &buildDir);
+
+    const QVector<NinjaBuildEdge> &edges() const;
+
+    // Node id of a path, adding it if it is new
+    int intern(const QByteArray &path);
+
+    // Node id of a path, or -1
+    int find(const QByteArray &path) const;
+
+    QByteArray path(int node) const;
+    int nodeCount() const;
+
+    // Edge producing a node, or -1 for sources
+    int producer(int node) const;
+
+    QString errorString() const;
+
+private:
+    QVector<NinjaBuildEdge> m_edges;
+    QVector<QByteArray> m_paths;
+    QHash<QByteArray, int> m_ids;
+    QVector<int> m_producers;
+    QString m_baseDir;
+    QString m_errorString;
+
+    bool parseFile(const QString &filePath, int depth);
+    void parseBuild(const QByteArray &line, int from);
+};
+
+#endif // NINJAMANIFEST_H
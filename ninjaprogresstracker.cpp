@@ -0,0 +1,178 @@
+#include "ninjaprogresstracker.h"
+#include "ninjalog.h"
+
+#include <algorithm>
+
+namespace {
+
+// Window over which throughput is averaged
+const qint64 ThroughputWindowMs = 10000;
+
+// Parse digits up to a terminator; advances the cursor past the terminator
+bool parseCount(const char *&cursor, const char *end, char terminator, int &value)
+{
+    value = 0;
+    const char *begin = cursor;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        ++cursor;
+    }
+    if (cursor == begin || cursor >= end || *cursor != terminator) {
+        return false;
+    }
+    ++cursor;
+    return true;
+}
+
+} // namespace
+
+NinjaProgressTracker::NinjaProgressTracker()
+    : m_updated(false)
+    , m_started(false)
+{
+}
+
+QString NinjaProgressTracker::statusFormat()
+{
+    return "[ninja %f/%t/%r] ";
+}
+
+void NinjaProgressTracker::reset(const QString &buildDir)
+{
+    m_progress = BuildProgress();
+    m_updated = false;
+    m_started = false;
+    m_samples.clear();
+    m_completionCurve.clear();
+
+    // Build the completion curve from the largest previous run
+    NinjaLog log;
+    if (!log.load(NinjaLog::defaultPath(buildDir))) {
+        return;
+    }
+    QVector<NinjaEdge> edges = log.largestRun();
+    if (edges.size() < 10) {
+        return;
+    }
+
+    QVector<qint64> ends;
+    ends.reserve(edges.size());
+    qint64 firstStart = edges.first().start;
+    for (const NinjaEdge &edge : edges) {
+        ends.append(edge.end);
+        firstStart = qMin(firstStart, edge.start);
+    }
+    std::sort(ends.begin(), ends.end());
+
+    double wallTime = double(ends.last() - firstStart);
+    if (wallTime <= 0) {
+        return;
+    }
+
+    m_completionCurve.reserve(ends.size() + 1);
+    m_completionCurve.append(0.0);
+    for (qint64 end : ends) {
+        m_completionCurve.append(double(end - firstStart) / wallTime);
+    }
+}
+
+bool NinjaProgressTracker::processLine(const char *line, int length)
+{
+    static const char prefix[] = "[ninja ";
+    const int prefixLength = sizeof(prefix) - 1;
+    if (length <= prefixLength || qstrncmp(line, prefix, prefixLength) != 0) {
+        return false;
+    }
+
+    const char *cursor = line + prefixLength;
+    const char *end = line + length;
+    int finished, total, running;
+    if (!parseCount(cursor, end, '/', finished) || !parseCount(cursor, end, '/', total) ||
+        !parseCount(cursor, end, ']', running)) {
+        return false;
+    }
+
+    // A drop in the finished count means a new ninja invocation (e.g. install),
+    // which the history of the main build does not describe
+    if (!m_started || finished < m_progress.finishedEdges) {
+        if (m_started) {
+            m_completionCurve.clear();
+        }
+        m_started = true;
+        m_timer.start();
+        m_samples.clear();
+    }
+
+    qint64 now = m_timer.elapsed();
+    if (m_samples.isEmpty() || m_samples.last().second != finished) {
+        m_samples.enqueue(qMakePair(now, finished));
+    }
+    while (m_samples.size() > 2 && now - m_samples.head().first > ThroughputWindowMs) {
+        m_samples.dequeue();
+    }
+
+    m_progress.finishedEdges = finished;
+    m_progress.totalEdges = total;
+    m_progress.runningEdges = running;
+    m_updated = true;
+    return true;
+}
+
+bool NinjaProgressTracker::hasUpdate() const
+{
+    return m_updated;
+}
+
+BuildProgress NinjaProgressTracker::progress()
+{
+    if (m_started) {
+        updateEstimates();
+    }
+    m_updated = false;
+    return m_progress;
+}
+
+void NinjaProgressTracker::updateEstimates()
+{
+    qint64 elapsed = m_timer.elapsed();
+    m_progress.elapsedMs = elapsed;
+
+    // Throughput across the sample window
+    m_progress.edgesPerSecond = 0.0;
+    if (m_samples.size() >= 2) {
+        qint64 span = elapsed - m_samples.head().first;
+        int edges = m_progress.finishedEdges - m_samples.head().second;
+        if (span > 0) {
+            m_progress.edgesPerSecond = edges * 1000.0 / span;
+        }
+    }
+
+    int finished = m_progress.finishedEdges;
+    int total = m_progress.totalEdges;
+    m_progress.etaMs = -1;
+    m_progress.historyWeighted = false;
+
+    if (total > 0 && finished >= total) {
+        m_progress.etaMs = 0;
+        return;
+    }
+
+    // Map progress onto the historical curve, scaling for a different edge count
+    if (!m_completionCurve.isEmpty() && total > 0 && finished > 0) {
+        double position = double(finished) / total * (m_completionCurve.size() - 1);
+        int index = qMin(int(position), m_completionCurve.size() - 2);
+        double fraction = position - index;
+        double done = m_completionCurve.at(index) +
+                      (m_completionCurve.at(index + 1) - m_completionCurve.at(index)) * fraction;
+        if (done > 0.01 && done < 1.0) {
+            m_progress.etaMs = qint64(elapsed * (1.0 - done) / done);
+            m_progress.historyWeighted = true;
+            return;
+        }
+    }
+
+    // Fall back to the current edge rate
+    if (m_progress.edgesPerSecond > 0.0 && total > 0) {
+        m_progress.etaMs = qint64((total - finished) / m_progress.edgesPerSecond * 1000.0);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef NINJAPROGRESSTRACKER_H
+#define NINJAPROGRESSTRACKER_H
+
+#include "buildprogress.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QQueue>
+#include <QString>
+#include <QVector>
+
+// Follows ninja's status lines and turns them into BuildProgress.
+//
+// The executor sets NINJA_STATUS to statusFormat(), so every status line
+// starts with "[ninja finished/total/running] ". When a previous
+// .ninja_log is available, the ETA follows the completion curve of that
+// build instead of assuming a constant edge rate, which keeps it honest
+// through the long link tail at the end of an LLVM build.
+class NinjaProgressTracker
+{
+public:
+    NinjaProgressTracker();
+
+    // The NINJA_STATUS value the parser understands
+    static QString statusFormat();
+
+    // Start tracking a new build, loading history from the build directory
+    void reset(const QString &buildDir);
+
+    // Inspect one output line; returns true if it was a status line
+    bool processLine(const char *line, int length);
+
+    // Check if the progress changed since the last call to progress()
+    bool hasUpdate() const;
+
+    // Current progress snapshot
+    BuildProgress progress();
+
+private:
+    BuildProgress m_progress;
+    bool m_updated;
+    bool m_started;
+    QElapsedTimer m_timer;
+
+    // Recent (elapsed ms, finished edges) samples for the throughput gauge
+    QQueue<QPair<qint64, int>> m_samples;
+
+    // Fraction of the historical wall time spent when each edge finished,
+    // indexed by completed edge count
+    QVector<double> m_completionCurve;
+
+    void updateEstimates();
+};
+
+#endif // NINJAPROGRESSTRACKER_H
@@ -0,0 +1,226 @@
+#include "pgopipeline.h"
+#include "resourceplanner.h"
+#include "cmakestate.h"
+#include "compilercache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+
+namespace {
+
+// Extensions of the corpus files the training run compiles
+const char *const CorpusCFiles = "-name '*.c'";
+const char *const CorpusCxxFiles = "-name '*.cpp' -o -name '*.cc' -o -name '*.cxx'";
+
+QString quoted(const QString &path)
+{
+    return "\"" + path + "\"";
+}
+
+} // namespace
+
+PgoPipeline::PgoPipeline(const BuilderConfiguration &config)
+    : PgoPipeline(config, ResourcePlanner::plan(config))
+{
+}
+
+PgoPipeline::PgoPipeline(const BuilderConfiguration &config, const ResourcePlan &plan)
+    : m_config(config)
+    , m_plan(plan)
+    , m_stage1(config)
+    , m_stage2(config)
+    , m_final(config)
+{
+    // Stage 1 only needs a compiler, a linker, the profile runtime and the
+    // tools, for the host and as quickly as possible
+    m_stage1.setBuildDir(stageDir("stage1"));
+    m_stage1.setProjects("clang;lld");
+    m_stage1.setRuntimes("compiler-rt");
+    m_stage1.setArch("Native");
+    m_stage1.setNoLto(true);
+    m_stage1.setFullLto(false);
+    m_stage1.setUseDylib(false);
+    m_stage1.setXcodeToolchain(false);
+    m_stage1.setModules(false);
+    m_stage1.setDoTesting(false);
+    m_stage1.setBenchmark(false);
+    m_stage1.setTimeTrace(false);
+    m_stage1.setUseDistribution(false);
+    m_stage1.setBoltOptimize(false);
+
+    // Stage 2 is the compiler whose behaviour is profiled
+    m_stage2 = m_stage1;
+    m_stage2.setBuildDir(stageDir("stage2-instrumented"));
+    m_stage2.setCompilerPath(stageDir("stage1"));
+    m_stage2.setCompiler("clang");
+    m_stage2.setCxxCompiler("clang++");
+    m_stage2.setUseXcodeGcc(false);
+    m_stage2.setRuntimes("");
+    m_stage2.setArch(config.arch());
+
+    // Stage 3 is the configured build, compiled by stage 1
+    m_final.setBuildDir(stageDir("stage3"));
+    m_final.setCompilerPath(stageDir("stage1"));
+    m_final.setCompiler("clang");
+    m_final.setCxxCompiler("clang++");
+    m_final.setUseXcodeGcc(false);
+    m_final.setSkipGitPull(true);
+    m_final.setPgoPipeline(false);
+}
+
+QString PgoPipeline::generateTrainingStages() const
+{
+    QString command = "mkdir -p " + quoted(m_config.buildDir()) + " && cd " + quoted(m_config.buildDir()) +
+                      " || exit 1\n\n";
+
+    // Stage 3 cleans its own directory and keeps its staged CMake state
+    if (m_config.cleanBuildDir()) {
+        command += CommandGenerator::stageMarker("clean");
+        command += "rm -rf " + quoted(stageDir("stage1")) + " " + quoted(stageDir("stage2-instrumented")) + " " +
+                   quoted(stageDir("profiles")) + " " + quoted(stageDir("profdata")) + "\n\n";
+    }
+
+    // Stages 1 and 2 compile through the launcher too, so the cache needs its
+    // directory and size before them; stage 3 resets the counters again so
+    // the build report counts its own compiles
+    if (CompilerCache::isEnabled(m_config)) {
+        command += CompilerCache::setupCommands(m_config, true) + "\n";
+    }
+
+    // Stage 2 and the profile describe the checked-out sources, which the
+    // pull may just have moved; stage 1 only has to compile them
+    command += "llvm_revision=$(git -C " + quoted(m_config.llvmDir()) + " rev-parse HEAD 2>/dev/null)\n\n";
+
+    command += stamped(stageDir("stage1"), stage1Digest(), "Stage 1", stage1Commands());
+    command += stamped(stageDir("stage2-instrumented"), stage2Digest() + "-$llvm_revision", "Stage 2",
+                       stage2Commands());
+    command += stamped(stageDir("profdata"), profileDigest() + "-$llvm_revision", "The training profile",
+                       profileCommands());
+    command += "mkdir -p " + quoted(stageDir("stage3")) + " || exit 1\n\n";
+    return command;
+}
+
+const BuilderConfiguration &PgoPipeline::finalConfig() const
+{
+    return m_final;
+}
+
+QVector<CMakeDefine> PgoPipeline::finalDefines() const
+{
+    return QVector<CMakeDefine>() << CMakeDefine{"LLVM_PROFDATA_FILE", profdataPath(), false};
+}
+
+QString PgoPipeline::profdataPath() const
+{
+    // Named after the training, so a new profile changes stage 3's CMake
+    // arguments and with them every compile command
+    return QDir(stageDir("profdata")).filePath("clang-" + profileDigest() + ".profdata");
+}
+
+QString PgoPipeline::stageDir(const QString &name) const
+{
+    return QDir(m_config.buildDir()).filePath(name);
+}
+
+QString PgoPipeline::stageDigest(const QString &previous, const QString &inputs)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(previous.toUtf8() + '\n' + inputs.toUtf8());
+    return QString::fromLatin1(hash.result().toHex().left(12));
+}
+
+QString PgoPipeline::stamped(const QString &dir, const QString &digest, const QString &title, const QString &commands)
+{
+    QString stamp = quoted(QDir(dir).filePath(".llvmbuilder_stage"));
+    return "if [ \"$(cat " + stamp + " 2>/dev/null)\" = \"" + digest + "\" ]; then\n"
+           "echo \"" + title + " is up to date, skipping it\"\n"
+           "else\n" +
+           commands +
+           "echo \"" + digest + "\" > " + stamp + "\n"
+           "fi\n\n";
+}
+
+QString PgoPipeline::stage1Commands() const
+{
+    CommandGenerator generator(m_stage1, m_plan);
+    QString dir = stageDir("stage1");
+    return CommandGenerator::stageMarker("pgo-stage1") +
+           "mkdir -p " + quoted(dir) + " && cd " + quoted(dir) + " || exit $?\n" +
+           generator.generateCMakeCommand() + " || exit $?\n" +
+           generator.generateBuildExecutionCommand() + " || exit $?\n";
+}
+
+QString PgoPipeline::stage2Commands() const
+{
+    CommandGenerator generator(m_stage2, m_plan);
+    generator.setExtraDefines(stage2Defines());
+    QString dir = stageDir("stage2-instrumented");
+    return CommandGenerator::stageMarker("pgo-stage2") +
+           "mkdir -p " + quoted(dir) + " && cd " + quoted(dir) + " || exit $?\n" +
+           generator.generateCMakeCommand() + " || exit $?\n" +
+           generator.generateBuildExecutionCommand() + " clang || exit $?\n";
+}
+
+QString PgoPipeline::corpusCommands(const BuilderConfiguration &config, const QString &binDir,
+                                    const QString &buildDir, int jobs, const QString &environment)
+{
+    // Without a corpus, train on LLVM's own Support library
+    QString corpus = config.pgoCorpus();
+    QString flags = config.pgoCorpusFlags();
+    if (corpus.isEmpty()) {
+        corpus = config.llvmDir() + "/llvm/lib/Support";
+        flags = "-std=c++17 -I" + quoted(config.llvmDir() + "/llvm/include") + " -I" +
+                quoted(buildDir + "/include") + " " + flags;
+    }
+
+    // Compile failures in the corpus do not matter as long as the compiler ran
+    QString run = environment + (environment.isEmpty() ? "" : " ") + "xargs -0 -n 1 -P " + QString::number(jobs) + " ";
+    return "find " + quoted(corpus) + " -type f \\( " + CorpusCFiles + " \\) -print0 | " + run +
+           quoted(binDir + "/clang") + " -O2 -w -c -o /dev/null " + flags + "\n" +
+           "find " + quoted(corpus) + " -type f \\( " + CorpusCxxFiles + " \\) -print0 | " + run +
+           quoted(binDir + "/clang++") + " -O2 -w -c -o /dev/null " + flags + "\n";
+}
+
+QString PgoPipeline::trainingCommands() const
+{
+    QString profiles = stageDir("profiles");
+    return CommandGenerator::stageMarker("pgo-train") +
+           "rm -rf " + quoted(profiles) + " && mkdir -p " + quoted(profiles) + " || exit $?\n" +
+           corpusCommands(m_config, stageDir("stage2-instrumented") + "/bin", stageDir("stage2-instrumented"),
+                          m_plan.compileJobs, "LLVM_PROFILE_FILE=" + quoted(profiles + "/%m-%p.profraw"));
+}
+
+QString PgoPipeline::profileCommands() const
+{
+    QString dir = stageDir("profdata");
+    return trainingCommands() +
+           CommandGenerator::stageMarker("pgo-merge") +
+           "mkdir -p " + quoted(dir) + " || exit $?\n" +
+           quoted(stageDir("stage1") + "/bin/llvm-profdata") + " merge -output=" + quoted(profdataPath()) + " " +
+           quoted(stageDir("profiles")) + "/*.profraw || exit $?\n";
+}
+
+QVector<CMakeDefine> PgoPipeline::stage2Defines()
+{
+    return QVector<CMakeDefine>() << CMakeDefine{"LLVM_BUILD_INSTRUMENTED", "IR", false}
+                                  << CMakeDefine{"LLVM_BUILD_RUNTIME", "OFF", false};
+}
+
+// The digests leave out job counts, which follow the host's free memory
+QString PgoPipeline::stage1Digest() const
+{
+    CommandGenerator generator(m_stage1, m_plan);
+    return stageDigest(QString(), CMakeState::fromGenerator(generator).digest());
+}
+
+QString PgoPipeline::stage2Digest() const
+{
+    CommandGenerator generator(m_stage2, m_plan);
+    generator.setExtraDefines(stage2Defines());
+    return stageDigest(stage1Digest(), CMakeState::fromGenerator(generator).digest());
+}
+
+QString PgoPipeline::profileDigest() const
+{
+    return stageDigest(stage2Digest(), m_config.pgoCorpus() + "\n" + m_config.pgoCorpusFlags());
+}
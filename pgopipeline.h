@@ -0,0 +1,76 @@
+#ifndef PGOPIPELINE_H
+#define PGOPIPELINE_H
+
+#include "builderconfiguration.h"
+#include "commandgenerator.h"
+
+#include <QString>
+#include <QVector>
+
+// A profile-guided bootstrap in separate directories under the build
+// directory:
+//   stage1              host-compiled clang, lld and the profile runtime
+//   stage2-instrumented clang built by stage 1 with LLVM_BUILD_INSTRUMENTED
+//   profiles, profdata  a training run of stage 2 over a corpus, merged
+//   stage3              the configured build, compiled by stage 1 with
+//                       LLVM_PROFDATA_FILE
+// Stages 1 and 2 and the profile are stamped with a digest of their
+// CMake arguments or corpus, stage 2 and the profile also with the source
+// revision, so a later run skips whatever is still current and a failed
+// stage 3 is retried on its own.
+class PgoPipeline
+{
+public:
+    // Plans the job counts for this host, or takes those of the build
+    explicit PgoPipeline(const BuilderConfiguration &config);
+    PgoPipeline(const BuilderConfiguration &config, const ResourcePlan &plan);
+
+    // Commands for stage 1, stage 2 and the profile, each skipped when current
+    QString generateTrainingStages() const;
+
+    // The configuration of the final stage, built like a plain build
+    const BuilderConfiguration &finalConfig() const;
+
+    // Cache entries the final stage adds to its configuration
+    QVector<CMakeDefine> finalDefines() const;
+
+    // Merged profile of the current training stages
+    QString profdataPath() const;
+
+    // Directory of a stage under the build directory
+    QString stageDir(const QString &name) const;
+
+    // Compile the training corpus with the clang and clang++ in binDir, jobs
+    // files at a time, the environment assignments given before each run;
+    // buildDir provides the generated headers the default corpus includes
+    static QString corpusCommands(const BuilderConfiguration &config, const QString &binDir,
+                                  const QString &buildDir, int jobs, const QString &environment = QString());
+
+private:
+    BuilderConfiguration m_config;
+    ResourcePlan m_plan;
+    BuilderConfiguration m_stage1;
+    BuilderConfiguration m_stage2;
+    BuilderConfiguration m_final;
+
+    // Short digest of a stage's inputs chained to the stage before it
+    static QString stageDigest(const QString &previous, const QString &inputs);
+
+    // Cache entries that make stage 2 instrumented
+    static QVector<CMakeDefine> stage2Defines();
+
+    // Wrap commands so they only run when the stamp in dir is not digest
+    static QString stamped(const QString &dir, const QString &digest, const QString &title, const QString &commands);
+
+    // Commands of each stage; the profile is the training run and the merge
+    QString stage1Commands() const;
+    QString stage2Commands() const;
+    QString trainingCommands() const;
+    QString profileCommands() const;
+
+    QString stage1Digest() const;
+    QString stage2Digest() const;
+    QString profileDigest() const;
+};
+
+#endif // PGOPIPELINE_H
@@ -0,0 +1,269 @@
+#include "rebuildforecast.h"
+#include "builderconfiguration.h"
+#include "cmakestate.h"
+#include "ninjadeps.h"
+#include "ninjalog.h"
+#include "ninjamanifest.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QProcess>
+
+#include <algorithm>
+
+namespace {
+
+// Duration assumed for an edge missing from .ninja_log when the log is empty
+const qint64 DefaultEdgeMs = 1000;
+
+// Run git in the source tree and split its output into lines
+bool gitLines(const QString &sourceDir, const QStringList &arguments, QStringList &lines)
+{
+    QProcess git;
+    git.start("git", QStringList() << "-C" << sourceDir << arguments);
+    if (!git.waitForFinished(60000) || git.exitStatus() != QProcess::NormalExit || git.exitCode() != 0) {
+        return false;
+    }
+    lines = QString::fromUtf8(git.readAllStandardOutput()).split('\n', Qt::SkipEmptyParts);
+    return true;
+}
+
+// Wall time of the included edges: the total work spread over the jobs,
+// but never less than the longest chain of edges that wait on each other
+qint64 wallTime(const NinjaManifest &manifest, const QVector<QVector<int>> &inputs, const QVector<qint64> &cost,
+                const QVector<bool> &included, int jobs)
+{
+    const int count = cost.size();
+    QVector<qint64> finish(count, -1);   // -2 while an edge's inputs are being visited
+    QVector<int> cursor(count, 0);
+    QVector<int> stack;
+    qint64 total = 0;
+    qint64 longest = 0;
+
+    for (int root = 0; root < count; ++root) {
+        if (!included.at(root)) {
+            continue;
+        }
+        total += cost.at(root);
+        if (finish.at(root) >= 0) {
+            longest = qMax(longest, finish.at(root));
+            continue;
+        }
+
+        // Depth-first over the producers of each edge's inputs
+        finish[root] = -2;
+        stack.append(root);
+        while (!stack.isEmpty()) {
+            int edge = stack.last();
+            bool descended = false;
+            while (cursor.at(edge) < inputs.at(edge).size()) {
+                int producer = manifest.producer(inputs.at(edge).at(cursor[edge]++));
+                if (producer >= 0 && included.at(producer) && finish.at(producer) == -1) {
+                    finish[producer] = -2;
+                    stack.append(producer);
+                    descended = true;
+                    break;
+                }
+            }
+            if (descended) {
+                continue;
+            }
+
+            qint64 ready = 0;
+            for (int input : inputs.at(edge)) {
+                int producer = manifest.producer(input);
+                if (producer >= 0 && included.at(producer)) {
+                    ready = qMax(ready, finish.at(producer));
+                }
+            }
+            finish[edge] = ready + cost.at(edge);
+            stack.removeLast();
+        }
+        longest = qMax(longest, finish.at(root));
+    }
+
+    return qMax(total / qMax(1, jobs), longest);
+}
+
+QString minutes(qint64 milliseconds)
+{
+    return QString::number(milliseconds / 60000.0, 'f', 1) + " min";
+}
+
+} // namespace
+
+QString RebuildForecast::summary() const
+{
+    if (!valid) {
+        return "No rebuild forecast: " + errorString;
+    }
+    return QString("Rebuild forecast since %1: %2 changed files%3, %4 of %5 edges to rebuild%6; "
+                   "incremental about %7, clean about %8")
+        .arg(builtRevision.left(12))
+        .arg(changedFiles)
+        .arg(includesUpstream ? " including upstream as of the last fetch" : "")
+        .arg(dirtyEdges)
+        .arg(totalEdges)
+        .arg(reconfigure ? " after CMake re-runs" : "")
+        .arg(minutes(incrementalMs))
+        .arg(minutes(cleanMs));
+}
+
+RebuildForecast RebuildForecaster::forecast(const BuilderConfiguration &config, int jobs)
+{
+    RebuildForecast forecast;
+    const QString buildDir = config.buildDir();
+    const QString sourceDir = config.llvmDir();
+
+    QFile revisionFile(revisionPath(buildDir));
+    if (!revisionFile.open(QIODevice::ReadOnly)) {
+        forecast.errorString = "no successful build recorded in " + buildDir;
+        return forecast;
+    }
+    forecast.builtRevision = QString::fromLatin1(revisionFile.readAll()).trimmed();
+
+    // Committed and uncommitted changes since that build, plus what the pull brings in
+    QStringList changed;
+    if (!gitLines(sourceDir, QStringList() << "diff" << "--name-only" << forecast.builtRevision, changed)) {
+        forecast.errorString = "git diff against " + forecast.builtRevision.left(12) + " failed";
+        return forecast;
+    }
+    if (!config.skipGitPull()) {
+        QStringList upstream;
+        if (gitLines(sourceDir, QStringList() << "diff" << "--name-only" << "HEAD" << "@{u}", upstream)) {
+            changed += upstream;
+            forecast.includesUpstream = true;
+        }
+    }
+    changed.removeDuplicates();
+    forecast.changedFiles = changed.size();
+
+    NinjaManifest manifest;
+    if (!manifest.load(NinjaManifest::defaultPath(buildDir))) {
+        forecast.errorString = manifest.errorString();
+        return forecast;
+    }
+
+    // Inputs of every edge, including the headers the compiler reported;
+    // without a deps log only header changes go unnoticed
+    const QVector<NinjaBuildEdge> &edges = manifest.edges();
+    QVector<QVector<int>> inputs(edges.size());
+    for (int i = 0; i < edges.size(); ++i) {
+        inputs[i] = edges.at(i).inputs;
+    }
+    NinjaDeps deps;
+    if (deps.load(NinjaDeps::defaultPath(buildDir))) {
+        QVector<int> nodes;
+        nodes.reserve(deps.paths().size());
+        for (const QByteArray &path : deps.paths()) {
+            nodes.append(manifest.intern(path));
+        }
+        for (auto it = deps.deps().constBegin(); it != deps.deps().constEnd(); ++it) {
+            int edge = manifest.producer(nodes.at(it.key()));
+            if (edge < 0) {
+                continue;
+            }
+            for (int input : it.value()) {
+                inputs[edge].append(nodes.at(input));
+            }
+        }
+    }
+
+    QVector<QVector<int>> consumers(manifest.nodeCount());
+    for (int i = 0; i < edges.size(); ++i) {
+        for (int input : inputs.at(i)) {
+            consumers[input].append(i);
+        }
+    }
+
+    // Match git's paths, relative to the source tree, against ninja's
+    QDir build(buildDir);
+    QHash<QString, int> nodesByPath;
+    nodesByPath.reserve(manifest.nodeCount());
+    for (int node = 0; node < manifest.nodeCount(); ++node) {
+        QString path = QDir::cleanPath(build.absoluteFilePath(QString::fromUtf8(manifest.path(node))));
+        nodesByPath.insert(path, node);
+    }
+    QDir source(sourceDir);
+    QVector<int> queue;
+    for (const QString &file : changed) {
+        if (file.endsWith("CMakeLists.txt") || file.endsWith(".cmake")) {
+            forecast.reconfigure = true;
+        }
+        int node = nodesByPath.value(QDir::cleanPath(source.absoluteFilePath(file)), -1);
+        if (node >= 0) {
+            queue.append(node);
+        }
+    }
+
+    // Every edge downstream of a changed file runs again
+    QVector<bool> dirty(edges.size(), false);
+    while (!queue.isEmpty()) {
+        int node = queue.takeLast();
+        for (int edge : consumers.at(node)) {
+            if (!dirty.at(edge)) {
+                dirty[edge] = true;
+                queue += edges.at(edge).outputs;
+            }
+        }
+    }
+
+    // Durations from the latest record of each output; unknown edges
+    // are assumed to take as long as a typical one
+    QHash<QByteArray, qint64> durations;
+    QVector<qint64> recorded;
+    NinjaLog log;
+    if (log.load(NinjaLog::defaultPath(buildDir))) {
+        const QVector<NinjaEdge> latest = log.latestEdges();
+        for (const NinjaEdge &edge : latest) {
+            recorded.append(edge.duration());
+            for (const QByteArray &output : edge.outputs) {
+                durations.insert(output, edge.duration());
+            }
+        }
+    }
+    qint64 typical = DefaultEdgeMs;
+    if (!recorded.isEmpty()) {
+        std::nth_element(recorded.begin(), recorded.begin() + recorded.size() / 2, recorded.end());
+        typical = recorded.at(recorded.size() / 2);
+    }
+
+    QVector<qint64> cost(edges.size(), 0);
+    QVector<bool> all(edges.size(), true);
+    for (int i = 0; i < edges.size(); ++i) {
+        const NinjaBuildEdge &edge = edges.at(i);
+        if (edge.rule == "phony") {
+            continue;
+        }
+        qint64 duration = -1;
+        for (int output : edge.outputs) {
+            duration = qMax(duration, durations.value(manifest.path(output), -1));
+        }
+        cost[i] = duration >= 0 ? duration : typical;
+        ++forecast.totalEdges;
+        if (dirty.at(i)) {
+            ++forecast.dirtyEdges;
+        }
+    }
+
+    forecast.incrementalMs = wallTime(manifest, inputs, cost, dirty, jobs);
+    forecast.cleanMs = wallTime(manifest, inputs, cost, all, jobs);
+
+    // A clean build configures from scratch, and so does ninja after a CMake change
+    CMakeState state;
+    if (state.loadFromFile(CMakeState::defaultPath(buildDir))) {
+        forecast.cleanMs += state.configureMs();
+        if (forecast.reconfigure) {
+            forecast.incrementalMs += state.configureMs();
+        }
+    }
+
+    forecast.valid = true;
+    return forecast;
+}
+
+QString RebuildForecaster::revisionPath(const QString &buildDir)
+{
+    return QDir(buildDir).filePath(".llvmbuilder_built_revision");
+}
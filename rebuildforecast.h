@@ -0,0 +1,42 @@
+#ifndef REBUILDFORECAST_H
+#define REBUILDFORECAST_H
+
+#include <QString>
+
+class BuilderConfiguration;
+
+// Predicted cost of bringing a ninja build directory up to date
+struct RebuildForecast
+{
+    bool valid = false;
+    QString errorString;         // Why no forecast could be made
+
+    QString builtRevision;       // Revision of the last successful build
+    bool includesUpstream = false; // The pulled upstream changes were counted
+    int changedFiles = 0;
+    bool reconfigure = false;    // CMake files changed, so ninja re-runs CMake
+    int dirtyEdges = 0;
+    int totalEdges = 0;
+
+    // Predicted wall time in milliseconds
+    qint64 incrementalMs = 0;
+    qint64 cleanMs = 0;
+
+    QString summary() const;
+};
+
+// Forecasts a rebuild from the files changed since the last successful
+// build. Changed sources are found with git; build.ninja and .ninja_deps
+// give the edges that depend on them, and .ninja_log their durations.
+class RebuildForecaster
+{
+public:
+    // Forecast the next build of config at the given parallelism. When
+    // the build pulls, upstream changes are taken from the last fetch.
+    static RebuildForecast forecast(const BuilderConfiguration &config, int jobs);
+
+    // Where the build script records the revision it built successfully
+    static QString revisionPath(const QString &buildDir);
+};
+
+#endif // REBUILDFORECAST_H
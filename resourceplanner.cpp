@@ -0,0 +1,195 @@
+#include "resourceplanner.h"
+#include "builderconfiguration.h"
+
+#include <QFile>
+#include <QThread>
+
+#if defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#endif
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Share of available memory the build may plan with
+const double MemoryHeadroom = 0.85;
+
+// Peak memory of one clang invocation on an LLVM source file
+const qint64 CompileMemoryMB = 1024;
+
+// Typical memory of one lit test, most of which run a tool on a small input
+const qint64 TestMemoryMB = 512;
+
+// Workers beyond this in one lit process mostly wait on its result queue
+const int MaxJobsPerShard = 32;
+
+// Peak memory of one link of a large LLVM tool (clang, lld, lldb)
+const qint64 LinkMemoryNoLtoMB = 2048;
+const qint64 LinkMemoryThinLtoMB = 4096;
+const qint64 LinkMemoryFullLtoMB = 12288;
+
+#if defined(Q_OS_LINUX)
+// Read a "Key:  value kB" line from /proc/meminfo
+qint64 readMeminfoMB(const QByteArray &key)
+{
+    QFile file("/proc/meminfo");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith(key + ':')) {
+            return line.mid(key.size() + 1).trimmed().split(' ').first().toLongLong() / 1024;
+        }
+    }
+    return 0;
+}
+#endif
+
+} // namespace
+
+QString ResourcePlan::summary() const
+{
+    auto gb = [](qint64 mb) { return QString::number(mb / 1024.0, 'f', 1); };
+    return QString("Compile jobs: %1%2 (%3 cores online)\n"
+                   "Link jobs: %4%5 (%6 GB available of %7 GB, ~%8 GB per link)\n"
+                   "Test jobs: %9 lit shard(s) of %10")
+        .arg(compileJobs)
+        .arg(compileJobsOverridden ? ", configured" : "")
+        .arg(onlineCores)
+        .arg(linkJobs)
+        .arg(linkJobsOverridden ? ", configured" : "")
+        .arg(gb(availableMemoryMB))
+        .arg(gb(totalMemoryMB))
+        .arg(gb(memoryPerLinkMB))
+        .arg(testShards)
+        .arg(testJobsPerShard);
+}
+
+ResourcePlan ResourcePlanner::plan(const BuilderConfiguration &config)
+{
+    return plan(config, onlineCores(), totalMemoryMB(), availableMemoryMB());
+}
+
+ResourcePlan ResourcePlanner::plan(const BuilderConfiguration &config, int cores,
+                                   qint64 totalMemory, qint64 availableMemory)
+{
+    ResourcePlan plan;
+    plan.onlineCores = qMax(1, cores);
+    plan.totalMemoryMB = totalMemory;
+    plan.availableMemoryMB = availableMemory > 0 ? availableMemory : totalMemory;
+    plan.memoryPerLinkMB = memoryPerLinkMB(config);
+
+    // An unknown memory size leaves the core count as the only limit
+    qint64 usableMB = qint64(plan.availableMemoryMB * MemoryHeadroom);
+    bool memoryKnown = usableMB > 0;
+
+    // One compile per core, unless memory cannot hold that many
+    if (config.compileJobs() > 0) {
+        plan.compileJobs = config.compileJobs();
+        plan.compileJobsOverridden = true;
+    } else {
+        plan.compileJobs = plan.onlineCores;
+        if (memoryKnown) {
+            plan.compileJobs = int(qBound(qint64(1), usableMB / CompileMemoryMB, qint64(plan.compileJobs)));
+        }
+    }
+
+    // As many concurrent links as fit in memory, never more than compile jobs
+    if (config.linkJobs() > 0) {
+        plan.linkJobs = config.linkJobs();
+        plan.linkJobsOverridden = true;
+    } else {
+        plan.linkJobs = plan.compileJobs;
+        if (memoryKnown) {
+            plan.linkJobs = int(qBound(qint64(1), usableMB / plan.memoryPerLinkMB, qint64(plan.compileJobs)));
+        }
+    }
+
+    plan.loadLimit = plan.compileJobs;
+
+    // Tests run one per core, in as many lit processes as keep each one's
+    // worker pool efficient
+    int testJobs = plan.onlineCores;
+    if (memoryKnown) {
+        testJobs = int(qBound(qint64(1), usableMB / TestMemoryMB, qint64(testJobs)));
+    }
+    plan.testShards = (testJobs + MaxJobsPerShard - 1) / MaxJobsPerShard;
+    plan.testJobsPerShard = qMax(1, testJobs / plan.testShards);
+    return plan;
+}
+
+qint64 ResourcePlanner::memoryPerLinkMB(const BuilderConfiguration &config)
+{
+    qint64 memory = LinkMemoryThinLtoMB;
+    if (config.noLto()) {
+        memory = LinkMemoryNoLtoMB;
+    } else if (config.fullLto()) {
+        memory = LinkMemoryFullLtoMB;
+    }
+
+    // Tools linked against libLLVM pull in far less code each
+    if (config.useDylib()) {
+        memory = memory * 2 / 3;
+    }
+    return memory;
+}
+
+int ResourcePlanner::onlineCores()
+{
+#if defined(Q_OS_UNIX)
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores > 0) {
+        return int(cores);
+    }
+#endif
+    return qMax(1, QThread::idealThreadCount());
+}
+
+qint64 ResourcePlanner::totalMemoryMB()
+{
+#if defined(Q_OS_MACOS)
+    quint64 bytes = 0;
+    size_t size = sizeof(bytes);
+    if (sysctlbyname("hw.memsize", &bytes, &size, nullptr, 0) == 0) {
+        return qint64(bytes / (1024 * 1024));
+    }
+#elif defined(Q_OS_LINUX)
+    qint64 total = readMeminfoMB("MemTotal");
+    if (total > 0) {
+        return total;
+    }
+#endif
+#if defined(Q_OS_UNIX)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) {
+        return qint64(pages) * pageSize / (1024 * 1024);
+    }
+#endif
+    return 0;
+}
+
+qint64 ResourcePlanner::availableMemoryMB()
+{
+#if defined(Q_OS_MACOS)
+    // Free, inactive and purgeable pages can all be handed to the build
+    vm_statistics64_data_t stats;
+    mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+    if (host_statistics64(mach_host_self(), HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&stats), &count) ==
+        KERN_SUCCESS) {
+        quint64 pages = quint64(stats.free_count) + stats.inactive_count + stats.purgeable_count +
+                        stats.speculative_count;
+        return qint64(pages * vm_page_size / (1024 * 1024));
+    }
+#elif defined(Q_OS_LINUX)
+    qint64 available = readMeminfoMB("MemAvailable");
+    if (available > 0) {
+        return available;
+    }
+#endif
+    return totalMemoryMB();
+}
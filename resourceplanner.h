@@ -0,0 +1,49 @@
+#ifndef RESOURCEPLANNER_H
+#define RESOURCEPLANNER_H
+
+#include <QString>
+
+class BuilderConfiguration;
+
+// Job counts for one build, derived from the host and the configuration
+struct ResourcePlan
+{
+    int onlineCores = 1;
+    qint64 totalMemoryMB = 0;
+    qint64 availableMemoryMB = 0;
+    qint64 memoryPerLinkMB = 0;   // Estimated peak of one link job
+    int compileJobs = 1;          // -j and LLVM_PARALLEL_COMPILE_JOBS
+    int linkJobs = 1;             // LLVM_PARALLEL_LINK_JOBS
+    int loadLimit = 1;            // -l
+    int testShards = 1;           // Concurrent lit processes
+    int testJobsPerShard = 1;     // lit -j of each shard
+    bool compileJobsOverridden = false;
+    bool linkJobsOverridden = false;
+
+    // One-paragraph description for the build confirmation
+    QString summary() const;
+};
+
+// Sizes the compile and link pools from online cores and available memory
+// instead of a fixed job count. A configured job count other than 0
+// overrides the derived one.
+class ResourcePlanner
+{
+public:
+    // Probe the host and plan a build of the given configuration
+    static ResourcePlan plan(const BuilderConfiguration &config);
+
+    // Plan for explicitly given host resources
+    static ResourcePlan plan(const BuilderConfiguration &config, int onlineCores,
+                             qint64 totalMemoryMB, qint64 availableMemoryMB);
+
+    // Estimated peak memory of one link for the configuration's LTO and dylib settings
+    static qint64 memoryPerLinkMB(const BuilderConfiguration &config);
+
+    // Host probes
+    static int onlineCores();
+    static qint64 totalMemoryMB();
+    static qint64 availableMemoryMB();
+};
+
+#endif // RESOURCEPLANNER_H
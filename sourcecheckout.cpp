@@ -0,0 +1,102 @@
+#include "sourcecheckout.h"
+#include "commandgenerator.h"
+#include "sourceprefetcher.h"
+
+namespace {
+
+// Directories every build reads: the CMake modules shared by all projects
+// and the bundled third-party code (siphash, benchmark, unittest)
+const char *const RequiredDirectories[] = {"llvm", "cmake", "third-party"};
+
+// Directories a project or runtime includes sources or headers from
+const struct
+{
+    const char *name;
+    const char *needs;   // Space-separated
+} Dependencies[] = {
+    {"clang-tools-extra", "clang"},
+    {"flang", "clang mlir"},
+    {"lldb", "clang"},
+    {"lld", "libunwind"},
+    {"cross-project-tests", "clang lld"},
+    {"libcxxabi", "libcxx"},
+    {"libunwind", "libcxx"},
+    {"llvm-libgcc", "compiler-rt libunwind"},
+    {"flang-rt", "flang"},
+};
+
+QString quoted(const QString &path)
+{
+    return "\"" + path + "\"";
+}
+
+} // namespace
+
+SourceCheckout::SourceCheckout(const BuilderConfiguration &config)
+    : m_config(config)
+{
+}
+
+QStringList SourceCheckout::directories() const
+{
+    QStringList result;
+    for (const char *directory : RequiredDirectories) {
+        result.append(directory);
+    }
+
+    // The projects the build enables, including the ones its stages add,
+    // and the runtimes with the directory that builds them
+    QStringList names = CommandGenerator(m_config).projects().split(';', Qt::SkipEmptyParts);
+    const QStringList runtimes = m_config.runtimes().split(';', Qt::SkipEmptyParts);
+    if (!runtimes.isEmpty()) {
+        names.append("runtimes");
+        names += runtimes;
+    }
+
+    // A PGO pipeline's first stage builds clang, lld and the profile
+    // runtime, which LLVM_ENABLE_RUNTIMES builds from runtimes/
+    if (m_config.pgoPipeline()) {
+        names << "clang" << "lld" << "runtimes" << "compiler-rt";
+    }
+
+    // Dependencies may have dependencies of their own
+    for (int i = 0; i < names.size(); ++i) {
+        for (const auto &dependency : Dependencies) {
+            if (names[i] == dependency.name) {
+                names += QString(dependency.needs).split(' ');
+            }
+        }
+    }
+
+    for (const QString &name : names) {
+        QString directory = name.trimmed();
+        if (!directory.isEmpty() && !result.contains(directory)) {
+            result.append(directory);
+        }
+    }
+    return result;
+}
+
+QString SourceCheckout::generateCommands() const
+{
+    QString llvmDir = m_config.llvmDir();
+
+    // A blobless clone fetches file contents only for what is checked out;
+    // --sparse starts with just the top-level files
+    QString command = CommandGenerator::stageMarker("checkout");
+    command += "if [ ! -d " + quoted(llvmDir + "/.git") + " ]; then\n"
+               "git clone --filter=blob:none --sparse " + quoted(m_config.sourceRepository()) + " " +
+               quoted(llvmDir) + " || exit 1\n"
+               "fi\n";
+    command += "cd " + quoted(llvmDir) + " || exit 1\n";
+
+    // Setting the same cone again is cheap; a changed set of projects adds
+    // or removes directories from the working tree
+    command += "git sparse-checkout set --cone " + directories().join(' ') + " || exit 1\n\n";
+
+    if (!m_config.skipGitPull()) {
+        command += CommandGenerator::stageMarker("git-pull");
+        command += SourcePrefetcher::updateCommand(m_config) + "\n";
+    }
+    return command;
+}
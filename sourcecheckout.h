@@ -0,0 +1,29 @@
+#ifndef SOURCECHECKOUT_H
+#define SOURCECHECKOUT_H
+
+#include "builderconfiguration.h"
+
+#include <QString>
+#include <QStringList>
+
+// Keeps llvmDir as a partial clone of the source repository (no blobs
+// until a checkout needs them) with a cone-mode sparse checkout of just the
+// directories the configured build reads. A missing llvmDir is cloned; an
+// existing full clone is narrowed to the same directories on the next run.
+class SourceCheckout
+{
+public:
+    explicit SourceCheckout(const BuilderConfiguration &config);
+
+    // Top-level directories of the monorepo the build needs
+    QStringList directories() const;
+
+    // Commands that clone or narrow the checkout, then pull unless the
+    // configuration skips it
+    QString generateCommands() const;
+
+private:
+    BuilderConfiguration m_config;
+};
+
+#endif // SOURCECHECKOUT_H
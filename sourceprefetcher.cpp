@@ -0,0 +1,214 @@
+#include "sourceprefetcher.h"
+#include "resourceplanner.h"
+#include "sourcecheckout.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+
+#if defined(Q_OS_UNIX)
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// How often the prefetcher looks for an idle machine and a due fetch
+const int CheckIntervalMs = 60 * 1000;
+
+// Load below this fraction of the core count counts as idle
+const double IdleLoadFactor = 0.25;
+
+// Files CMake and the compiler read from the source tree
+const char *const SourcePatterns[] = {"*.h", "*.cpp", "*.c", "*.def", "*.td", "*.inc", "*.cmake", "CMakeLists.txt"};
+
+QString quoted(const QString &path)
+{
+    return "\"" + path + "\"";
+}
+
+} // namespace
+
+SourcePrefetcher::SourcePrefetcher(const BuilderConfiguration *config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_timer(new QTimer(this))
+    , m_process(new QProcess(this))
+    , m_buildRunning(false)
+{
+    m_process->setStandardInputFile(QProcess::nullDevice());
+    m_process->setStandardOutputFile(QProcess::nullDevice());
+    m_process->setStandardErrorFile(QProcess::nullDevice());
+#if defined(Q_OS_UNIX)
+    // A process group of its own, so stopping the prefetch reaches git and
+    // find rather than only the shell
+    m_process->setChildProcessModifier([]() { setpgid(0, 0); });
+#endif
+    connect(m_process, &QProcess::finished, this, &SourcePrefetcher::handleFinished);
+
+    m_timer->setInterval(CheckIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &SourcePrefetcher::checkPrefetch);
+    m_timer->start();
+}
+
+SourcePrefetcher::~SourcePrefetcher()
+{
+    // git removes its lock files on SIGTERM
+    if (m_process->state() != QProcess::NotRunning) {
+        terminate();
+        m_process->waitForFinished(3000);
+    }
+}
+
+void SourcePrefetcher::setBuildRunning(bool running)
+{
+    m_buildRunning = running;
+
+    // The build fetches or fast-forwards on its own and needs the disk
+    if (running && m_process->state() != QProcess::NotRunning) {
+        terminate();
+    }
+}
+
+void SourcePrefetcher::terminate()
+{
+#if defined(Q_OS_UNIX)
+    qint64 pid = m_process->processId();
+    if (pid > 0 && ::kill(-pid_t(pid), SIGTERM) == 0) {
+        return;
+    }
+#endif
+    m_process->terminate();
+}
+
+bool SourcePrefetcher::isRunning() const
+{
+    return m_process->state() != QProcess::NotRunning;
+}
+
+QString SourcePrefetcher::updateCommand(const BuilderConfiguration &config)
+{
+    // A prefetch an earlier build left running would hold git's locks
+    QString command = stopBackgroundCommand(config);
+    if (!config.prefetchSources()) {
+        return command + "/usr/bin/time -h git pull\n";
+    }
+
+    // A fetch older than two prefetch intervals means the prefetches have
+    // not been running, so the pull goes to the network after all
+    int maxAge = 2 * qMax(1, config.prefetchIntervalMinutes());
+    return command + "if [ -n \"$(find \"$(git rev-parse --git-path FETCH_HEAD)\" -mmin -" + QString::number(maxAge) +
+           " 2>/dev/null)\" ]; then\n"
+           "/usr/bin/time -h git merge --ff-only @{upstream} || /usr/bin/time -h git pull\n"
+           "else\n"
+           "/usr/bin/time -h git pull\n"
+           "fi\n";
+}
+
+QString SourcePrefetcher::prefetchCommand(const BuilderConfiguration &config)
+{
+    QString command = "cd " + quoted(config.llvmDir()) + " || exit 1\n";
+    command += "git fetch --quiet || exit 1\n";
+
+    // A partial clone fetches no file contents; diffing against the new
+    // upstream fetches the changed ones in the checkout in one batch
+    QStringList directories = SourceCheckout(config).directories();
+    if (config.sparseCheckout()) {
+        command += "git diff --numstat HEAD @{upstream} -- " + directories.join(' ') + " > /dev/null\n";
+    }
+
+    // Read the sources once at the lowest priority so the build finds them cached
+    if (config.warmPageCache()) {
+        QStringList patterns;
+        for (const char *pattern : SourcePatterns) {
+            patterns.append(QString("-name '%1'").arg(pattern));
+        }
+        command += "nice -n 19 find " + directories.join(' ') + " -type f \\( " + patterns.join(" -o ") +
+                   " \\) -print0 2>/dev/null | nice -n 19 xargs -0 cat > /dev/null\n";
+    }
+    return command;
+}
+
+QString SourcePrefetcher::backgroundCommand(const BuilderConfiguration &config)
+{
+    // Detached from the script's output, so it may outlive the build. Job
+    // control gives it a process group of its own, so git and find are
+    // stopped along with the subshell; the subshell removes its PID file
+    // however it ends.
+    QString pidFile = quoted(pidPath(config));
+    return "set -m\n"
+           "(\n"
+           "trap 'rm -f " + pidFile + "' EXIT\n" +
+           prefetchCommand(config) +
+           ") < /dev/null > /dev/null 2>&1 &\n"
+           "echo $! > " + pidFile + "\n"
+           "set +m\n";
+}
+
+QString SourcePrefetcher::stopBackgroundCommand(const BuilderConfiguration &config)
+{
+    // git removes its lock files on SIGTERM; the wait gives it the time to
+    QString pidFile = quoted(pidPath(config));
+    return "prefetch_pid=$(cat " + pidFile + " 2>/dev/null)\n"
+           "if [ -n \"$prefetch_pid\" ] && kill -TERM -- -\"$prefetch_pid\" 2>/dev/null; then\n"
+           "echo \"Stopping the background prefetch\"\n"
+           "for i in $(seq 1 30); do kill -0 -- -\"$prefetch_pid\" 2>/dev/null || break; sleep 1; done\n"
+           "fi\n"
+           "rm -f " + pidFile + "\n";
+}
+
+QString SourcePrefetcher::pidPath(const BuilderConfiguration &config)
+{
+    return QDir(config.llvmDir()).filePath(".git/llvmbuilder_prefetch.pid");
+}
+
+void SourcePrefetcher::checkPrefetch()
+{
+    if (!m_config->prefetchSources() || m_buildRunning || isRunning() || m_config->llvmDir().isEmpty() ||
+        !QFileInfo::exists(QDir(m_config->llvmDir()).filePath(".git"))) {
+        return;
+    }
+
+    // A build script's prefetch is still going
+    if (QFileInfo::exists(pidPath(*m_config))) {
+        return;
+    }
+
+    qint64 age = minutesSinceFetch();
+    if ((age >= 0 && age < m_config->prefetchIntervalMinutes()) || !machineIdle()) {
+        return;
+    }
+
+    m_process->setWorkingDirectory(m_config->llvmDir());
+    m_process->start("/bin/bash", QStringList() << "-c" << prefetchCommand(*m_config));
+}
+
+void SourcePrefetcher::handleFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        emit prefetchFinished(true, "Sources prefetched");
+    } else if (!m_buildRunning) {
+        emit prefetchFinished(false, "Source prefetch failed");
+    }
+}
+
+qint64 SourcePrefetcher::minutesSinceFetch() const
+{
+    QFileInfo fetchHead(QDir(m_config->llvmDir()).filePath(".git/FETCH_HEAD"));
+    if (!fetchHead.exists()) {
+        return -1;
+    }
+    return fetchHead.lastModified().secsTo(QDateTime::currentDateTime()) / 60;
+}
+
+bool SourcePrefetcher::machineIdle()
+{
+#if defined(Q_OS_UNIX)
+    double load = 0.0;
+    if (getloadavg(&load, 1) == 1) {
+        return load < ResourcePlanner::onlineCores() * IdleLoadFactor;
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef SOURCEPREFETCHER_H
+#define SOURCEPREFETCHER_H
+
+#include "builderconfiguration.h"
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QTimer>
+
+// Fetches the LLVM sources in the background, and optionally reads the
+// directories the build will compile into the page cache, so a build's
+// git-pull step is a local fast-forward. Prefetches run while no build is
+// running and the machine is idle, and from the build script itself once
+// the build is done and only the install and tests remain.
+class SourcePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The configuration is read at every check, so it follows the UI
+    explicit SourcePrefetcher(const BuilderConfiguration *config, QObject *parent = nullptr);
+    ~SourcePrefetcher();
+
+    // A running build stops a prefetch and defers new ones until it finishes
+    void setBuildRunning(bool running);
+
+    bool isRunning() const;
+
+    // The git-pull step: stop a background prefetch still running, then
+    // fast-forward to the prefetched upstream while the last fetch is
+    // recent, or pull otherwise
+    static QString updateCommand(const BuilderConfiguration &config);
+
+    // Fetch, and warm the page cache if configured
+    static QString prefetchCommand(const BuilderConfiguration &config);
+
+    // The prefetch detached from the build script, for the stages after the
+    // build; its process group is recorded in pidPath()
+    static QString backgroundCommand(const BuilderConfiguration &config);
+
+signals:
+    // A prefetch ended, for the status bar
+    void prefetchFinished(bool success, const QString &message);
+
+private slots:
+    // Start a prefetch if one is due and the machine is idle
+    void checkPrefetch();
+
+    void handleFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    const BuilderConfiguration *m_config;
+    QTimer *m_timer;
+    QProcess *m_process;
+    bool m_buildRunning;
+
+    // Send SIGTERM to the prefetch's process group
+    void terminate();
+
+    // Minutes since the last fetch of llvmDir, -1 when it was never fetched
+    qint64 minutesSinceFetch() const;
+
+    // Whether other work leaves the machine to the prefetch
+    static bool machineIdle();
+
+    // Terminate the background prefetch's process group and wait for it to exit
+    static QString stopBackgroundCommand(const BuilderConfiguration &config);
+
+    // Where a background prefetch records its process group while it runs
+    static QString pidPath(const BuilderConfiguration &config);
+};
+
+#endif // SOURCEPREFETCHER_H
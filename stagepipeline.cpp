@@ -0,0 +1,115 @@
+#include "stagepipeline.h"
+#include "distributionplanner.h"
+#include "littestrunner.h"
+#include "resourceplanner.h"
+
+namespace {
+
+// What can start once a component is linked
+const struct
+{
+    const char *project;
+    const char *installComponents;   // Space-separated
+    const char *checkTarget;
+    const char *suite;
+} PipelinedComponents[] = {
+    {"clang", "clang clang-resource-headers", "check-clang", "tools/clang/test"},
+    {"lld", "lld", "check-lld", "tools/lld/test"},
+};
+
+} // namespace
+
+StagePipeline::StagePipeline(const BuilderConfiguration &config, const ResourcePlan &plan)
+    : m_config(config)
+    , m_plan(plan)
+{
+}
+
+bool StagePipeline::isEnabled() const
+{
+    return m_config.pipelineStages() && !m_config.useMake() && !m_config.dryRun() &&
+           (installsEarly() || m_config.doTesting()) && !components().isEmpty();
+}
+
+QStringList StagePipeline::components() const
+{
+    QStringList result;
+    const QStringList projects = m_config.projects().split(';', Qt::SkipEmptyParts);
+    for (const auto &entry : PipelinedComponents) {
+        if (projects.contains(entry.project)) {
+            result.append(entry.project);
+        }
+    }
+    return result;
+}
+
+QStringList StagePipeline::targets() const
+{
+    // A distribution installs only its own components, optionally stripped
+    const QStringList distributed = DistributionPlanner::components(m_config);
+    bool distribution = m_config.useDistribution() && !distributed.isEmpty();
+    QString suffix = distribution && m_config.stripDistribution() ? "-stripped" : "";
+
+    QStringList result;
+    const QStringList enabled = components();
+    for (const auto &entry : PipelinedComponents) {
+        if (!enabled.contains(entry.project)) {
+            continue;
+        }
+        if (installsEarly()) {
+            const QStringList installComponents = QString(entry.installComponents).split(' ');
+            for (const QString &component : installComponents) {
+                if (!distribution || distributed.contains(component)) {
+                    result.append("install-" + component + suffix);
+                }
+            }
+        }
+        if (m_config.doTesting()) {
+            result.append(entry.checkTarget);
+        }
+    }
+    return result;
+}
+
+QString StagePipeline::environment() const
+{
+    if (!isEnabled() || !m_config.doTesting()) {
+        return QString();
+    }
+
+    // lit shares the machine with the build, must not fail it, and writes a
+    // report of its own for every check target; it splits LIT_OPTS like a shell
+    QString report = LitTestRunner::resultsDir(m_config.buildDir()) + "/early.json";
+    return "LIT_OPTS=\"-s --ignore-fail -j" + QString::number(qMax(1, m_plan.onlineCores / 4)) + " -o '" + report +
+           "' --use-unique-output-file-name\" ";
+}
+
+QString StagePipeline::prepareCommands() const
+{
+    // Results of earlier runs must not be mistaken for this build's
+    if (!isEnabled() || !m_config.doTesting()) {
+        return QString();
+    }
+    QString results = "\"" + LitTestRunner::resultsDir(m_config.buildDir()) + "\"";
+    return "rm -rf " + results + " && mkdir -p " + results + "\n";
+}
+
+QStringList StagePipeline::testedSuites() const
+{
+    QStringList result;
+    if (!isEnabled() || !m_config.doTesting()) {
+        return result;
+    }
+    const QStringList enabled = components();
+    for (const auto &entry : PipelinedComponents) {
+        if (enabled.contains(entry.project)) {
+            result.append(entry.suite);
+        }
+    }
+    return result;
+}
+
+bool StagePipeline::installsEarly() const
+{
+    return m_config.doInstall() && !m_config.sudoInstall();
+}
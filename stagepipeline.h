@@ -0,0 +1,49 @@
+#ifndef STAGEPIPELINE_H
+#define STAGEPIPELINE_H
+
+#include "builderconfiguration.h"
+#include "resourceplanner.h"
+
+#include <QString>
+#include <QStringList>
+
+// Overlaps the install and the tests of clang and lld with the rest of the
+// build: their install-* and check-* targets are added to the build's own
+// ninja invocation, which starts each one as soon as the component and its
+// test tools are linked while everything else keeps compiling. The later
+// install then finds them up to date, and the test stage skips their suites.
+class StagePipeline
+{
+public:
+    // The job counts come from the plan of the build the stage belongs to
+    StagePipeline(const BuilderConfiguration &config, const ResourcePlan &plan);
+
+    // Whether any work is pipelined: a ninja build that installs without
+    // sudo or tests one of the components
+    bool isEnabled() const;
+
+    // Components of the configuration that can be pipelined
+    QStringList components() const;
+
+    // Targets added to the build
+    QStringList targets() const;
+
+    // Variable assignments to put before the build command, with a
+    // trailing space, or nothing
+    QString environment() const;
+
+    // Commands run before the build
+    QString prepareCommands() const;
+
+    // Lit suites the build runs, relative to the build directory
+    QStringList testedSuites() const;
+
+private:
+    BuilderConfiguration m_config;
+    ResourcePlan m_plan;
+
+    // The install targets run inside ninja, which cannot ask for a password
+    bool installsEarly() const;
+};
+
+#endif // STAGEPIPELINE_H
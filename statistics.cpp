@@ -0,0 +1,163 @@
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Convergence limits of the continued fraction
+const int MaxIterations = 200;
+const double Epsilon = 3e-14;
+const double TinyValue = 1e-300;
+
+} // namespace
+
+double Statistics::mean(const QVector<double> &values)
+{
+    if (values.isEmpty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+double Statistics::variance(const QVector<double> &values)
+{
+    if (values.size() < 2) {
+        return 0.0;
+    }
+    double average = mean(values);
+    double sum = 0.0;
+    for (double value : values) {
+        sum += (value - average) * (value - average);
+    }
+    return sum / (values.size() - 1);
+}
+
+double Statistics::standardDeviation(const QVector<double> &values)
+{
+    return std::sqrt(variance(values));
+}
+
+double Statistics::median(QVector<double> values)
+{
+    if (values.isEmpty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    int middle = values.size() / 2;
+    return values.size() % 2 ? values.at(middle) : (values.at(middle - 1) + values.at(middle)) / 2.0;
+}
+
+double Statistics::welchPValue(const QVector<double> &a, const QVector<double> &b)
+{
+    if (a.size() < 2 || b.size() < 2) {
+        return 1.0;
+    }
+
+    double varianceA = variance(a) / a.size();
+    double varianceB = variance(b) / b.size();
+    double difference = mean(a) - mean(b);
+
+    // Identical repeated values: the means either match or differ for certain
+    double standardError = std::sqrt(varianceA + varianceB);
+    if (standardError == 0.0) {
+        return difference == 0.0 ? 1.0 : 0.0;
+    }
+
+    // Welch-Satterthwaite degrees of freedom
+    double degrees = (varianceA + varianceB) * (varianceA + varianceB) /
+                     (varianceA * varianceA / (a.size() - 1) + varianceB * varianceB / (b.size() - 1));
+    return studentTwoTailed(difference / standardError, degrees);
+}
+
+double Statistics::studentTwoTailed(double t, double degreesOfFreedom)
+{
+    if (degreesOfFreedom <= 0.0) {
+        return 1.0;
+    }
+    return incompleteBeta(degreesOfFreedom / (degreesOfFreedom + t * t), degreesOfFreedom / 2.0, 0.5);
+}
+
+QVector<double> Statistics::benjaminiHochberg(const QVector<double> &pValues)
+{
+    const int count = pValues.size();
+    QVector<int> order(count);
+    for (int i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&pValues](int a, int b) { return pValues.at(a) < pValues.at(b); });
+
+    // From the largest p-value down, each adjusted value is p * m / rank,
+    // kept monotonic in the rank
+    QVector<double> adjusted(count, 1.0);
+    double smallest = 1.0;
+    for (int rank = count; rank >= 1; --rank) {
+        int index = order.at(rank - 1);
+        smallest = std::min(smallest, pValues.at(index) * count / rank);
+        adjusted[index] = smallest;
+    }
+    return adjusted;
+}
+
+double Statistics::incompleteBeta(double x, double a, double b)
+{
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    if (x >= 1.0) {
+        return 1.0;
+    }
+
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                            a * std::log(x) + b * std::log(1.0 - x));
+
+    // The continued fraction converges quickly only on this side of the mean
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return front * betaContinuedFraction(x, a, b) / a;
+    }
+    return 1.0 - front * betaContinuedFraction(1.0 - x, b, a) / b;
+}
+
+double Statistics::betaContinuedFraction(double x, double a, double b)
+{
+    // Modified Lentz's method
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    if (std::fabs(d) < TinyValue) {
+        d = TinyValue;
+    }
+    d = 1.0 / d;
+    double result = d;
+
+    for (int m = 1; m <= MaxIterations; ++m) {
+        int m2 = 2 * m;
+
+        // Even step
+        double term = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + term * d;
+        d = std::fabs(d) < TinyValue ? TinyValue : d;
+        c = 1.0 + term / c;
+        c = std::fabs(c) < TinyValue ? TinyValue : c;
+        d = 1.0 / d;
+        result *= d * c;
+
+        // Odd step
+        term = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + term * d;
+        d = std::fabs(d) < TinyValue ? TinyValue : d;
+        c = 1.0 + term / c;
+        c = std::fabs(c) < TinyValue ? TinyValue : c;
+        d = 1.0 / d;
+        double delta = d * c;
+        result *= delta;
+
+        if (std::fabs(delta - 1.0) < Epsilon) {
+            break;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <QVector>
+
+// Summary statistics and significance tests for repeated measurements
+class Statistics
+{
+public:
+    static double mean(const QVector<double> &values);
+
+    // Sample variance (n - 1 in the denominator), 0 for fewer than two values
+    static double variance(const QVector<double> &values);
+
+    static double standardDeviation(const QVector<double> &values);
+
+    static double median(QVector<double> values);
+
+    // Two-sided p-value of Welch's t-test for equal means of two samples
+    // with possibly different variances; 1 when either has fewer than two
+    // values
+    static double welchPValue(const QVector<double> &a, const QVector<double> &b);
+
+    // Two-sided tail probability of Student's t distribution
+    static double studentTwoTailed(double t, double degreesOfFreedom);
+
+    // Benjamini-Hochberg adjusted p-values of a family of tests, in the
+    // order given; comparing them with a level bounds the expected share
+    // of false discoveries among the tests below it
+    static QVector<double> benjaminiHochberg(const QVector<double> &pValues);
+
+private:
+    // Regularized incomplete beta function I_x(a, b)
+    static double incompleteBeta(double x, double a, double b);
+
+    // Continued fraction of the incomplete beta function
+    static double betaContinuedFraction(double x, double a, double b);
+};
+
+#endif // STATISTICS_H
@@ -0,0 +1,194 @@
+#include "timetraceaggregator.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+namespace {
+
+typedef QHash<QString, TimeTraceAggregator::Entry> EntryMap;
+
+// Totals collected by one worker before being merged
+struct Partial
+{
+    int fileCount = 0;
+    int failedFiles = 0;
+    qint64 compileUs = 0;
+    qint64 frontendUs = 0;
+    qint64 backendUs = 0;
+    EntryMap headers;
+    EntryMap instantiations;
+    EntryMap passes;
+    EntryMap projects;
+};
+
+void addEntry(EntryMap &map, const QString &name, qint64 durationUs, int count = 1)
+{
+    TimeTraceAggregator::Entry &entry = map[name];
+    entry.totalUs += durationUs;
+    entry.count += count;
+}
+
+void mergeMap(EntryMap &target, const EntryMap &source)
+{
+    for (auto it = source.constBegin(); it != source.constEnd(); ++it) {
+        addEntry(target, it.key(), it.value().totalUs, it.value().count);
+    }
+}
+
+QVector<TimeTraceAggregator::Entry> topEntries(const EntryMap &map, int topCount)
+{
+    QVector<TimeTraceAggregator::Entry> entries;
+    entries.reserve(map.size());
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        TimeTraceAggregator::Entry entry = it.value();
+        entry.name = it.key();
+        entries.append(entry);
+    }
+
+    auto byTime = [](const TimeTraceAggregator::Entry &a, const TimeTraceAggregator::Entry &b) {
+        return a.totalUs > b.totalUs;
+    };
+    if (entries.size() > topCount) {
+        std::partial_sort(entries.begin(), entries.begin() + topCount, entries.end(), byTime);
+        entries.resize(topCount);
+    } else {
+        std::sort(entries.begin(), entries.end(), byTime);
+    }
+    return entries;
+}
+
+void parseTraceFile(const QString &filePath, const QString &project, Partial &partial)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        ++partial.failedFiles;
+        return;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject() || !doc.object().contains("traceEvents")) {
+        ++partial.failedFiles;
+        return;
+    }
+
+    ++partial.fileCount;
+    const QJsonArray events = doc.object()["traceEvents"].toArray();
+    for (const QJsonValue &value : events) {
+        QJsonObject event = value.toObject();
+        if (event["ph"].toString() != "X") {
+            continue;
+        }
+
+        QString name = event["name"].toString();
+        qint64 duration = qint64(event["dur"].toDouble());
+
+        if (name == "Source") {
+            addEntry(partial.headers, event["args"].toObject()["detail"].toString(), duration);
+        } else if (name == "InstantiateClass" || name == "InstantiateFunction") {
+            addEntry(partial.instantiations, event["args"].toObject()["detail"].toString(), duration);
+        } else if (name == "RunPass") {
+            addEntry(partial.passes, event["args"].toObject()["detail"].toString(), duration);
+        } else if (name == "ExecuteCompiler") {
+            partial.compileUs += duration;
+            addEntry(partial.projects, project, duration);
+        } else if (name == "Frontend") {
+            partial.frontendUs += duration;
+        } else if (name == "Backend") {
+            partial.backendUs += duration;
+        }
+    }
+}
+
+} // namespace
+
+QStringList TimeTraceAggregator::findTraceFiles(const QString &buildDir)
+{
+    // Traces sit next to the objects, i.e. under some CMakeFiles/<target>.dir
+    QStringList files;
+    QDirIterator it(buildDir, QStringList() << "*.json", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString path = it.next();
+        if (path.contains("/CMakeFiles/")) {
+            files.append(path);
+        }
+    }
+    return files;
+}
+
+TimeTraceAggregator::Report TimeTraceAggregator::aggregate(const QString &buildDir, const QStringList &files,
+                                                          int topCount)
+{
+    Partial total;
+    QMutex mutex;
+    QDir root(buildDir);
+
+    // Split the files into one contiguous chunk per worker
+    QThreadPool pool;
+    int workers = qMax(1, qMin(QThread::idealThreadCount(), int(files.size())));
+    pool.setMaxThreadCount(workers);
+    int chunkSize = (files.size() + workers - 1) / workers;
+
+    for (int worker = 0; worker < workers; ++worker) {
+        int first = worker * chunkSize;
+        int last = qMin(int(files.size()), first + chunkSize);
+        if (first >= last) {
+            break;
+        }
+
+        pool.start([&, first, last]() {
+            Partial partial;
+            for (int i = first; i < last; ++i) {
+                const QString &path = files.at(i);
+                parseTraceFile(path, projectForPath(root.relativeFilePath(path)), partial);
+            }
+
+            QMutexLocker locker(&mutex);
+            total.fileCount += partial.fileCount;
+            total.failedFiles += partial.failedFiles;
+            total.compileUs += partial.compileUs;
+            total.frontendUs += partial.frontendUs;
+            total.backendUs += partial.backendUs;
+            mergeMap(total.headers, partial.headers);
+            mergeMap(total.instantiations, partial.instantiations);
+            mergeMap(total.passes, partial.passes);
+            mergeMap(total.projects, partial.projects);
+        });
+    }
+    pool.waitForDone();
+
+    Report report;
+    report.fileCount = total.fileCount;
+    report.failedFiles = total.failedFiles;
+    report.compileUs = total.compileUs;
+    report.frontendUs = total.frontendUs;
+    report.backendUs = total.backendUs;
+    report.headers = topEntries(total.headers, topCount);
+    report.instantiations = topEntries(total.instantiations, topCount);
+    report.passes = topEntries(total.passes, topCount);
+    report.projects = topEntries(total.projects, total.projects.size());
+    return report;
+}
+
+QString TimeTraceAggregator::projectForPath(const QString &relativePath)
+{
+    // tools/clang/..., tools/flang/..., projects/openmp/..., runtimes/..., otherwise LLVM itself
+    QStringList parts = relativePath.split('/', Qt::SkipEmptyParts);
+    if (parts.size() > 2 && (parts.at(0) == "tools" || parts.at(0) == "projects")) {
+        return parts.at(1);
+    }
+    if (parts.size() > 1 && parts.at(0) == "runtimes") {
+        return "runtimes";
+    }
+    return "llvm";
+}
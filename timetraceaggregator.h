@@ -0,0 +1,43 @@
+#ifndef TIMETRACEAGGREGATOR_H
+#define TIMETRACEAGGREGATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Aggregates clang -ftime-trace output across a build tree. Every
+// translation unit writes <source>.json next to its object file; the
+// aggregator parses them on a thread pool and sums the time spent per
+// header, per template instantiation, per backend pass and per project.
+class TimeTraceAggregator
+{
+public:
+    struct Entry {
+        QString name;
+        qint64 totalUs = 0;
+        int count = 0;
+    };
+
+    struct Report {
+        int fileCount = 0;
+        int failedFiles = 0;
+        qint64 compileUs = 0;            // Sum of ExecuteCompiler over all TUs
+        qint64 frontendUs = 0;
+        qint64 backendUs = 0;
+        QVector<Entry> headers;          // Time parsing each header (inclusive)
+        QVector<Entry> instantiations;   // Class and function template instantiations
+        QVector<Entry> passes;           // Optimization and codegen passes
+        QVector<Entry> projects;         // Compile time per LLVM project
+    };
+
+    // Find the per-TU trace files under a build directory
+    static QStringList findTraceFiles(const QString &buildDir);
+
+    // Parse and aggregate trace files, keeping topCount entries per list
+    static Report aggregate(const QString &buildDir, const QStringList &files, int topCount = 50);
+
+    // The LLVM project a path inside the build directory belongs to
+    static QString projectForPath(const QString &relativePath);
+};
+
+#endif // TIMETRACEAGGREGATOR_H
@@ -0,0 +1,228 @@
+#include "traceexporter.h"
+#include "buildreport.h"
+#include "ninjalog.h"
+#include "ninjaloganalyzer.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace {
+
+QByteArray jsonString(const QByteArray &value)
+{
+    QByteArray escaped;
+    escaped.reserve(value.size() + 2);
+    escaped.append('"');
+    for (char c : value) {
+        switch (c) {
+        case '"':
+            escaped.append("\\\"");
+            break;
+        case '\\':
+            escaped.append("\\\\");
+            break;
+        case '\n':
+            escaped.append("\\n");
+            break;
+        case '\t':
+            escaped.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                escaped.append(QString::asprintf("\\u%04x", c).toLatin1());
+            } else {
+                escaped.append(c);
+            }
+            break;
+        }
+    }
+    escaped.append('"');
+    return escaped;
+}
+
+class TraceWriter
+{
+public:
+    explicit TraceWriter(QFile *file)
+        : m_file(file)
+        , m_first(true)
+    {
+        m_file->write("{\"traceEvents\":[\n");
+    }
+
+    void processName(int pid, const QByteArray &name)
+    {
+        event("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" + QByteArray::number(pid) +
+              ",\"tid\":0,\"args\":{\"name\":" + jsonString(name) + "}}");
+    }
+
+    void complete(int pid, int tid, const QByteArray &name, const QByteArray &category,
+                  qint64 startUs, qint64 durationUs)
+    {
+        event("{\"ph\":\"X\",\"pid\":" + QByteArray::number(pid) + ",\"tid\":" + QByteArray::number(tid) +
+              ",\"ts\":" + QByteArray::number(startUs) + ",\"dur\":" + QByteArray::number(durationUs) +
+              ",\"cat\":" + jsonString(category) + ",\"name\":" + jsonString(name) + "}");
+    }
+
+    bool finish()
+    {
+        m_file->write("\n],\"displayTimeUnit\":\"ms\"}\n");
+        return m_file->error() == QFile::NoError;
+    }
+
+private:
+    QFile *m_file;
+    bool m_first;
+
+    void event(const QByteArray &json)
+    {
+        if (!m_first) {
+            m_file->write(",\n");
+        }
+        m_first = false;
+        m_file->write(json);
+    }
+};
+
+// Assign each edge the lowest job slot that was free when it started
+QVector<int> assignLanes(const QVector<NinjaEdge> &edges, const QVector<int> &order)
+{
+    typedef std::pair<qint64, int> Busy;   // (end, lane)
+    std::priority_queue<Busy, std::vector<Busy>, std::greater<Busy>> busy;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> freeLanes;
+    int laneCount = 0;
+
+    QVector<int> lanes(edges.size());
+    for (int index : order) {
+        const NinjaEdge &edge = edges.at(index);
+        while (!busy.empty() && busy.top().first <= edge.start) {
+            freeLanes.push(busy.top().second);
+            busy.pop();
+        }
+
+        int lane;
+        if (freeLanes.empty()) {
+            lane = laneCount++;
+        } else {
+            lane = freeLanes.top();
+            freeLanes.pop();
+        }
+        lanes[index] = lane;
+        busy.push(Busy(edge.end, lane));
+    }
+    return lanes;
+}
+
+// The stage overlapping [startMs, endMs] the most, or null if none does;
+// a stage still running has no end yet
+const BuildStage *stageAt(const QVector<BuildStage> &stages, qint64 startMs, qint64 endMs)
+{
+    const BuildStage *best = nullptr;
+    qint64 bestOverlap = -1;
+    for (const BuildStage &stage : stages) {
+        qint64 stageEnd = stage.endMs > stage.startMs ? stage.endMs : std::numeric_limits<qint64>::max();
+        qint64 overlap = qMin(endMs, stageEnd) - qMax(startMs, stage.startMs);
+        if (overlap >= 0 && overlap > bestOverlap) {
+            best = &stage;
+            bestOverlap = overlap;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+bool TraceExporter::exportTrace(const QString &buildDir, const QString &ninjaDir, const QString &filePath,
+                                QString *errorMessage)
+{
+    NinjaLog log;
+    bool haveLog = log.load(NinjaLog::defaultPath(ninjaDir));
+
+    BuildReport report;
+    bool haveReport = report.loadFromFile(BuildReport::defaultPath(buildDir));
+
+    if (!haveLog && !haveReport) {
+        if (errorMessage) {
+            *errorMessage = "No .ninja_log or build report found in " + buildDir;
+        }
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot write " + filePath;
+        }
+        return false;
+    }
+
+    TraceWriter writer(&file);
+    QVector<BuildStage> stages = haveReport ? report.stages() : QVector<BuildStage>();
+    qint64 baseMs = stages.isEmpty() ? 0 : stages.first().startMs;
+
+    // Build script stages on their own track
+    const int stagePid = 1;
+    writer.processName(stagePid, "Build script");
+    for (const BuildStage &stage : stages) {
+        writer.complete(stagePid, 1, stage.name.toUtf8(), "stage",
+                        (stage.startMs - baseMs) * 1000, (stage.endMs - stage.startMs) * 1000);
+    }
+
+    // Each ninja run goes to the stage its wall-clock time falls in, so runs
+    // from tests or BOLT land on their own stage and older runs are left
+    // out. Without a report only the most recent run is shown.
+    const QVector<QPair<int, int>> &runs = log.runs();
+    int pid = stagePid;
+    for (int i = stages.isEmpty() ? int(runs.size()) - 1 : 0; i >= 0 && i < runs.size(); ++i) {
+        const QPair<int, int> &range = runs.at(i);
+        QVector<NinjaEdge> edges = log.edges().mid(range.first, range.second - range.first);
+
+        QByteArray runName = "ninja";
+        qint64 runBaseMs = 0;
+        if (!stages.isEmpty()) {
+            qint64 runDurationMs = 0;
+            for (const NinjaEdge &edge : edges) {
+                runDurationMs = qMax(runDurationMs, edge.end);
+            }
+            qint64 runEndMs = log.runFinishedMs(i);
+            qint64 runStartMs = runEndMs - runDurationMs;
+            const BuildStage *match = stageAt(stages, runStartMs, runEndMs);
+            if (runEndMs <= 0 || !match) {
+                continue;
+            }
+            runName += " (" + match->name.toUtf8() + ")";
+            runBaseMs = qMax(runStartMs, match->startMs) - baseMs;
+        }
+
+        ++pid;
+        writer.processName(pid, runName);
+
+        QVector<int> order(edges.size());
+        for (int j = 0; j < order.size(); ++j) {
+            order[j] = j;
+        }
+        std::sort(order.begin(), order.end(),
+                  [&edges](int a, int b) { return edges.at(a).start < edges.at(b).start; });
+        QVector<int> lanes = assignLanes(edges, order);
+
+        for (int j : order) {
+            const NinjaEdge &edge = edges.at(j);
+            QByteArray category = NinjaLogAnalyzer::kindName(NinjaLogAnalyzer::classify(edge)).toUtf8();
+            writer.complete(pid, lanes.at(j) + 1, edge.outputs.first(), category,
+                            (runBaseMs + edge.start) * 1000, edge.duration() * 1000);
+        }
+    }
+
+    if (!writer.finish()) {
+        if (errorMessage) {
+            *errorMessage = "Failed to write " + filePath;
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+#ifndef TRACEEXPORTER_H
+#define TRACEEXPORTER_H
+
+#include <QString>
+
+// Writes a build's timeline as Chrome Trace Event JSON, loadable in
+// about:tracing and Perfetto. The build script's stages come from the
+// build report and every ninja edge is placed on the lane (job slot) it
+// occupied, so gaps in parallelism show up as empty lanes.
+class TraceExporter
+{
+public:
+    // Export the timeline of the build in buildDir to filePath. The ninja
+    // log is read from ninjaDir, the final stage's directory for a PGO
+    // pipeline and buildDir otherwise.
+    static bool exportTrace(const QString &buildDir, const QString &ninjaDir, const QString &filePath,
+                            QString *errorMessage = nullptr);
+};
+
+#endif // TRACEEXPORTER_H